@@ -0,0 +1,46 @@
+#ifndef ADVERTISINGPOLICY_H
+#define ADVERTISINGPOLICY_H
+
+#include <Arduino.h>
+
+class JsonWriter;
+
+// Advertising interval by situation, in 0.625 ms units. Right after boot and
+// after every disconnect the scale advertises fast so an app (re)connects at
+// once; once FAST_WINDOW_MS passes without a connection it drops to a slow
+// interval to save power. The weight broadcast needs a fast interval for as
+// long as it is on.
+class AdvertisingPolicy {
+public:
+    enum Mode {
+        ADV_FAST = 0,
+        ADV_SLOW,
+        ADV_BROADCAST
+    };
+
+    AdvertisingPolicy();
+
+    // BLE task - returns true when the interval has to be reapplied
+    bool update(uint32_t now, uint32_t disconnects, bool broadcast);
+
+    Mode getMode() const { return mode; }
+    const char* getModeName() const;
+    uint16_t getMinInterval() const;
+    uint16_t getMaxInterval() const;
+    void writeJson(JsonWriter& json, uint32_t now) const;
+
+private:
+    static const uint32_t FAST_WINDOW_MS = 30000;
+    static const uint16_t FAST_MIN = 32;    // 20 ms
+    static const uint16_t FAST_MAX = 48;    // 30 ms
+    static const uint16_t SLOW_MIN = 1636;  // 1022.5 ms
+    static const uint16_t SLOW_MAX = 2056;  // 1285 ms
+
+    Mode mode;
+    bool started;
+    uint32_t fastUntilMs;
+    uint32_t seenDisconnects;
+    uint32_t switches;
+};
+
+#endif
@@ -12,7 +12,7 @@ public:
     // Battery readings
     float getBatteryVoltage();
     int getBatteryPercentage();
-    String getBatteryStatus();  // "Full", "Good", "Low", "Critical"
+    const char* getBatteryStatus();  // "Full", "Good", "Low", "Critical"
     
     // Battery state indicators
     bool isCharging();  // Future expansion for charge detection
@@ -0,0 +1,76 @@
+#ifndef BLELIFECYCLE_H
+#define BLELIFECYCLE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+class JsonWriter;
+
+// Connect/disconnect handling without blocking waits. NimBLE callbacks only
+// count events; update() runs on the BLE task and decides from timers when
+// advertising should be (re)started, so a disconnect never stalls the loop.
+//
+// Re-advertising backs off when links keep dropping right after connecting
+// (a flapping central, or one at the edge of range): SETTLE_MS doubles per
+// consecutive short-lived connection up to MAX_BACKOFF_MS - advertising that
+// is still on for other slots is paused for that time too. A connection that
+// lasted FLAP_WINDOW_MS or longer resets the backoff. Failed advertising
+// starts are retried with the same doubling.
+class BleLifecycle {
+public:
+    enum State {
+        LINK_WAITING = 0, // Not advertising, slot free - advertising starts at restartAtMs
+        LINK_ADVERTISING, // Advertising (connections may exist while slots remain)
+        LINK_FULL         // Every connection slot in use - not advertising
+    };
+
+    // Outcome of update() the caller has to carry out
+    enum Action {
+        ACTION_NONE = 0,
+        ACTION_START_ADVERTISING, // Report the result through advertisingStarted()
+        ACTION_STOP_ADVERTISING   // A flapping link dropped while advertising for other slots
+    };
+
+    BleLifecycle();
+
+    // NimBLE host task
+    void onConnect();
+    void onDisconnect(uint32_t connectedForMs);
+
+    // BLE task
+    Action update(uint32_t now, uint8_t connections, bool slotFree, bool advertising);
+    void advertisingStarted(bool ok, uint32_t now);
+
+    State getState() const { return state; }
+    const char* getStateName() const;
+    uint32_t getBackoffMs() const { return backoffMs; }
+    uint32_t getConnects() const { return connects.load(); }
+    uint32_t getDisconnects() const { return disconnects.load(); }
+    uint32_t getAdvertisingRestarts() const { return advertisingRestarts; }
+    uint32_t getAdvertisingFailures() const { return advertisingFailures; }
+    void writeJson(JsonWriter& json) const;
+
+private:
+    static const uint32_t SETTLE_MS = 500;             // Let the stack clean up after a disconnect
+    static const uint32_t READVERTISE_MS = 100;        // After a connect, when slots remain
+    static const uint32_t MAX_BACKOFF_MS = 30000;
+    static const uint32_t FLAP_WINDOW_MS = 5000;       // Connections shorter than this count as flaps
+
+    State state;
+    uint32_t restartAtMs;
+    uint32_t backoffMs;
+
+    // Written by the host task, consumed by update()
+    std::atomic<uint32_t> connects;
+    std::atomic<uint32_t> disconnects;
+    std::atomic<uint32_t> shortDisconnects;
+    uint32_t seenDisconnects;
+    uint32_t seenShortDisconnects;
+
+    uint32_t advertisingRestarts;
+    uint32_t advertisingFailures;
+
+    void waitFor(uint32_t now, uint32_t delayMs);
+};
+
+#endif
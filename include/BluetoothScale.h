@@ -4,8 +4,22 @@
 #include <NimBLEServer.h>
 #include <NimBLEUtils.h>
 #include "Scale.h"
+#include "ShotRecorder.h"
+#include "StopTrigger.h"
+#include "ShotDetector.h"
+#include "NotifyPolicy.h"
+#include "ConnectionTable.h"
+#include "SampleBatchCodec.h"
+#include "CommandQueue.h"
+#include "BleLifecycle.h"
+#include "AdvertisingPolicy.h"
+#include "BroadcastCodec.h"
+#include "GaggiMateFrame.h"
+#include "TelemetryPublisher.h"
+#include <Preferences.h>
 
 class Display; // Forward declaration
+class JsonWriter;
 
 enum class WeighMyBruMessageType : uint8_t {
   SYSTEM = 0x0A,
@@ -16,7 +30,11 @@ enum class BeanConquerorCommand : uint8_t {
   TARE = 0x01,
   TIMER_START = 0x02,
   TIMER_STOP = 0x03,
-  TIMER_RESET = 0x04
+  TIMER_RESET = 0x04,
+  TARGET_WEIGHT = 0x05, // data[3..5] = target in centigrams (big-endian), 0 clears
+  FRAME_EXTENSION = 0x06, // data[3] = GaggiMate frame extension version wanted, 0 turns it off
+  STOP_NOW = 0x07,      // Scale -> client: target reached, stop the shot now
+  SHOT_PAGE = 0x10     // data[3..4] = page number (big-endian), page lands in the shot characteristic
 };
 
 class BluetoothScale : public NimBLEServerCallbacks, public NimBLECharacteristicCallbacks {
@@ -28,30 +46,58 @@ public:
     void begin();  // Initialize without scale reference
     void setScale(Scale* scale);  // Set scale reference later
     void setDisplay(Display* display); // Set display reference for timer control
+    void setShotRecorder(ShotRecorder* recorder); // Shot history served over the shot characteristic
+    void setStopTrigger(StopTrigger* trigger); // Target weight set over BLE, stop sent as a notification
+    void setShotDetector(ShotDetector* detector); // Auto timer start/stop pushed as notifications
+    void setCommandQueue(CommandQueue* queue); // Tare and timer writes are executed by the weight task
+    void setTelemetry(TelemetryPublisher* publisher); // Snapshot read by update() between samples
     void end();
     void update();
     bool isConnected();
+    uint8_t getConnectionCount() const { return connections.getCount(); }
+    void writeConnectionsJson(JsonWriter& json) const { connections.writeJson(json, server); } // Per-connection subscriptions and throughput
+    void writeLifecycleJson(JsonWriter& json) const { lifecycle.writeJson(json); } // Advertising state, connect/disconnect counters
+    void writeAdvertisingJson(JsonWriter& json) const { advertisingPolicy.writeJson(json, millis()); } // Interval mode in effect
+    
+    // Connectionless broadcast of weight/flow/timer in the advertising data (persisted)
+    void setBroadcast(bool enabled, uint16_t intervalMs); // Any task - applied by update()
+    bool isBroadcastEnabled() const { return broadcastEnabled; }
+    uint16_t getBroadcastIntervalMs() const { return broadcastIntervalMs; }
+    void writeBroadcastJson(JsonWriter& json) const;
     void sendWeight(float weight);
+    void publishWeight(const TelemetrySnapshot& snapshot); // Weight task, once per batch of new samples
+    void queueBatchSample(const WeightSample& sample); // Weight task, every sample - batched characteristic
+    void writeNotificationStatsJson(JsonWriter& json) const;
     void handleTareCommand();
     void handleTimerCommand(BeanConquerorCommand command);
+    void handleShotPageCommand(uint16_t page);
     int getBluetoothSignalStrength(); // Get BLE signal strength (RSSI)
-    String getBluetoothConnectionInfo(); // Get detailed BLE connection information
+    void writeBluetoothConnectionInfo(JsonWriter& json); // Get detailed BLE connection information
     
     // BLE Server callbacks
     void onConnect(NimBLEServer* pServer) override;
+    void onConnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) override; // Connection handle for tuning
     void onDisconnect(NimBLEServer* pServer) override;
+    void onDisconnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) override;
     
     // BLE Characteristic callbacks
-    void onWrite(NimBLECharacteristic* pCharacteristic) override;
+    void onWrite(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc) override; // Handle for per-client negotiation
+    void onStatus(NimBLECharacteristic* pCharacteristic, Status status, int code) override;
+    void onSubscribe(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc, uint16_t subValue) override;
 
 private:
     Scale* scale;
     Display* display; // Reference to display for timer control
+    ShotRecorder* shotRecorder;
+    StopTrigger* stopTrigger;
+    CommandQueue* commandQueue;
     NimBLEServer* server;
     NimBLEService* service;
     NimBLECharacteristic* weightCharacteristic;          // Bean Conqueror (simple float)
     NimBLECharacteristic* gaggiMateWeightCharacteristic; // GaggiMate (WeighMyBru protocol)
     NimBLECharacteristic* commandCharacteristic;
+    NimBLECharacteristic* shotCharacteristic;            // Latest shot, one page per read
+    NimBLECharacteristic* batchCharacteristic;           // Every sample, several per notification (opt-in)
     NimBLEAdvertising* advertising;
     
     bool deviceConnected;
@@ -59,30 +105,75 @@ private:
     uint32_t lastHeartbeat;
     uint32_t lastWeightSent;
     float lastWeight;
+    uint32_t lastSamplePublished; // millis() of the last publishWeight() - 0 until the first sample
+    
+    // Notification policy and counters
+    NotifyPolicy notifyPolicy;
+    NotifyStats gaggiMateStats;
+    NotifyStats beanConquerorStats;
+    NotifyStats commandStats;
+    NotifyStats batchStats;
+    
+    // Batched samples - only encoded while a client is subscribed
+    uint8_t batchBuffer[244]; // ATT payload with DLE: 251 - 4 (L2CAP) - 3 (ATT)
+    SampleBatchEncoder batchEncoder;
+    uint32_t batchStartedMs;
+    uint32_t batchSamplesSent;
+    
+    // Every connected central, its subscriptions and link tuning
+    ConnectionTable connections;
+    BleLifecycle lifecycle; // When to (re)advertise - no blocking waits in update()
+    AdvertisingPolicy advertisingPolicy; // Advertising interval - fast after boot/disconnect, slow when idle
+    
+    // Advertising broadcast - frames built on the BLE task from the last published sample
+    Preferences preferences;
+    volatile bool broadcastEnabled;
+    volatile uint16_t broadcastIntervalMs;
+    volatile bool broadcastLayoutPending; // Setting changed - switch advertising layout in update()
+    bool broadcastLayoutActive;           // Custom advertising data is in effect
+    uint32_t lastBroadcastMs;
+    uint32_t broadcastUpdates;
+    BroadcastFrame broadcastFrame;        // Last frame put on air
+    TelemetryPublisher* telemetry;
+    TelemetrySnapshot latest;             // Weight, flow, timer and filter state behind every frame
+    size_t commandValueLength; // Length of the last sendMessage() frame
     int8_t connectionRSSI; // Store RSSI value for connected device
-    uint16_t connectionHandle; // Store connection handle for RSSI queries
     
     // WeighMyBru protocol constants
     static const uint8_t PRODUCT_NUMBER = 0x03;
     static const size_t PROTOCOL_LENGTH = 20;
     static const uint32_t HEARTBEAT_INTERVAL = 2000; // 2 seconds
-    static const uint32_t WEIGHT_SEND_INTERVAL = 50; // 50ms (20 updates/sec) - faster for GaggiMate
+    static const uint32_t SAMPLE_STALE_MS = 2000; // No samples for this long (no HX711) - update() sends keepalives itself
+    static const uint32_t BATCH_MAX_AGE_MS = 100; // Latency cap for the batched characteristic
+    static const uint32_t WELCOME_DELAY_MS = 100; // Let a new connection settle before the handshake
     
     // WeighMyBru UUIDs - unique to avoid conflicts with Bookoo scales
     static const char* SERVICE_UUID;
     static const char* WEIGHT_CHARACTERISTIC_UUID;        // Bean Conqueror (simple float)
     static const char* GAGGIMATE_CHARACTERISTIC_UUID;     // GaggiMate (WeighMyBru protocol)
     static const char* COMMAND_CHARACTERISTIC_UUID;
+    static const char* SHOT_CHARACTERISTIC_UUID;
+    static const char* BATCH_CHARACTERISTIC_UUID;
     
     void initializeBLE();
-    void startAdvertising();
+    bool startAdvertising();
     void stopAdvertising();
     void sendMessage(WeighMyBruMessageType msgType, const uint8_t* payload, size_t length);
+    void notifyCharacteristic(NimBLECharacteristic* characteristic, NotifyStats& stats, size_t length);
+    NotifyStats* statsFor(NimBLECharacteristic* characteristic);
+    BleCharacteristicId idFor(NimBLECharacteristic* characteristic) const; // BLE_CHAR_COUNT if not tracked
+    void flushSampleBatch();
+    void applyAdvertisingLayout();
+    void applyAdvertisingInterval();
+    void updateBroadcast(bool force);
+    static void onTareComplete(bool success, void* context); // Sends the tare confirmation
+    static void onStopTriggered(int32_t weightCg, int32_t targetCg, void* context); // Sends STOP_NOW
+    static void onShotEvent(ShotEvent event, uint32_t eventMs, void* context); // Sends auto TIMER_START/STOP
     void sendHeartbeat();
     void sendNotificationRequest();
-    void processIncomingMessage(uint8_t* data, size_t length);
+    void processIncomingMessage(uint8_t* data, size_t length, uint16_t connHandle);
     uint8_t calculateChecksum(const uint8_t* data, size_t length);
-    void sendWeightNotification(float weight);
+    void sendWeightNotification(int32_t weightCg, float flowRate);
     void sendBeanConquerorWeight(float weight);    // Send simple float format
-    void sendGaggiMateWeight(float weight);        // Send WeighMyBru protocol format
+    void sendGaggiMateWeight(int32_t weightCg, float flowRate); // Send WeighMyBru protocol format (centigrams on the wire)
 };
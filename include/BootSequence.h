@@ -0,0 +1,51 @@
+#ifndef BOOTSEQUENCE_H
+#define BOOTSEQUENCE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+class JsonWriter;
+
+#define BOOT_MAX_STAGES 12
+
+// Readiness events - boot tasks wait on these instead of fixed delays
+#define BOOT_READY_DISPLAY      (1 << 0) // OLED probed (present or not)
+#define BOOT_READY_BLE          (1 << 1) // NimBLE stack up and advertising, scale reference set
+#define BOOT_READY_WIFI         (1 << 2) // setupWiFi() finished and web server registered
+#define BOOT_READY_SCALE_PROBED (1 << 3) // HX711 probe finished (check isHX711Connected())
+#define BOOT_READY_WEIGHT       (1 << 4) // First tare completed - weight is live
+
+struct BootStage {
+    const char* name;
+    int64_t startUs;  // esp_timer clock, i.e. time since boot
+    int64_t endUs;    // 0 while the stage is still running
+    bool ok;
+};
+
+// Staged boot bookkeeping: records when each boot stage starts and ends
+// (printed to Serial and served on /api/boot-profile) and carries the
+// readiness events that let independent init tasks run in parallel.
+class BootSequence {
+public:
+    BootSequence();
+    void begin(); // Call first thing in setup()
+
+    int beginStage(const char* name); // Returns stage id or -1 when the table is full
+    void endStage(int stageId, bool ok = true);
+
+    void setReady(EventBits_t bits);
+    bool isReady(EventBits_t bits) const; // True when all bits are set
+    bool waitReady(EventBits_t bits, uint32_t timeoutMs); // Blocks the calling task only
+
+    void writeProfileJson(JsonWriter& json) const;
+
+private:
+    BootStage stages[BOOT_MAX_STAGES];
+    size_t stageCount;
+    int64_t readyUs[8]; // When each readiness bit was first set
+    EventGroupHandle_t events;
+    mutable portMUX_TYPE lock;
+};
+
+#endif
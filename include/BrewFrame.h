@@ -0,0 +1,90 @@
+#ifndef BREWFRAME_H
+#define BREWFRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 20-byte little-endian weight frame served on /api/brew/bin for machine
+// controllers that poll over WiFi. Plain C++ - the same decoder works in host
+// tools and clients.
+//
+//   0      version            BREW_FRAME_VERSION
+//   1      flags              BREW_FLAG_*
+//   2      filter state       GAGGIMATE_FILTER_* code (stable, brewing, ...)
+//   3      reserved           0
+//   4-7    weight             i32 centigrams
+//   8-11   timer              u32 ms, 0 while stopped
+//   12-15  sample sequence    u32 WeightSample::sequence - ?since= compares this
+//   16-17  flow               i16 centigrams per second
+//   18-19  sample age         u16 ms between the sample and the response (saturates)
+//
+// In Python: struct.unpack("<BBBxiIIhH", body)
+
+#define BREW_FRAME_LENGTH 20
+#define BREW_FRAME_VERSION 1
+
+#define BREW_FLAG_STABLE          0x01 // Filter settled - weight is not moving
+#define BREW_FLAG_TIMER_RUNNING   0x02
+#define BREW_FLAG_TIMER_AUTO      0x04 // Started by the shot detector
+#define BREW_FLAG_SCALE_CONNECTED 0x08
+
+struct BrewWeight {
+    uint8_t flags;
+    uint8_t filterState;
+    int32_t weightCg;
+    uint32_t timerMs;
+    uint32_t sequence;
+    int16_t flowCgps;
+    uint16_t sampleAgeMs;
+};
+
+namespace BrewFrame {
+
+inline void put16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+}
+
+inline void put32(uint8_t* out, uint32_t value) {
+    put16(out, value & 0xFFFF);
+    put16(out + 2, value >> 16);
+}
+
+inline uint16_t get16(const uint8_t* data) {
+    return data[0] | (data[1] << 8);
+}
+
+inline uint32_t get32(const uint8_t* data) {
+    return get16(data) | ((uint32_t)get16(data + 2) << 16);
+}
+
+inline void encode(const BrewWeight& frame, uint8_t out[BREW_FRAME_LENGTH]) {
+    out[0] = BREW_FRAME_VERSION;
+    out[1] = frame.flags;
+    out[2] = frame.filterState;
+    out[3] = 0;
+    put32(out + 4, (uint32_t)frame.weightCg);
+    put32(out + 8, frame.timerMs);
+    put32(out + 12, frame.sequence);
+    put16(out + 16, (uint16_t)frame.flowCgps);
+    put16(out + 18, frame.sampleAgeMs);
+}
+
+// Returns false if the data is not a frame of this version
+inline bool decode(const uint8_t* data, size_t length, BrewWeight& frame) {
+    if (length < BREW_FRAME_LENGTH || data[0] != BREW_FRAME_VERSION) {
+        return false;
+    }
+    frame.flags = data[1];
+    frame.filterState = data[2];
+    frame.weightCg = (int32_t)get32(data + 4);
+    frame.timerMs = get32(data + 8);
+    frame.sequence = get32(data + 12);
+    frame.flowCgps = (int16_t)get16(data + 16);
+    frame.sampleAgeMs = get16(data + 18);
+    return true;
+}
+
+} // namespace BrewFrame
+
+#endif
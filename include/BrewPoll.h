@@ -0,0 +1,58 @@
+#ifndef BREWPOLL_H
+#define BREWPOLL_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "BrewFrame.h"
+#include "PollWaker.h"
+#include "TelemetryPublisher.h"
+
+class JsonWriter;
+
+// /api/brew/bin - the newest sample as a 20-byte BrewFrame, for machine
+// controllers that would otherwise parse /api/brew/status on every poll.
+//
+// GET /api/brew/bin answers at once. With ?since=<sequence> the request is
+// held until a sample newer than that sequence is published (or ?wait= ms,
+// default DEFAULT_WAIT_MS, pass), so a client looping on the sequence of
+// the last frame gets each sample without polling blindly. A timed-out
+// request gets the current frame; its sequence equals since.
+//
+// A held request is a chunked response whose filler returns
+// RESPONSE_TRY_AGAIN until the published snapshot moves past since, so all
+// request I/O stays on async_tcp. The filler is retried on the connection
+// poll; after publishing a new sample the weight task calls wake(), which
+// runs those polls right away instead of on AsyncTCP's ~500 ms tick. With
+// MAX_HELD requests held, further ones are answered at once.
+class BrewPoll {
+public:
+    explicit BrewPoll(TelemetryPublisher& telemetry);
+
+    void attach(AsyncWebServer& server); // Registers /api/brew/bin
+    void wake();                         // Weight task - a new sample was published
+    void writeStatsJson(JsonWriter& json) const;
+
+private:
+    static const uint32_t MAX_HELD = 4;
+    static const uint32_t DEFAULT_WAIT_MS = 1000;
+    static const uint32_t MAX_WAIT_MS = 10000;
+
+    TelemetryPublisher& telemetry;
+    PollWaker waker;                     // Held requests' connections
+
+    // async_tcp task only
+    uint32_t heldCount;
+    uint32_t immediate;
+    uint32_t woken;               // Held request answered by a new sample
+    uint32_t timedOut;
+    uint32_t overflow;            // MAX_HELD reached - answered at once
+    uint32_t dropped;             // Client went away while held
+
+    void handle(AsyncWebServerRequest* request);
+    void hold(AsyncWebServerRequest* request, uint32_t since, uint32_t wait);
+    static void send(AsyncWebServerRequest* request, const TelemetrySnapshot& snapshot, uint32_t now);
+    static void encode(const TelemetrySnapshot& snapshot, uint32_t now, uint8_t out[BREW_FRAME_LENGTH]);
+    static bool isNewer(uint32_t sequence, uint32_t since) { return (int32_t)(sequence - since) > 0; }
+};
+
+#endif
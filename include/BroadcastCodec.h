@@ -0,0 +1,76 @@
+#ifndef BROADCASTCODEC_H
+#define BROADCASTCODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Weight broadcast carried in the advertising manufacturer data, so passive
+// scanners can follow the scale without connecting. Plain C++ - the same
+// decoder works in host tools and listeners.
+//
+// Manufacturer data (little-endian, 12 bytes):
+//   u16  company id        BROADCAST_COMPANY_ID
+//   u8   version           BROADCAST_VERSION
+//   u8   sequence          +1 per new frame, wraps - scanners drop repeats
+//   i24  weight            centigrams
+//   i16  flow              centigrams per second
+//   u16  timer             tenths of a second (saturates at 6553.5 s)
+//   u8   flags             BROADCAST_FLAG_*
+
+#define BROADCAST_COMPANY_ID 0xFFFF // Bluetooth SIG value reserved for testing - no assigned id
+#define BROADCAST_VERSION 1
+#define BROADCAST_MFR_DATA_SIZE 12
+
+#define BROADCAST_FLAG_TIMER_RUNNING 0x01
+#define BROADCAST_FLAG_FLOWING       0x02 // Notify policy sees active flow
+#define BROADCAST_FLAG_CONNECTED     0x04 // At least one GATT client connected
+
+struct BroadcastFrame {
+    uint8_t sequence;
+    int32_t weightCg;   // Clamped to the 24-bit range
+    int16_t flowCgps;
+    uint32_t timerMs;   // Carried in 100 ms steps
+    uint8_t flags;
+};
+
+namespace Broadcast {
+
+inline void encode(const BroadcastFrame& frame, uint8_t out[BROADCAST_MFR_DATA_SIZE]) {
+    int32_t weight = frame.weightCg;
+    if (weight > 0x7FFFFF) weight = 0x7FFFFF;
+    if (weight < -0x800000) weight = -0x800000;
+    uint32_t timer = frame.timerMs / 100;
+    if (timer > 0xFFFF) timer = 0xFFFF;
+
+    out[0] = BROADCAST_COMPANY_ID & 0xFF;
+    out[1] = (BROADCAST_COMPANY_ID >> 8) & 0xFF;
+    out[2] = BROADCAST_VERSION;
+    out[3] = frame.sequence;
+    out[4] = weight & 0xFF;
+    out[5] = (weight >> 8) & 0xFF;
+    out[6] = (weight >> 16) & 0xFF;
+    out[7] = (uint16_t)frame.flowCgps & 0xFF;
+    out[8] = ((uint16_t)frame.flowCgps >> 8) & 0xFF;
+    out[9] = timer & 0xFF;
+    out[10] = (timer >> 8) & 0xFF;
+    out[11] = frame.flags;
+}
+
+// Returns false if the data is not a broadcast frame of a known version
+inline bool decode(const uint8_t* data, size_t length, BroadcastFrame& frame) {
+    if (length < BROADCAST_MFR_DATA_SIZE ||
+        (data[0] | (data[1] << 8)) != BROADCAST_COMPANY_ID || data[2] != BROADCAST_VERSION) {
+        return false;
+    }
+    frame.sequence = data[3];
+    uint32_t weight = data[4] | ((uint32_t)data[5] << 8) | ((uint32_t)data[6] << 16);
+    frame.weightCg = (int32_t)(weight << 8) >> 8; // Sign-extend 24 bits
+    frame.flowCgps = (int16_t)(data[7] | (data[8] << 8));
+    frame.timerMs = (uint32_t)(data[9] | (data[10] << 8)) * 100;
+    frame.flags = data[11];
+    return true;
+}
+
+} // namespace Broadcast
+
+#endif
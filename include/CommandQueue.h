@@ -0,0 +1,114 @@
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+class JsonWriter;
+
+#define COMMAND_QUEUE_CAPACITY 32 // Power of two - a full filter-settings POST is 13 commands
+
+// Control actions that mutate Scale, Display, FlowRate, ShotDetector or
+// StopTrigger state. Radio and network callbacks enqueue them; the weight task
+// executes them at the start of its cycle, so those objects are only ever
+// changed from the task that reads them.
+enum CommandType : uint8_t {
+    CMD_TARE = 0,               // intValue = conversions to average
+    CMD_TIMER_START,
+    CMD_TIMER_STOP,
+    CMD_TIMER_RESET,
+    CMD_SET_CALIBRATION,        // floatValue[0] = calibration factor
+    CMD_SET_BREWING_THRESHOLD,  // floatValue[0]
+    CMD_SET_STABILITY_TIMEOUT,  // intValue = ms
+    CMD_SET_MEDIAN_SAMPLES,     // intValue
+    CMD_SET_AVERAGE_SAMPLES,    // intValue
+    CMD_SET_FILTER_MODE,        // intValue = Scale::FilterMode
+    CMD_SET_KALMAN_NOISE,       // floatValue[0] = process, floatValue[1] = measurement
+    CMD_SET_FLOW_MODE,          // intValue = FlowRate::Mode
+    CMD_SET_FLOW_WINDOW,        // intValue = ms
+    CMD_SET_AUTO_TIMER,         // intValue = enabled
+    CMD_SET_AUTO_START_FLOW,    // floatValue[0] = g/s
+    CMD_SET_AUTO_START_MS,      // intValue
+    CMD_SET_AUTO_STOP_FLOW,     // floatValue[0] = g/s
+    CMD_SET_AUTO_STOP_MS,       // intValue
+    CMD_RESET_DRIP_LEARNING,
+    CMD_TYPE_COUNT
+};
+
+enum CommandSource : uint8_t {
+    CMD_SOURCE_BLE = 0,
+    CMD_SOURCE_HTTP,
+    CMD_SOURCE_LOCAL
+};
+
+// Called on the weight task once the command completed - for CMD_TARE when
+// the tare itself finished. Same signature as Scale::TareCallback.
+typedef void (*CommandCallback)(bool success, void* context);
+
+struct Command {
+    CommandType type;
+    CommandSource source;
+    int32_t intValue;
+    float floatValue[2];
+    CommandCallback callback; // Optional
+    void* context;
+    uint32_t enqueuedUs;      // Set by push()
+};
+
+// Executes one command on the weight task, returns whether it was applied
+typedef bool (*CommandHandler)(const Command& command, void* context);
+
+// Per command type, measured on the consumer side
+struct CommandStats {
+    uint32_t executed;
+    uint32_t failed;
+    uint64_t waitTotalUs;  // Enqueue to start of execution
+    uint32_t waitMaxUs;
+    uint64_t execTotalUs;  // Handler run time
+    uint32_t execMaxUs;
+};
+
+// Bounded lock-free multi-producer single-consumer queue (Vyukov's per-cell
+// sequence scheme). Producers (NimBLE host task, async_tcp task, loop) claim a
+// cell with one CAS and never wait for each other or for the consumer; a full
+// queue rejects the command instead of blocking the radio or network stack.
+class CommandQueue {
+public:
+    CommandQueue();
+
+    // Any task - returns false when the queue is full
+    bool push(const Command& command);
+    bool push(CommandType type, CommandSource source, int32_t intValue = 0, float value0 = 0.0f, float value1 = 0.0f,
+              CommandCallback callback = nullptr, void* context = nullptr);
+    void setWakeCallback(void (*wake)(void*), void* context); // Called after each push - wakes the consumer task
+
+    // Consumer task only - runs the handler for every queued command
+    size_t process(CommandHandler handler, void* context);
+
+    static const char* getTypeName(CommandType type);
+    const CommandStats& getStats(CommandType type) const { return stats[type]; }
+    uint32_t getRejected() const { return rejected.load(std::memory_order_relaxed); }
+    void writeStatsJson(JsonWriter& json) const;
+
+private:
+    static const uint32_t MASK = COMMAND_QUEUE_CAPACITY - 1;
+    static_assert((COMMAND_QUEUE_CAPACITY & MASK) == 0, "CommandQueue capacity must be a power of two");
+
+    struct Cell {
+        std::atomic<uint32_t> sequence; // == position: free for that producer; == position + 1: holds a command
+        Command command;
+    };
+
+    Cell cells[COMMAND_QUEUE_CAPACITY];
+    std::atomic<uint32_t> enqueuePos;
+    uint32_t dequeuePos; // Consumer only
+
+    void (*wakeCallback)(void*);
+    void* wakeContext;
+
+    std::atomic<uint32_t> rejected;
+    uint32_t maxDepth; // Deepest backlog seen by the consumer
+    CommandStats stats[CMD_TYPE_COUNT];
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef CONNECTIONTABLE_H
+#define CONNECTIONTABLE_H
+
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+#include "ConnectionTuner.h"
+#include "TxPowerController.h"
+
+class JsonWriter;
+
+#ifdef CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#define BLE_MAX_CONNECTIONS CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#else
+#define BLE_MAX_CONNECTIONS 3
+#endif
+
+// Notifying characteristics tracked per connection (bit index in subscriptions)
+enum BleCharacteristicId : uint8_t {
+    BLE_CHAR_GAGGIMATE = 0,
+    BLE_CHAR_BEANCONQUEROR,
+    BLE_CHAR_COMMAND,
+    BLE_CHAR_BATCH,
+    BLE_CHAR_COUNT
+};
+
+struct PeerConnection {
+    volatile bool active;
+    volatile bool welcomePending;   // WeighMyBru handshake not sent yet
+    volatile uint16_t handle;
+    volatile uint8_t subscriptions; // Bit per BleCharacteristicId, from the client's CCCD writes
+    volatile uint8_t frameExtension; // GaggiMate frame extension version the client asked for, 0 = none
+    uint32_t connectedMs;
+
+    // Throughput - notifications queued for this peer
+    uint32_t notifications;
+    uint32_t bytes;
+    uint32_t windowBytes;
+    uint32_t windowStartMs;
+    uint32_t bytesPerSecond; // Over the last complete window
+
+    ConnectionTuner tuner;   // Link parameters are negotiated per connection
+    TxPowerController power; // RSSI sampling and transmit power per connection
+};
+
+// One slot per central NimBLE can hold. Connect, disconnect and subscribe
+// callbacks arrive on the NimBLE host task and only flip the flags; the BLE
+// task reads the table to decide which characteristics are worth encoding.
+class ConnectionTable {
+public:
+    ConnectionTable();
+
+    // NimBLE host task
+    PeerConnection* add(NimBLEServer* server, uint16_t handle);
+    uint32_t remove(uint16_t handle); // Returns how long the connection lasted (ms)
+    void setSubscribed(uint16_t handle, BleCharacteristicId id, bool subscribed);
+    void setFrameExtension(uint16_t handle, uint8_t version);
+
+    // BLE / weight task
+    void update(bool brewing);                              // Throughput windows, per-link tuning and power
+    void recordNotify(BleCharacteristicId id, size_t length); // Counts against every subscribed peer
+    bool isSubscribed(BleCharacteristicId id) const;         // By any connected central
+    uint8_t getSubscriberCount(BleCharacteristicId id) const;
+    uint16_t getMinMtu(NimBLEServer* server, BleCharacteristicId id) const; // Smallest MTU among subscribers, 0 if none
+    uint8_t getFrameExtension() const; // Highest version every requesting GaggiMate subscriber understands, 0 if none asked
+    uint8_t getCount() const;
+    bool hasFreeSlot() const { return getCount() < BLE_MAX_CONNECTIONS; }
+    PeerConnection* first();                                // Oldest active connection, nullptr if none
+
+    PeerConnection& slot(int index) { return slots[index]; }
+    void writeJson(JsonWriter& json, NimBLEServer* server) const;
+
+private:
+    static const uint32_t THROUGHPUT_WINDOW_MS = 1000;
+
+    PeerConnection slots[BLE_MAX_CONNECTIONS];
+};
+
+#endif
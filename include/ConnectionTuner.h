@@ -0,0 +1,53 @@
+#ifndef CONNECTIONTUNER_H
+#define CONNECTIONTUNER_H
+
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+
+class JsonWriter;
+
+// Connection parameters in BLE units: interval 1.25 ms, timeout 10 ms
+struct ConnectionProfile {
+    const char* name;
+    uint16_t minInterval;
+    uint16_t maxInterval;
+    uint16_t latency;      // Connection events the peripheral may skip
+    uint16_t timeout;
+};
+
+// Requests link parameters that match what the scale is doing. While brewing
+// the weight-to-app latency floor is the connection interval, so ask for
+// 7.5-15 ms with no peripheral latency; when idle relax the interval and allow
+// latency to save radio time. On connect it also asks for the 2M PHY and data
+// length extension. Central decides - the negotiated values are reported as-is.
+class ConnectionTuner {
+public:
+    static const ConnectionProfile PROFILE_BREWING;
+    static const ConnectionProfile PROFILE_IDLE;
+
+    ConnectionTuner();
+    void onConnect(NimBLEServer* server, uint16_t connHandle); // NimBLE host task - only records the handle
+    void onDisconnect();
+    void update(bool brewing); // BLE task - applies pending requests and profile switches
+
+    const ConnectionProfile& getRequestedProfile() const { return *requested; }
+    void writeInfoJson(JsonWriter& json) const; // Requested profile and the parameters actually negotiated
+
+private:
+    static const uint32_t IDLE_DELAY_MS = 5000;    // Stay on the brewing profile this long after brewing ends
+    static const uint32_t CONNECT_SETTLE_MS = 500; // Let discovery finish before asking for changes
+    static const uint16_t DATA_LEN_OCTETS = 251;   // LE data length extension maximum
+
+    NimBLEServer* server;
+    volatile uint16_t connHandle;
+    volatile bool connected;
+    volatile bool pendingSetup;    // Connected, PHY/DLE/profile not requested yet
+    uint32_t connectedAtMs;
+    const ConnectionProfile* requested;
+    uint32_t lastBrewingMs;
+    uint32_t profileRequests;
+
+    void requestProfile(const ConnectionProfile& profile);
+};
+
+#endif
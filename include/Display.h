@@ -4,12 +4,14 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include "TelemetryPublisher.h"
 
 class Scale; // Forward declaration
 class FlowRate; // Forward declaration
 class BluetoothScale; // Forward declaration
 class PowerManager; // Forward declaration
 class BatteryMonitor; // Forward declaration
+class ShotRecorder; // Forward declaration
 
 class Display {
 public:
@@ -45,9 +47,17 @@ public:
     // WiFi manager reference for network status display  
     void setWiFiManager(class WiFiManager* wifi);
     
+    // Shot recorder follows the timer - start/resume/stop record a shot
+    void setShotRecorder(ShotRecorder* recorder);
+    
+    // Published snapshot the main and status pages draw from
+    void setTelemetry(TelemetryPublisher* publisher);
+    
     // Timer management
     void startTimer();
     void stopTimer();
+    void startTimerAt(unsigned long startMs); // Fresh start backdated to a sample timestamp (auto timer)
+    void stopTimerAt(unsigned long stopMs);   // Stop with the elapsed time ending at stopMs
     void resetTimer();
     bool isTimerRunning() const;
     float getTimerSeconds() const;
@@ -62,6 +72,9 @@ private:
     PowerManager* powerManagerPtr;
     BatteryMonitor* batteryPtr;
     class WiFiManager* wifiManagerPtr;
+    ShotRecorder* shotRecorderPtr;
+    TelemetryPublisher* telemetryPtr;
+    TelemetrySnapshot telemetry; // Copy read at the start of each update()
     Adafruit_SSD1306* display;
     bool displayConnected; // Track if display is actually connected
     
@@ -88,7 +101,7 @@ private:
     static const unsigned long STATUS_PAGE_TIMEOUT = 10000; // 10 seconds timeout
     
     void drawWeight(float weight);
-    void showWeightWithFlowAndTimer(float weight); // Main display showing weight, flow rate, and timer
+    void showWeightWithFlowAndTimer(float weight, float flowRate, float timerSeconds); // Main display showing weight, flow rate, and timer
     void setupDisplay();
     void drawBluetoothStatus(); // Draw Bluetooth connection status icon
     void drawBatteryStatus(); // Draw battery status with 3-segment indicator
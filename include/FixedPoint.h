@@ -0,0 +1,67 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <stdint.h>
+#include <math.h>
+
+// Integer weight pipeline helpers. Filters run on offset-subtracted HX711
+// counts; the only conversion is counts -> centigrams at the output, using a
+// scale precomputed whenever the calibration factor changes. Pure integer
+// arithmetic so the result is identical on the ESP32 and on a host build, and
+// equal to lround(counts * 100.0 / calibrationFactor) in double.
+
+#define CG_PER_COUNT_FRACTION_BITS 24
+
+// The calibration factor as the exact fraction divisor / 2^shift (a float's
+// mantissa and exponent), plus a Q24 centigrams-per-count estimate.
+struct CentigramScale {
+    int32_t perCountQ24;  // 0 = uncalibrated
+    int32_t divisor;      // |calibrationFactor| * 2^shift, odd unless shift is 0
+    uint8_t shift;
+    bool negative;
+};
+
+// Returns an uncalibrated scale (perCountQ24 == 0) for a factor that can't be
+// represented: |factor| < 1 count per gram, >= 2^24, or not a number.
+inline CentigramScale centigramScale(float calibrationFactor) {
+    CentigramScale scale = { 0, 0, 0, false };
+    float magnitude = fabsf(calibrationFactor);
+    if (!(magnitude >= 1.0f && magnitude < 16777216.0f)) {
+        return scale;
+    }
+    int exponent;
+    int32_t mantissa = (int32_t)ldexpf(frexpf(magnitude, &exponent), 24);
+    int shift = 24 - exponent;
+    while ((mantissa & 1) == 0 && shift > 0) {
+        mantissa >>= 1;
+        shift--;
+    }
+    scale.perCountQ24 = (int32_t)lround(100.0 * (double)(1L << CG_PER_COUNT_FRACTION_BITS) / (double)magnitude);
+    scale.divisor = mantissa;
+    scale.shift = (uint8_t)shift;
+    scale.negative = calibrationFactor < 0.0f;
+    return scale;
+}
+
+// One int64 multiply by the Q24 factor gives the result to within 1 cg; the
+// exact fraction then settles the rounding (half away from zero, as lround).
+// Counts up to +/-2^24 keep every product below 2^55.
+inline int32_t countsToCentigrams(int32_t counts, const CentigramScale& scale) {
+    uint32_t magnitude = counts < 0 ? -(uint32_t)counts : (uint32_t)counts;
+    int64_t cg = ((int64_t)magnitude * scale.perCountQ24 + (1LL << (CG_PER_COUNT_FRACTION_BITS - 1))) >> CG_PER_COUNT_FRACTION_BITS;
+    int64_t twiceExact = ((int64_t)magnitude * 100) << (scale.shift + 1); // 2 * exact |cg| * divisor
+    while (twiceExact >= (2 * cg + 1) * scale.divisor) {
+        cg++;
+    }
+    while (cg > 0 && twiceExact < (2 * cg - 1) * scale.divisor) {
+        cg--;
+    }
+    return ((counts < 0) != scale.negative) ? -(int32_t)cg : (int32_t)cg;
+}
+
+// Threshold in grams -> count delta for comparisons inside the filters
+inline int32_t gramsToCounts(float grams, float calibrationFactor) {
+    return (int32_t)lroundf(grams * fabsf(calibrationFactor));
+}
+
+#endif
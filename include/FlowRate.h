@@ -1,13 +1,36 @@
 #pragma once
 
+#include <Preferences.h>
+#include "SampleRing.h"
+#include "WindowFilter.h"
+
 #define FLOWRATE_AVG_WINDOW 20  // Increased for better smoothing
+#define FLOWRATE_REGRESSION_SAMPLES 256 // Regression window capacity - 3s at 80 SPS
 
 class FlowRate {
 public:
+    // Differentiator used when the weight filter does not estimate flow itself
+    enum Mode {
+        MODE_DIFFERENCE = 0,  // Finite difference + deadband + weighted average (original algorithm)
+        MODE_REGRESSION = 1   // Least-squares slope over a sliding time window
+    };
+    
     FlowRate();
+    void begin(); // Load persisted mode and window
     void update(float currentWeight);
+    void update(float currentWeight, unsigned long timestampMs); // Timestamp of the underlying sample
+    void update(const WeightSample& sample); // Uses the filter's own flow estimate when it provides one
     float getFlowRate() const; // grams per second
     
+    void setMode(Mode mode);
+    Mode getMode() const { return mode; }
+    String getModeName() const { return mode == MODE_REGRESSION ? "regression" : "difference"; }
+    void setRegressionWindow(uint32_t windowMs); // 200-3000 ms
+    uint32_t getRegressionWindow() const { return regression.getWindowMs(); }
+    float getFitResidual() const { return fitResidual; }     // g RMS around the fitted line (regression mode)
+    float getFlowRateStdError() const { return flowStdError; } // g/s standard error of the slope (regression mode)
+    size_t getRegressionSamples() const { return regression.size(); }
+    
     // Timer-based average flow rate tracking
     void startTimerAveraging();
     void stopTimerAveraging();
@@ -36,6 +59,15 @@ private:
     bool hasValidTimerAverage;
     bool calculationPaused; // Flag to pause flow rate during tare operations
     
+    // Regression differentiator
+    Preferences preferences;
+    Mode mode;
+    SlidingSlope<FLOWRATE_REGRESSION_SAMPLES> regression;
+    int32_t lastWeightCg;
+    float fitResidual;
+    float flowStdError;
+    static const int32_t REGRESSION_JUMP_CG = 500; // >5g between samples is a cup, not a pour - restart the fit
+    
     // Flow rate filtering parameters
     static constexpr float WEIGHT_DEADBAND = 0.08f;     // Increased deadband for load cell noise
     static constexpr float MIN_DELTA_TIME = 0.15f;      // Increased to 150ms for much more stable readings
@@ -45,4 +77,7 @@ private:
     
     // Helper methods
     float calculateStableAverage(bool isWeightRemoval);
+    void updateDifference(float currentWeight, unsigned long timestampMs);
+    void updateRegression(int32_t weightCg, unsigned long timestampMs);
+    void applyEstimatedFlow(float estimatedFlow, float currentWeight, unsigned long timestampMs);
 };
@@ -0,0 +1,117 @@
+#ifndef GAGGIMATEFRAME_H
+#define GAGGIMATEFRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 20-byte WeighMyBru weight frame sent on the GaggiMate characteristic.
+// Plain C++ - the same decoder works in host tools and clients.
+//
+// Bytes 0-9 and the checksum are the original protocol; bytes 10-18 used to
+// be zero and now carry an optional extension. Clients that don't know it
+// ignore those bytes (the XOR checksum still covers the whole frame). It is
+// only filled in once a client asked for it in the 0x06 handshake - until
+// then frames are byte-for-byte the original ones.
+//
+//   0      product number      WEIGHMYBRU_PRODUCT_NUMBER
+//   1      message type        WEIGHMYBRU_MSG_WEIGHT
+//   2-5    reserved            0
+//   6      sign                '+' or '-'
+//   7-9    |weight|            centigrams, big-endian
+//   10     extension version   0 = no extension, else GAGGIMATE_EXTENSION_VERSION
+//   11-12  flow                i16 centigrams per second, big-endian
+//   13-15  timer               u24 ms, big-endian (saturates at 16777.215 s)
+//   16     state               GAGGIMATE_STATE_* / GAGGIMATE_FILTER_*
+//   17-18  sample sequence     u16, big-endian, wraps - gaps mean skipped samples
+//   19     checksum            XOR of bytes 0-18
+
+#define GAGGIMATE_FRAME_LENGTH 20
+#define GAGGIMATE_EXTENSION_VERSION 1
+#define WEIGHMYBRU_PRODUCT_NUMBER 0x03
+#define WEIGHMYBRU_MSG_WEIGHT 0x0B
+
+// State byte: filter state in bits 0-1 (same order as Scale::getFilterState())
+#define GAGGIMATE_FILTER_MASK        0x03
+#define GAGGIMATE_FILTER_STABLE      0x00
+#define GAGGIMATE_FILTER_BREWING     0x01
+#define GAGGIMATE_FILTER_TRANSITION  0x02
+#define GAGGIMATE_FILTER_KALMAN      0x03
+#define GAGGIMATE_STATE_TIMER_RUNNING 0x04
+#define GAGGIMATE_STATE_FLOWING       0x08 // Notify policy sees active flow
+
+struct GaggiMateWeight {
+    int32_t weightCg;     // Clamped to +/- 0xFFFFFF
+    uint8_t extension;    // 0 = bytes 10-18 left zero
+    int16_t flowCgps;
+    uint32_t timerMs;
+    uint8_t state;
+    uint16_t sequence;
+};
+
+namespace GaggiMateFrame {
+
+inline uint8_t checksum(const uint8_t* data, size_t length) {
+    uint8_t sum = data[0];
+    for (size_t i = 1; i < length; i++) {
+        sum ^= data[i];
+    }
+    return sum;
+}
+
+inline void encode(const GaggiMateWeight& frame, uint8_t out[GAGGIMATE_FRAME_LENGTH]) {
+    uint32_t absWeight = frame.weightCg < 0 ? -(int64_t)frame.weightCg : frame.weightCg;
+    if (absWeight > 0xFFFFFF) absWeight = 0xFFFFFF;
+
+    for (int i = 0; i < GAGGIMATE_FRAME_LENGTH; i++) {
+        out[i] = 0;
+    }
+    out[0] = WEIGHMYBRU_PRODUCT_NUMBER;
+    out[1] = WEIGHMYBRU_MSG_WEIGHT;
+    out[6] = frame.weightCg >= 0 ? 43 : 45;
+    out[7] = (absWeight >> 16) & 0xFF;
+    out[8] = (absWeight >> 8) & 0xFF;
+    out[9] = absWeight & 0xFF;
+
+    if (frame.extension != 0) {
+        uint32_t timer = frame.timerMs > 0xFFFFFF ? 0xFFFFFF : frame.timerMs;
+        out[10] = frame.extension;
+        out[11] = ((uint16_t)frame.flowCgps >> 8) & 0xFF;
+        out[12] = (uint16_t)frame.flowCgps & 0xFF;
+        out[13] = (timer >> 16) & 0xFF;
+        out[14] = (timer >> 8) & 0xFF;
+        out[15] = timer & 0xFF;
+        out[16] = frame.state;
+        out[17] = (frame.sequence >> 8) & 0xFF;
+        out[18] = frame.sequence & 0xFF;
+    }
+    out[GAGGIMATE_FRAME_LENGTH - 1] = checksum(out, GAGGIMATE_FRAME_LENGTH - 1);
+}
+
+// Returns false if the data is not a valid weight frame. Extension fields are
+// zero when the frame carries none or an unknown version.
+inline bool decode(const uint8_t* data, size_t length, GaggiMateWeight& frame) {
+    if (length < GAGGIMATE_FRAME_LENGTH || data[1] != WEIGHMYBRU_MSG_WEIGHT ||
+        checksum(data, GAGGIMATE_FRAME_LENGTH - 1) != data[GAGGIMATE_FRAME_LENGTH - 1]) {
+        return false;
+    }
+    int32_t absWeight = ((int32_t)data[7] << 16) | ((int32_t)data[8] << 8) | data[9];
+    frame.weightCg = data[6] == 45 ? -absWeight : absWeight;
+
+    frame.extension = data[10] == GAGGIMATE_EXTENSION_VERSION ? data[10] : 0;
+    if (frame.extension == 0) {
+        frame.flowCgps = 0;
+        frame.timerMs = 0;
+        frame.state = 0;
+        frame.sequence = 0;
+        return true;
+    }
+    frame.flowCgps = (int16_t)((data[11] << 8) | data[12]);
+    frame.timerMs = ((uint32_t)data[13] << 16) | ((uint32_t)data[14] << 8) | data[15];
+    frame.state = data[16];
+    frame.sequence = (data[17] << 8) | data[18];
+    return true;
+}
+
+} // namespace GaggiMateFrame
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <Arduino.h>
+
+// Streaming JSON writer for API responses. Output goes straight to a Print -
+// an AsyncResponseStream, or a FixedBufferPrint over a caller-owned buffer -
+// so building a response creates no String temporaries and never touches the
+// heap itself. Numbers are formatted with integer math in a stack buffer;
+// NaN and infinity are written as null.
+//
+// Commas are tracked per nesting level, so callers only open and close:
+//
+//   json.beginObject();
+//   json.field("weight", 18.25f, 2).field("connected", true);
+//   json.beginArray("tasks").value(1).value(2).endArray();
+//   json.endObject();
+//
+// key() names the next value, so a nested writer can open its own object:
+//
+//   json.key("scheduler");
+//   scheduler.writeStatsJson(json);
+class JsonWriter {
+public:
+    explicit JsonWriter(Print& out);
+
+    JsonWriter& beginObject();                 // Top level or array element
+    JsonWriter& beginObject(const char* key);
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& beginArray(const char* key);
+    JsonWriter& endArray();
+    JsonWriter& key(const char* key);          // Next value or begin* becomes this member
+
+    // Object members
+    JsonWriter& field(const char* key, bool value);
+    JsonWriter& field(const char* key, int value) { return field(key, (long long)value); }
+    JsonWriter& field(const char* key, unsigned int value) { return field(key, (unsigned long long)value); }
+    JsonWriter& field(const char* key, long value) { return field(key, (long long)value); }
+    JsonWriter& field(const char* key, unsigned long value) { return field(key, (unsigned long long)value); }
+    JsonWriter& field(const char* key, long long value);
+    JsonWriter& field(const char* key, unsigned long long value);
+    JsonWriter& field(const char* key, double value, uint8_t decimals = 2);
+    JsonWriter& field(const char* key, const char* value); // Escaped; nullptr writes null
+    JsonWriter& field(const char* key, const String& value) { return field(key, value.c_str()); }
+    JsonWriter& fieldNull(const char* key);
+    JsonWriter& fieldCentigrams(const char* key, int32_t cg, uint8_t decimals); // Exact fixed-point weight
+    JsonWriter& fieldIp(const char* key, const IPAddress& ip);                  // Dotted quad
+
+    // Array elements
+    JsonWriter& value(bool v);
+    JsonWriter& value(int v) { return value((long long)v); }
+    JsonWriter& value(unsigned int v) { return value((unsigned long long)v); }
+    JsonWriter& value(long v) { return value((long long)v); }
+    JsonWriter& value(unsigned long v) { return value((unsigned long long)v); }
+    JsonWriter& value(long long v);
+    JsonWriter& value(unsigned long long v);
+    JsonWriter& value(double v, uint8_t decimals = 2);
+    JsonWriter& value(const char* v);
+    JsonWriter& value(const String& v) { return value(v.c_str()); }
+    JsonWriter& valueNull();
+
+    // Weight with 1 or 2 decimals using integer math only, so text and JSON
+    // report exactly the value sent over BLE. Returns the length written.
+    static size_t formatCentigrams(char* buffer, size_t size, int32_t cg, uint8_t decimals);
+
+    size_t getLength() const { return length; } // Bytes written so far
+
+private:
+    static const uint8_t MAX_DEPTH = 16;
+
+    Print& out;
+    uint8_t depth;
+    uint16_t hasItems;   // Bit per nesting level - a separator is due before the next item
+    bool keyPending;     // key() was written - the next value needs no separator
+    size_t length;
+
+    void separator();
+    void member(const char* name);
+    void raw(const char* text);
+    void raw(const char* text, size_t count);
+    void string(const char* text);
+    void number(long long value);
+    void number(unsigned long long value, bool negative);
+    void number(double value, uint8_t decimals);
+    void open(char bracket);
+    void close(char bracket);
+};
+
+// Print over a fixed caller-owned buffer, always NUL-terminated. Output that
+// does not fit is dropped and flagged.
+class FixedBufferPrint : public Print {
+public:
+    FixedBufferPrint(char* buffer, size_t capacity);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t size) override;
+    using Print::write;
+
+    void clear();
+    const char* c_str() const { return buffer; }
+    size_t length() const { return used; }
+    bool overflowed() const { return overflow; }
+
+private:
+    char* buffer;
+    size_t capacity;
+    size_t used;
+    bool overflow;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef KALMANFILTER_H
+#define KALMANFILTER_H
+
+#include <stdint.h>
+
+// Constant-velocity Kalman filter estimating weight (g) and mass flow (g/s)
+// jointly from raw weight samples. Process noise is a white-noise
+// acceleration model, so processNoise is in (g/s^2)^2 per second and
+// measurementNoise is the load cell variance in g^2.
+class WeightFlowKalman {
+public:
+    static constexpr float Q_DEFAULT = 0.0013f;
+    static constexpr float R_DEFAULT = 0.0025f;
+
+    WeightFlowKalman() : q(Q_DEFAULT), r(R_DEFAULT), resetThreshold(5.0f), stepThreshold(2.0f) { reset(0.0f, 0); initialized = false; }
+
+    void setNoise(float processNoise, float measurementNoise) {
+        q = processNoise;
+        r = measurementNoise;
+    }
+
+    // Innovations larger than this (cup placed/removed) restart the estimate
+    void setResetThreshold(float grams) { resetThreshold = grams; }
+
+    // Smaller steps: an innovation beyond this is held back as a possible
+    // outlier; a second one on the same side confirms a step and restarts
+    // the estimate there, a step the constant-velocity model would otherwise
+    // take seconds to follow
+    void setStepThreshold(float grams) { stepThreshold = grams; }
+
+    void reset(float weight, uint32_t timestampMs) {
+        x0 = weight;
+        x1 = 0.0f;
+        P00 = r;
+        P01 = 0.0f;
+        P11 = 1.0f;
+        lastMs = timestampMs;
+        stepSign = 0;
+        initialized = true;
+    }
+
+    void update(float measurement, uint32_t timestampMs) {
+        if (!initialized) {
+            reset(measurement, timestampMs);
+            return;
+        }
+
+        float dt = (float)(int32_t)(timestampMs - lastMs) / 1000.0f;
+        lastMs = timestampMs;
+        if (dt < 0.0f) dt = 0.0f;
+        if (dt > 1.0f) dt = 1.0f; // Long gaps - don't extrapolate stale flow for seconds
+
+        // Predict: x = F x, P = F P F' + Q
+        float dt2 = dt * dt;
+        x0 += dt * x1;
+        P00 += 2.0f * dt * P01 + dt2 * P11 + q * dt2 * dt / 3.0f;
+        P01 += dt * P11 + q * dt2 / 2.0f;
+        P11 += q * dt;
+
+        float innovation = measurement - x0;
+        if (innovation > resetThreshold || innovation < -resetThreshold) {
+            reset(measurement, timestampMs);
+            return;
+        }
+        int8_t sign = innovation > stepThreshold ? 1 : (innovation < -stepThreshold ? -1 : 0);
+        if (sign != 0) {
+            if (sign == stepSign) {
+                reset(measurement, timestampMs);
+            } else {
+                stepSign = sign; // Skip it - the covariance keeps the prediction's uncertainty
+            }
+            return;
+        }
+        stepSign = 0;
+
+        // Update with H = [1 0]
+        float S = P00 + r;
+        float K0 = P00 / S;
+        float K1 = P01 / S;
+        x0 += K0 * innovation;
+        x1 += K1 * innovation;
+        P11 -= K1 * P01;
+        P01 -= K0 * P01;
+        P00 -= K0 * P00;
+    }
+
+    float weight() const { return x0; }
+    float flow() const { return x1; }
+    float getProcessNoise() const { return q; }
+    float getMeasurementNoise() const { return r; }
+
+private:
+    float x0, x1;          // State: weight, flow
+    float P00, P01, P11;   // Symmetric covariance
+    float q, r;
+    float resetThreshold;
+    float stepThreshold;
+    int8_t stepSign;       // Side of a held-back step innovation, 0 = none
+    uint32_t lastMs;
+    bool initialized;
+};
+
+#endif
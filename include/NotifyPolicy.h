@@ -0,0 +1,65 @@
+#ifndef NOTIFYPOLICY_H
+#define NOTIFYPOLICY_H
+
+#include <Arduino.h>
+
+// Per-characteristic notification counters
+struct NotifyStats {
+    uint32_t sent;        // Accepted by the stack (SUCCESS_NOTIFY/INDICATE)
+    uint32_t suppressed;  // Skipped by the policy, or no client subscribed
+    uint32_t failed;      // Stack error (GATT error, out of buffers, indicate timeout)
+};
+
+// Decides when a weight update is worth radio time:
+//  - active (flow above ACTIVE_FLOW, or within ACTIVE_HOLD_MS of it): every new sample
+//  - idle: only when the weight moved beyond the deadband since the last send
+//  - idle and unchanged: a keepalive every keepaliveMs so clients see the link is alive
+class NotifyPolicy {
+public:
+    enum Decision {
+        SUPPRESS = 0,
+        SEND_ACTIVE,     // Flowing - every sample
+        SEND_CHANGE,     // Idle but moved beyond the deadband
+        SEND_KEEPALIVE   // Idle and unchanged for keepaliveMs
+    };
+
+    NotifyPolicy();
+    Decision evaluate(int32_t weightCg, float flowRate, uint32_t now);
+    void markSent(int32_t weightCg, uint32_t now);
+    void reset(); // New connection - the next evaluation always sends
+
+    bool isActive() const { return active; }
+    uint32_t getLastSentMs() const { return lastSentMs; }
+
+    void setDeadbandCg(int32_t deadband) { deadbandCg = max(deadband, (int32_t)0); }
+    int32_t getDeadbandCg() const { return deadbandCg; }
+    void setKeepaliveMs(uint32_t ms) { keepaliveMs = constrain(ms, 200UL, 10000UL); }
+    uint32_t getKeepaliveMs() const { return keepaliveMs; }
+
+    // How often each decision was taken
+    uint32_t getActiveSends() const { return activeSends; }
+    uint32_t getChangeSends() const { return changeSends; }
+    uint32_t getKeepaliveSends() const { return keepaliveSends; }
+    uint32_t getSuppressed() const { return suppressed; }
+
+private:
+    static constexpr float ACTIVE_FLOW = 0.1f;   // g/s
+    static const uint32_t ACTIVE_HOLD_MS = 1500; // Keep the full rate through the drip tail
+    static const uint32_t MIN_INTERVAL_MS = 10;  // Caps bursts from a backlog of samples
+
+    int32_t deadbandCg;
+    uint32_t keepaliveMs;
+
+    bool active;
+    bool forceNext;
+    uint32_t lastActiveMs;
+    int32_t lastSentCg;
+    uint32_t lastSentMs;
+
+    uint32_t activeSends;
+    uint32_t changeSends;
+    uint32_t keepaliveSends;
+    uint32_t suppressed;
+};
+
+#endif
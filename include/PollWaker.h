@@ -0,0 +1,44 @@
+#ifndef POLLWAKER_H
+#define POLLWAKER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+class AsyncClient;
+struct tcp_pcb;
+class JsonWriter;
+
+// Runs the poll handler of a few async_tcp connections now instead of on
+// AsyncTCP's next connection poll (every ~500 ms). Connections are added and
+// removed on async_tcp; wake() may be called from any task and only posts one
+// callback to the lwIP thread. There each registered pcb that is still an
+// active connection with its AsyncClient attached gets the poll callback lwIP
+// itself would call, which AsyncTCP queues to async_tcp as a poll event - so
+// the handler runs on async_tcp like any other. Wakes coalesce until the lwIP
+// thread has run the previous one.
+class PollWaker {
+public:
+    static const size_t SLOTS = 4;
+
+    PollWaker();
+
+    int add(AsyncClient* client);   // async_tcp - returns the slot, -1 when all are taken
+    void remove(int slot);          // async_tcp
+    bool empty() const { return registered.load() == 0; }
+    void wake();                    // Any task
+    void writeStatsJson(JsonWriter& json) const;
+
+private:
+    std::atomic<tcp_pcb*> pcbs[SLOTS];
+    std::atomic<AsyncClient*> clients[SLOTS];
+    std::atomic<uint32_t> registered;
+    std::atomic<bool> pending;      // Callback posted, not yet run
+
+    std::atomic<uint32_t> posted;
+    std::atomic<uint32_t> coalesced;
+    std::atomic<uint32_t> queueFull;
+
+    static void run(void* context); // lwIP thread
+};
+
+#endif
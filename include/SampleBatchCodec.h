@@ -0,0 +1,182 @@
+#ifndef SAMPLEBATCHCODEC_H
+#define SAMPLEBATCHCODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Batched sample frame for the multi-sample BLE characteristic. Plain C++ with
+// no Arduino dependency, so clients and host tools can use the same decoder.
+//
+// Frame (little-endian header, then varints):
+//   u8  version          SAMPLE_BATCH_VERSION
+//   u8  count            samples in the frame (>= 1)
+//   u32 firstSequence    WeightSample sequence of the first sample; the rest are consecutive
+//   u32 baseTimeMs       timestamp of the first sample (device millis())
+//   zigzag varint        weight of the first sample, centigrams
+//   count-1 times:
+//     varint             ms since the previous sample
+//     zigzag varint      weight change since the previous sample, centigrams
+//
+// A steady pour at 80 SPS costs 2 bytes per sample, so a 244-byte payload
+// carries ~115 samples instead of one.
+
+#define SAMPLE_BATCH_VERSION 1
+#define SAMPLE_BATCH_HEADER_SIZE 10
+#define SAMPLE_BATCH_MAX_SAMPLE_SIZE 10 // Worst case: two 5-byte varints
+
+struct BatchSample {
+    uint32_t sequence;
+    uint32_t timestampMs;
+    int32_t weightCg;
+};
+
+namespace SampleBatch {
+
+inline uint32_t zigzagEncode(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+inline int32_t zigzagDecode(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+inline size_t putVarint(uint8_t* out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+// Returns bytes consumed, 0 if the varint is truncated or longer than 5 bytes
+inline size_t getVarint(const uint8_t* in, size_t available, uint32_t& value) {
+    value = 0;
+    for (size_t n = 0; n < available && n < 5; n++) {
+        value |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+        if ((in[n] & 0x80) == 0) {
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+inline void putU32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+inline uint32_t getU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+// Decodes one frame into out. Returns the number of samples, 0 if the frame is
+// malformed or has more samples than maxSamples.
+inline size_t decode(const uint8_t* frame, size_t length, BatchSample* out, size_t maxSamples) {
+    if (length < SAMPLE_BATCH_HEADER_SIZE + 1 || frame[0] != SAMPLE_BATCH_VERSION) {
+        return 0;
+    }
+    size_t count = frame[1];
+    if (count == 0 || count > maxSamples) {
+        return 0;
+    }
+    uint32_t sequence = getU32(&frame[2]);
+    uint32_t timeMs = getU32(&frame[6]);
+    size_t pos = SAMPLE_BATCH_HEADER_SIZE;
+
+    uint32_t raw;
+    size_t n = getVarint(&frame[pos], length - pos, raw);
+    if (n == 0) return 0;
+    pos += n;
+    int32_t weightCg = zigzagDecode(raw);
+    out[0] = { sequence, timeMs, weightCg };
+
+    for (size_t i = 1; i < count; i++) {
+        n = getVarint(&frame[pos], length - pos, raw);
+        if (n == 0) return 0;
+        pos += n;
+        timeMs += raw;
+        n = getVarint(&frame[pos], length - pos, raw);
+        if (n == 0) return 0;
+        pos += n;
+        weightCg += zigzagDecode(raw);
+        out[i] = { sequence + (uint32_t)i, timeMs, weightCg };
+    }
+    return pos == length ? count : 0;
+}
+
+} // namespace SampleBatch
+
+// Builds one frame in a caller-owned buffer - no allocation. add() refuses a
+// sample that doesn't fit or that breaks the consecutive sequence; the
+// caller then sends the frame and starts a new one.
+class SampleBatchEncoder {
+public:
+    SampleBatchEncoder() : buffer(nullptr), capacity(0), length(0), count(0), lastSequence(0), lastTimeMs(0), lastWeightCg(0) {}
+
+    void begin(uint8_t* out, size_t outCapacity) {
+        buffer = out;
+        capacity = outCapacity;
+        reset();
+    }
+
+    void reset() {
+        length = 0;
+        count = 0;
+    }
+
+    bool add(const BatchSample& sample) {
+        if (buffer == nullptr || count == 255) {
+            return false;
+        }
+        if (count == 0) {
+            if (capacity < SAMPLE_BATCH_HEADER_SIZE + 5) {
+                return false;
+            }
+            buffer[0] = SAMPLE_BATCH_VERSION;
+            SampleBatch::putU32(&buffer[2], sample.sequence);
+            SampleBatch::putU32(&buffer[6], sample.timestampMs);
+            length = SAMPLE_BATCH_HEADER_SIZE;
+            length += SampleBatch::putVarint(&buffer[length], SampleBatch::zigzagEncode(sample.weightCg));
+        } else {
+            if (sample.sequence != lastSequence + 1) {
+                return false;
+            }
+            // Encode aside first so a sample that doesn't fit leaves the frame intact
+            uint8_t encoded[SAMPLE_BATCH_MAX_SAMPLE_SIZE];
+            size_t n = SampleBatch::putVarint(encoded, sample.timestampMs - lastTimeMs);
+            n += SampleBatch::putVarint(&encoded[n], SampleBatch::zigzagEncode(sample.weightCg - lastWeightCg));
+            if (length + n > capacity) {
+                return false;
+            }
+            memcpy(&buffer[length], encoded, n);
+            length += n;
+        }
+        count++;
+        buffer[1] = (uint8_t)count;
+        lastSequence = sample.sequence;
+        lastTimeMs = sample.timestampMs;
+        lastWeightCg = sample.weightCg;
+        return true;
+    }
+
+    size_t size() const { return length; }
+    uint8_t samples() const { return count; }
+    bool empty() const { return count == 0; }
+    const uint8_t* data() const { return buffer; }
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t length;
+    uint8_t count;
+    uint32_t lastSequence;
+    uint32_t lastTimeMs;
+    int32_t lastWeightCg;
+};
+
+#endif
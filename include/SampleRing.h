@@ -0,0 +1,92 @@
+#ifndef SAMPLERING_H
+#define SAMPLERING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Timestamped HX711 conversion as produced by the acquisition task
+struct RawSample {
+    uint32_t timestampMs; // millis() when DRDY was serviced
+    int32_t counts;       // Raw 24-bit ADC counts (sign extended)
+};
+
+// Filtered weight sample as produced by Scale for downstream consumers
+struct WeightSample {
+    uint32_t sequence;    // Monotonic sample number (matches RawSample order)
+    uint32_t timestampMs; // millis() of the underlying conversion
+    float weight;         // Filtered weight in grams
+    int32_t weightCg;     // Same weight in centigrams - the exact fixed-point value
+    float flowRate;       // Estimated flow in g/s, NAN when the filter mode does not estimate it
+};
+
+// Lock-free single-producer ring with any number of independent readers.
+// The producer never blocks and never waits for readers; each reader keeps
+// its own cursor and detects (and counts) samples it was too slow to see.
+// Capacity must be a power of two.
+template <typename T, size_t N>
+class SampleRing {
+    static_assert((N & (N - 1)) == 0, "SampleRing capacity must be a power of two");
+
+public:
+    SampleRing() : head(0) {}
+
+    // Producer side - must only be called from one task/ISR
+    void push(const T& sample) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        buffer[h & (N - 1)] = sample;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Reader side - cursor is owned by the caller and starts at current()
+    uint32_t current() const {
+        return head.load(std::memory_order_acquire);
+    }
+
+    // Pops the next sample for this cursor. Returns false when caught up.
+    // If the reader fell too far behind (the slot it wants may be rewritten
+    // at any moment) the cursor skips ahead to the oldest safe sample and
+    // the number of lost samples is added to *dropped (if provided).
+    bool pop(uint32_t& cursor, T& out, uint32_t* dropped = nullptr) const {
+        for (;;) {
+            uint32_t h = head.load(std::memory_order_acquire);
+            if (cursor == h) {
+                return false;
+            }
+            if (h - cursor >= N) {
+                if (dropped) *dropped += (h - cursor) - (N - 1);
+                cursor = h - (N - 1);
+            }
+            out = buffer[cursor & (N - 1)];
+            // Validate that the slot was not overwritten while copying
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (head.load(std::memory_order_relaxed) - cursor < N) {
+                cursor++;
+                return true;
+            }
+        }
+    }
+
+    // Copies the most recent sample. Returns false if nothing was pushed yet.
+    bool latest(T& out) const {
+        for (;;) {
+            uint32_t h = head.load(std::memory_order_acquire);
+            if (h == 0) {
+                return false;
+            }
+            out = buffer[(h - 1) & (N - 1)];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (head.load(std::memory_order_relaxed) - (h - 1) < N) {
+                return true;
+            }
+        }
+    }
+
+    uint32_t totalPushed() const { return head.load(std::memory_order_relaxed); }
+
+private:
+    T buffer[N];
+    std::atomic<uint32_t> head;
+};
+
+#endif
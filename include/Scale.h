@@ -3,22 +3,69 @@
 
 #include <HX711.h>
 #include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "SampleRing.h"
+#include "WindowFilter.h"
+#include "KalmanFilter.h"
+#include "FixedPoint.h"
+
+// Ring sizes - 64 conversions is 6.4s at 10 SPS or 0.8s at 80 SPS
+#define RAW_SAMPLE_RING_SIZE 64
+#define WEIGHT_SAMPLE_RING_SIZE 64
+
+typedef SampleRing<RawSample, RAW_SAMPLE_RING_SIZE> RawSampleRing;
+typedef SampleRing<WeightSample, WEIGHT_SAMPLE_RING_SIZE> WeightSampleRing;
 
 class Scale {
 public:
+    // Weight filter selection - persisted, switchable via /api/filter-settings
+    enum FilterMode {
+        FILTER_SMART = 0,  // Mean/median switching on brewing activity
+        FILTER_KALMAN = 1  // Joint weight + flow constant-velocity Kalman estimator
+    };
+    
+    // Asynchronous tare progress - reported via getTareState() and the completion callback
+    enum TareState {
+        TARE_IDLE = 0,    // No tare requested since boot
+        TARE_PENDING = 1, // Averaging conversions from the sample stream
+        TARE_DONE = 2,    // Last tare completed and the new offset is live
+        TARE_FAILED = 3   // Last tare timed out waiting for conversions
+    };
+    typedef void (*TareCallback)(bool success, void* context);
+    
     Scale(uint8_t dataPin, uint8_t clockPin, float calibrationFactor);
-    bool begin();  // Returns true if successful, false if HX711 fails
-    void tare(uint8_t times = 20);
+    bool begin();  // Probes the HX711 and starts acquisition; returns false if HX711 fails. Call requestTare() next.
+    
+    // Non-blocking tare: averages the next `times` conversions while the weight stream keeps
+    // running, then swaps in the new offset. The callback runs from the task that calls getWeight().
+    // Requests made while a tare is averaging start a fresh tare once it completes.
+    bool requestTare(uint8_t times = 20, TareCallback callback = nullptr, void* context = nullptr);
+    TareState getTareState() const { return tareState; }
+    const char* getTareStateName() const;
+    uint32_t getTareCount() const { return tareCount; } // Completed tares since boot
     void set_scale(float factor);
-    float getWeight();
+    float getWeight();  // Drains pending conversions through the filter, returns latest weight
     float getCurrentWeight();
+    int32_t getCurrentWeightCg(); // Latest filtered weight in centigrams (exact, no float rounding)
     long getRawValue();
+    
+    // Interrupt-driven acquisition - every HX711 conversion lands in rawRing
+    bool startAcquisition();
+    bool isAcquisitionRunning() const { return acquisitionTask != nullptr; }
+    bool getLatestSample(WeightSample& sample) const; // Most recent filtered sample
+    const WeightSampleRing& getWeightRing() const { return weightRing; } // For per-consumer cursors
+    uint32_t getSampleCount() const { return rawRing.totalPushed(); }
+    uint32_t getDroppedSamples() const { return droppedSamples; }
+    void setSampleCallback(void (*callback)()) { sampleCallback = callback; } // Called from the acquisition task per conversion
     void saveCalibration(); // Save calibration factor to NVS
     void loadCalibration(); // Load calibration factor from NVS
     float getCalibrationFactor() const { return calibrationFactor; } // Getter for API
     bool isHX711Connected() const { return isConnected; } // Check if HX711 is responding
     
     // Filtering configuration - adjustable for different load cells
+    static constexpr float JUMP_THRESHOLD_G = 5.0f; // Change that bypasses the filters (cup placed or lifted)
     void setBrewingThreshold(float threshold);
     void setStabilityTimeout(unsigned long timeout);
     void setMedianSamples(int samples);
@@ -28,7 +75,18 @@ public:
     unsigned long getStabilityTimeout() const { return stabilityTimeout; }
     int getMedianSamples() const { return medianSamples; }
     int getAverageSamples() const { return averageSamples; }
-    String getFilterState() const; // Get current filter state as string for debugging
+    
+    void setFilterMode(FilterMode mode);
+    void setKalmanNoise(float processNoise, float measurementNoise);
+    FilterMode getFilterMode() const { return filterMode; }
+    String getFilterModeName() const { return filterMode == FILTER_KALMAN ? "kalman" : "smart"; }
+    float getKalmanProcessNoise() const { return kalmanFilter.getProcessNoise(); }
+    float getKalmanMeasurementNoise() const { return kalmanFilter.getMeasurementNoise(); }
+    float getEstimatedFlowRate() const; // Kalman flow estimate in g/s (0 in smart mode)
+    const char* getFilterState() const; // Get current filter state as string for debugging
+    uint8_t getFilterStateCode() const { return filterMode == FILTER_KALMAN ? 3 : (uint8_t)currentFilterState; } // getFilterState() order, 3 = KALMAN
+    uint32_t getFilterCycles() const { return filterCycles; } // Average CPU cycles spent filtering one sample
+    static int getMaxSamples() { return MAX_SAMPLES; }
     
     void saveFilterSettings();
     void loadFilterSettings();
@@ -43,15 +101,58 @@ private:
     uint8_t clockPin;
     float calibrationFactor = 0.0f;
     float currentWeight;
-    bool isConnected = false;  // Track HX711 connection status
+    int32_t currentWeightCg = 0;
+    
+    // Fixed-point pipeline - filters run on offset-subtracted counts, scaled once at the output
+    int32_t currentCounts = 0;         // Filtered counts behind currentWeightCg
+    CentigramScale cgScale = {};       // Output scale, perCountQ24 0 while uncalibrated
+    int32_t brewingThresholdCounts = 0;
+    int32_t jumpThresholdCounts = 0;   // JUMP_THRESHOLD_G in counts
+    void updateFixedPointScale();      // Recompute after calibration/threshold changes
+    std::atomic<bool> isConnected{false};  // Track HX711 connection status - set once acquisition is running
     class FlowRate* flowRatePtr = nullptr; // For pausing flow rate during tare
     
-    // Smart filtering variables - reduced buffer for faster response
-    static const int MAX_SAMPLES = 10;  // Reduced from 50 to 10 for faster response
-    float readings[MAX_SAMPLES];
-    int readingIndex = 0;
+    // Acquisition task state - producer side of rawRing
+    RawSampleRing rawRing;
+    WeightSampleRing weightRing;
+    uint32_t rawCursor = 0;         // Scale's own read position in rawRing
+    uint32_t droppedSamples = 0;    // Conversions lost because getWeight() fell behind
+    TaskHandle_t acquisitionTask = nullptr;
+    void (*sampleCallback)() = nullptr;
+    static void IRAM_ATTR onDataReady(void* arg);
+    static void acquisitionLoop(void* arg);
+    void processSample(const RawSample& sample);
+    
+    // Tare job - requests are queued under tareLock from any task, the job itself
+    // only runs on the task that calls getWeight() so it never races the filters
+    static const int TARE_MAX_WAITERS = 4;
+    struct TareWaiter {
+        TareCallback callback;
+        void* context;
+    };
+    portMUX_TYPE tareLock = portMUX_INITIALIZER_UNLOCKED;
+    volatile TareState tareState = TARE_IDLE;
+    uint8_t requestedTareSamples = 0;          // 0 = no request queued
+    unsigned long requestedTareTime = 0;
+    TareWaiter requestedWaiters[TARE_MAX_WAITERS];
+    uint8_t requestedWaiterCount = 0;
+    bool tareActive = false;
+    uint8_t tareTarget = 0;
+    uint8_t tareCollected = 0;
+    int64_t tareSum = 0;
+    unsigned long tareStartTime = 0;
+    TareWaiter activeWaiters[TARE_MAX_WAITERS];
+    uint8_t activeWaiterCount = 0;
+    volatile uint32_t tareCount = 0;
+    void serviceTare();
+    void finishTare(bool success);
+    
+    // Smart filtering windows - incremental, so per-sample cost does not grow with window size
+    static const int MAX_SAMPLES = 64;
+    SlidingMean<int32_t, int64_t, MAX_SAMPLES> averageWindow;
+    SlidingMedian<int32_t, MAX_SAMPLES> medianWindow;
     bool samplesInitialized = false;
-    float previousFilteredWeight = 0;
+    uint32_t filterCycles = 0;  // Exponential average of cycles per processSample()
     
     // Brewing state tracking for smart filtering
     enum FilterState {
@@ -61,7 +162,7 @@ private:
     };
     FilterState currentFilterState = STABLE;
     unsigned long lastBrewingActivity = 0;  // Track when brewing was last detected
-    float lastStableWeight = 0.0f;          // Last weight when in stable state
+    int32_t lastStableCounts = 0;           // Last filtered counts when in stable state
     
     // Configurable filtering parameters
     float brewingThreshold = 0.15f;  // Keep for API compatibility
@@ -69,10 +170,13 @@ private:
     int medianSamples = 3;  // Keep for API compatibility
     int averageSamples = 2;  // Samples for average filter - reduced for faster response
     
+    // Kalman estimator mode
+    FilterMode filterMode = FILTER_SMART;
+    WeightFlowKalman kalmanFilter;
+    
     // Filter methods
-    float medianFilter(int samples);
-    float averageFilter(int samples);
-    void initializeSamples(float initialValue);
+    int32_t smartFilter(int32_t counts, unsigned long currentTime);
+    void initializeSamples(int32_t initialCounts);
 };
 
 #endif
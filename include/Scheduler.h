@@ -0,0 +1,59 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+class JsonWriter;
+
+#define SCHEDULER_MAX_TASKS 12      // Static task table size (one notification bit per task)
+#define SCHEDULER_JITTER_BUCKETS 8  // <100us, <500us, <1ms, <2ms, <5ms, <10ms, <50ms, >=50ms
+
+typedef void (*SchedulerCallback)();
+
+struct ScheduledTask {
+    const char* name;
+    SchedulerCallback callback;
+    uint32_t periodUs;      // Cadence - the task is due every period
+    uint32_t deadlineUs;    // Must finish within this long after becoming due
+    uint8_t priority;       // Higher runs first when several tasks are due together
+    int64_t nextRunUs;      // Next due time (esp_timer clock)
+
+    // Statistics
+    uint32_t runs;
+    uint32_t overruns;      // Finished after its deadline
+    uint32_t skipped;       // Whole periods missed because the loop was busy
+    uint32_t notifications; // Runs triggered early by notify()
+    uint32_t maxJitterUs;   // Worst lateness between due time and start
+    uint32_t maxRunUs;      // Worst execution time
+    uint32_t jitterHistogram[SCHEDULER_JITTER_BUCKETS];
+};
+
+// Cooperative, tickless scheduler for the Arduino loop task. Instead of
+// polling, the loop blocks on its FreeRTOS task notification until the next
+// task is due or another task/ISR calls notify() for an event-driven task.
+class Scheduler {
+public:
+    Scheduler();
+    void begin(); // Must be called from the task that will call runOnce()
+    int addTask(const char* name, SchedulerCallback callback, uint32_t periodMs,
+                uint8_t priority, uint32_t deadlineMs); // Returns task id or -1
+    void runOnce(); // Runs every due task by priority, then sleeps until the next one
+    void notify(int taskId); // Run a task as soon as possible (safe from other tasks)
+
+    size_t getTaskCount() const { return taskCount; }
+    const ScheduledTask& getTask(size_t index) const { return tasks[index]; }
+    void writeStatsJson(JsonWriter& json) const;
+
+private:
+    ScheduledTask tasks[SCHEDULER_MAX_TASKS];
+    size_t taskCount;
+    TaskHandle_t loopTask;
+    uint32_t pendingNotifications; // Bits received but not yet serviced
+
+    void runTask(ScheduledTask& task, int64_t now);
+    static uint8_t jitterBucket(uint32_t jitterUs);
+};
+
+#endif
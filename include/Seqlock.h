@@ -0,0 +1,57 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Single-writer sequence lock for a small value copied by many readers.
+// The writer bumps the sequence to odd, copies, and bumps it to even again;
+// a reader retries when it saw an odd sequence or the sequence moved while
+// it copied, so every read returns one whole published value. Readers never
+// block the writer and never take a lock.
+//
+// The copy runs inside a critical section so a reader on the writer's core
+// can never preempt a half-finished write and spin on it; a reader on the
+// other core waits at most one copy. T must be trivially copyable and small.
+template <typename T>
+class Seqlock {
+public:
+    Seqlock() : sequence(0), value() {
+        lock = portMUX_INITIALIZER_UNLOCKED;
+    }
+
+    // Producer side - one task only
+    void write(const T& newValue) {
+        portENTER_CRITICAL(&lock);
+        uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        value = newValue;
+        sequence.store(s + 2, std::memory_order_release);
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // Any task - returns the version copied (writes so far), 0 = never written
+    uint32_t read(T& out) const {
+        for (;;) {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue; // Write in progress on the other core
+            }
+            out = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                return before / 2;
+            }
+        }
+    }
+
+    uint32_t getVersion() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<uint32_t> sequence;
+    T value;
+    portMUX_TYPE lock;
+};
+
+#endif
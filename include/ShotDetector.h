@@ -0,0 +1,100 @@
+#ifndef SHOTDETECTOR_H
+#define SHOTDETECTOR_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <atomic>
+#include "SampleRing.h"
+
+class Display; // Forward declaration
+
+#define SHOT_DETECTOR_HISTORY 256        // Weight history for backdating - 3.2s at 80 SPS
+#define SHOT_DETECTOR_MAX_LISTENERS 3
+
+enum ShotEvent : uint8_t {
+    SHOT_EVENT_NONE = 0,
+    SHOT_EVENT_START,
+    SHOT_EVENT_STOP
+};
+
+// eventMs is the backdated sample timestamp (first drip / last flow), not the
+// time of detection. Called on the weight task.
+typedef void (*ShotEventCallback)(ShotEvent event, uint32_t eventMs, void* context);
+
+// Auto timer: watches every filtered sample and starts the Display timer at the
+// first sustained positive flow, backdated to the sample where the weight first
+// left its resting level. Stops it again on sustained zero flow. Only timers it
+// started itself are auto-stopped - a manually started timer is left alone.
+class ShotDetector {
+public:
+    ShotDetector();
+    void begin(); // Load persisted settings
+    void setDisplay(Display* display);
+    bool addListener(ShotEventCallback callback, void* context); // Call during setup only
+
+    // Weight task only, once per filtered sample
+    void update(const WeightSample& sample, float flowRate);
+
+    // Settings - persisted in the "shotdetect" namespace
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+    void setStartFlow(float gramsPerSecond);   // 0.1-5 g/s
+    float getStartFlow() const { return startFlow; }
+    void setStartHoldMs(uint32_t ms);          // 100-5000 ms
+    uint32_t getStartHoldMs() const { return startHoldMs; }
+    void setStopFlow(float gramsPerSecond);    // 0.05-2 g/s
+    float getStopFlow() const { return stopFlow; }
+    void setStopHoldMs(uint32_t ms);           // 500-10000 ms
+    uint32_t getStopHoldMs() const { return stopHoldMs; }
+
+    bool isAutoRunning() const { return autoRunning; }
+    ShotEvent getLastEvent() const { return lastEvent; }
+    uint32_t getLastEventMs() const { return lastEventMs; }
+    uint32_t getEventCount() const { return eventCount.load(); } // Bumped on every event - clients poll for changes
+    uint32_t getLastBackdateMs() const { return lastBackdateMs; } // Detection delay removed from the last start
+
+private:
+    static const int32_t DRIP_CG = 20;             // Rise above the resting weight that counts as the first drip
+    static const uint32_t REST_WINDOW_MS = 500;    // Resting level is the median of this much before the flow picked up
+    static const size_t REST_MAX_SAMPLES = 64;     // REST_WINDOW_MS at 80 SPS, with room
+    static constexpr float MAX_POUR_FLOW = 15.0f;  // g/s - faster than any espresso, so a cup or a hand
+
+    struct HistoryEntry {
+        uint32_t timestampMs;
+        int32_t weightCg;
+    };
+
+    Preferences preferences;
+    Display* display;
+    bool enabled;
+    float startFlow;
+    uint32_t startHoldMs;
+    float stopFlow;
+    uint32_t stopHoldMs;
+
+    HistoryEntry history[SHOT_DETECTOR_HISTORY];
+    size_t historyHead;    // Next write position
+    size_t historyCount;
+
+    uint32_t candidateSinceMs; // First sample of the current above-threshold run, 0 = none
+    uint32_t quietSinceMs;     // First sample of the current below-threshold run, 0 = none
+    bool autoRunning;
+
+    ShotEventCallback listeners[SHOT_DETECTOR_MAX_LISTENERS];
+    void* listenerContexts[SHOT_DETECTOR_MAX_LISTENERS];
+    size_t listenerCount;
+
+    volatile ShotEvent lastEvent;
+    volatile uint32_t lastEventMs;
+    volatile uint32_t lastBackdateMs;
+    std::atomic<uint32_t> eventCount;
+
+    const HistoryEntry& recent(size_t n) const; // n = 0 is the newest sample
+    static bool isJump(const HistoryEntry& newer, const HistoryEntry& older);
+    int32_t restLevelCg(uint32_t beforeMs) const;
+    uint32_t findRiseMs(int32_t levelCg, uint32_t fallbackMs) const;
+    void emit(ShotEvent event, uint32_t eventMs);
+    void saveSettings();
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef SHOTRECORDER_H
+#define SHOTRECORDER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#define SHOT_HISTORY_SLOTS 8          // Shots kept in the ring (PSRAM)
+#define SHOT_MAX_SAMPLES 9600         // Per shot - 120s at 80 SPS, 57.6KB
+#define SHOT_FALLBACK_SLOTS 2         // Without PSRAM, keep a small heap buffer instead
+#define SHOT_FALLBACK_SAMPLES 1200    // 120s at 10 SPS, 7.2KB per shot
+#define SHOT_BLE_PAGE_RECORDS 80      // Records per BLE page - 480 bytes plus header fits one attribute
+#define SHOT_PREROLL_SAMPLES 256      // Samples kept while idle for backdated starts - 3.2s at 80 SPS
+
+// One filtered sample, delta-encoded against the previous one (6 bytes).
+// Deltas saturate; the encoder tracks the reconstructed value so the next
+// record corrects any clipping instead of drifting.
+struct __attribute__((packed)) ShotRecord {
+    uint16_t dtMs;      // Milliseconds since the previous record (first: since shot start)
+    int16_t dWeightCg;  // Weight change since the previous record, centigrams
+    int16_t flowCgps;   // Flow rate at this sample, 0.01 g/s
+};
+
+struct ShotInfo {
+    uint32_t id;             // Monotonic shot number, 0 = slot unused
+    uint32_t startMs;        // millis() when the timer started
+    int32_t startWeightCg;   // Weight of the first record (delta base)
+    int32_t finalWeightCg;
+    uint32_t durationMs;     // Start to last record, including any timer pause
+    uint32_t samples;
+    bool complete;           // Timer stopped - the shot will not grow any more
+    bool truncated;          // Ran out of slot capacity before the timer stopped
+};
+
+// Records every filtered sample between Display::startTimer() and stopTimer()
+// into a preallocated ring of shot slots. Control calls may come from any task
+// (touch, BLE, HTTP); they are applied by update() on the weight task, which is
+// also the only writer, so the hot path is lock- and allocation-free. Readers
+// copy records out and re-check the slot's shot id to detect overwrites.
+class ShotRecorder {
+public:
+    ShotRecorder();
+    bool begin(); // Allocates the shot buffer - call once from setup()
+
+    // Timer hooks - safe from any task
+    void startShot(uint32_t startMs = 0); // Fresh timer start: begin a new shot (backdated when startMs is given)
+    void resumeShot();  // Timer resumed after a pause: continue the latest shot
+    void stopShot();    // Timer stopped/paused: finish the shot
+
+    // Weight task only
+    void update(); // Applies pending start/resume/stop requests
+    void addSample(uint32_t timestampMs, int32_t weightCg, float flowRate);
+
+    bool isRecording() const { return recording; }
+    size_t getSlotCount() const { return slotCount; }
+    size_t getSlotCapacity() const { return slotCapacity; }
+    bool isInPsram() const { return inPsram; }
+
+    // Reader side - return false if the shot does not exist (or was overwritten meanwhile)
+    bool getLatestShot(ShotInfo& info) const;        // Most recent complete shot
+    bool getShotBySlot(size_t slot, ShotInfo& info) const;
+    bool getShot(uint32_t shotId, ShotInfo& info) const;
+    bool readRecords(uint32_t shotId, uint32_t first, ShotRecord* out, size_t count) const;
+
+    // Absolute time (ms since shot start) and weight at record index, for decoding from mid-shot
+    bool decodeBase(uint32_t shotId, uint32_t index, uint32_t& timeMs, int32_t& weightCg) const;
+
+private:
+    enum Command : uint8_t { CMD_NONE = 0, CMD_START, CMD_RESUME, CMD_STOP };
+    
+    struct PrerollSample {
+        uint32_t timestampMs;
+        int32_t weightCg;
+        float flowRate;
+    };
+
+    ShotRecord* records;       // slotCount * slotCapacity, PSRAM when available
+    size_t slotCount;
+    size_t slotCapacity;
+    bool inPsram;
+
+    ShotInfo slots[SHOT_HISTORY_SLOTS];
+    std::atomic<uint32_t> slotIds[SHOT_HISTORY_SLOTS]; // Published id per slot - bumped before reuse
+    std::atomic<uint32_t> slotSamples[SHOT_HISTORY_SLOTS];
+    std::atomic<uint8_t> pendingCommand;
+    std::atomic<uint32_t> pendingStartMs; // 0 = now
+    PrerollSample* preroll;    // Recent samples while idle, replayed into a backdated shot
+    size_t prerollHead;
+    size_t prerollCount;
+    uint32_t nextShotId;
+    int activeSlot;            // Slot being written, -1 when idle
+    bool recording;
+    uint32_t encodedMs;        // Reconstructed time/weight of the last record
+    int32_t encodedWeightCg;
+
+    void beginShot(uint32_t now);
+    void finishShot();
+    void appendRecord(uint32_t timestampMs, int32_t weightCg, float flowRate);
+    int findSlot(uint32_t shotId) const;
+};
+
+#endif
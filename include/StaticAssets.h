@@ -0,0 +1,56 @@
+#ifndef STATICASSETS_H
+#define STATICASSETS_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <ESPAsyncWebServer.h>
+
+class JsonWriter;
+
+// Serves the web UI from the LittleFS image staged by tools/compress_assets.py.
+// Text assets are stored gzipped and sent with Content-Encoding: gzip as is;
+// every asset gets its content-hash ETag from /assets.manifest, so a
+// revalidation with a matching If-None-Match is answered 304 with no body.
+// Pages reference their css/js/fonts as /path?v=<etag>; those URLs change
+// with the content and are cached as immutable, everything else revalidates.
+//
+// begin() returns false for an image built without the manifest, and the
+// web server falls back to serveStatic().
+class StaticAssets : public AsyncWebHandler {
+public:
+    explicit StaticAssets(fs::FS& fs);
+
+    bool begin();                                              // Loads the manifest - setup()
+    bool send(AsyncWebServerRequest* request, const char* path); // false = not in the manifest
+    void writeStatsJson(JsonWriter& json) const;
+
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+
+private:
+    static const size_t MAX_ASSETS = 32;
+    static const size_t PATH_SIZE = 40;
+    static const size_t ETAG_SIZE = 16;
+
+    struct Asset {
+        char path[PATH_SIZE];
+        char etag[ETAG_SIZE];
+        bool gzip;             // Stored as path.gz
+        uint32_t size;         // Bytes on flash, as sent
+    };
+
+    fs::FS& fs;
+    Asset assets[MAX_ASSETS];
+    size_t assetCount;
+
+    // async_tcp task only
+    uint32_t served;
+    uint32_t notModified;
+    uint32_t bytesSent;
+
+    const Asset* find(const String& url) const;
+    void sendAsset(AsyncWebServerRequest* request, const Asset& asset);
+    static const char* contentType(const char* path);
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef STOPTRIGGER_H
+#define STOPTRIGGER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <atomic>
+#include "SampleRing.h"
+
+#define STOP_TRIGGER_MAX_LISTENERS 3
+
+// Called on the weight task the moment the predicted final weight reaches the
+// target. weightCg is the measured weight at that sample.
+typedef void (*StopCallback)(int32_t weightCg, int32_t targetCg, void* context);
+
+// On-device target-weight stop. Evaluated for every filtered sample in the
+// weight task, so the decision is not delayed by the BLE notify interval or
+// the client. Fires when
+//   weight + flow * (pipeline lag + learned drip time) >= target
+// The drip time is the effective number of seconds of flow that still lands
+// in the cup after the stop signal (client + machine reaction + drip). It is
+// learned after every shot from the settled weight and persisted.
+//
+// It only fires during a shot - while the timer runs or once flow has held
+// for ACTIVE_FLOW_MS - and never on a jump (Scale::JUMP_THRESHOLD_G between
+// samples): a cup put on the scale without a tare is a jump, and the weight
+// must drop below a quarter of the target again before the trigger re-primes.
+class StopTrigger {
+public:
+    enum State {
+        STOP_IDLE = 0,     // No target set
+        STOP_ARMED,        // Watching for the target
+        STOP_SETTLING,     // Fired - waiting for the cup to settle to learn the drip
+        STOP_DONE          // Settled - re-arms once the weight drops (cup removed or tared)
+    };
+
+    StopTrigger();
+    void begin(); // Load learned drip time
+
+    // Any task - applied by update() on the weight task. 0 clears the target.
+    void setTarget(int32_t targetCg);
+    void clearTarget() { setTarget(0); }
+    bool addListener(StopCallback callback, void* context); // Call during setup only
+
+    // Weight task only, once per filtered sample
+    void update(const WeightSample& sample, float flowRate, bool timerRunning);
+
+    State getState() const { return state.load(); }
+    const char* getStateName() const;
+    int32_t getTargetCg() const { return targetCg; }
+    float getDripSeconds() const { return dripMs / 1000.0f; }
+    int32_t getLastFireWeightCg() const { return lastFireWeightCg; }
+    int32_t getLastFinalWeightCg() const { return lastFinalWeightCg; }   // Settled weight of the last shot
+    int32_t getLastOvershootCg() const { return lastFinalWeightCg - lastTargetCg; }
+    uint32_t getFireCount() const { return fireCount; }
+
+    void resetLearning(); // Back to the default drip time
+
+private:
+    static const int32_t NO_REQUEST = INT32_MIN;
+    static const uint32_t DEFAULT_DRIP_MS = 1000;
+    static const uint32_t MAX_DRIP_MS = 4000;
+    static constexpr float DRIP_LEARN_RATE = 0.3f;       // EMA weight of the newest shot
+    static constexpr float MIN_LEARN_FLOW = 0.3f;        // g/s - slower pours carry no drip information
+    static constexpr float SETTLED_FLOW = 0.05f;         // g/s
+    static const uint32_t SETTLED_HOLD_MS = 1500;        // Flow below SETTLED_FLOW for this long
+    static const uint32_t SETTLE_TIMEOUT_MS = 10000;
+    static const int32_t CUP_REMOVED_CG = 500;           // Drop after firing - abandon learning
+    static constexpr float ACTIVE_FLOW = 0.3f;           // g/s - a pour, not noise
+    static const uint32_t ACTIVE_FLOW_MS = 500;          // Held this long without the timer counts as a shot
+    static const uint32_t JUMP_SETTLE_MS = 1500;         // Samples this soon after a jump are ignored
+
+    Preferences preferences;
+    std::atomic<int32_t> requestedTarget;
+    std::atomic<State> state;
+    int32_t targetCg;
+    uint32_t dripMs;
+
+    StopCallback listeners[STOP_TRIGGER_MAX_LISTENERS];
+    void* listenerContexts[STOP_TRIGGER_MAX_LISTENERS];
+    size_t listenerCount;
+
+    // Current shot
+    bool primed;               // Weight has been well below the target since arming
+    bool flowActive;           // Flow held above ACTIVE_FLOW since priming
+    uint32_t flowSinceMs;
+    int32_t jumpCg;            // Scale::JUMP_THRESHOLD_G
+    int32_t lastWeightCg;
+    bool hasLastWeight;
+    bool jumpSettling;         // Within JUMP_SETTLE_MS of the last jump
+    uint32_t jumpMs;
+    uint32_t fireMs;
+    int32_t fireWeightCg;
+    float fireFlow;
+    int32_t peakWeightCg;
+    uint32_t settledSinceMs;
+
+    // Last shot, for the API
+    int32_t lastTargetCg;
+    int32_t lastFireWeightCg;
+    int32_t lastFinalWeightCg;
+    uint32_t fireCount;
+
+    void rearm(bool isPrimed);
+    void fire(const WeightSample& sample, float flowRate);
+    void learn(int32_t finalWeightCg);
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef TELEMETRYPUBLISHER_H
+#define TELEMETRYPUBLISHER_H
+
+#include <Arduino.h>
+#include "Seqlock.h"
+
+class Scale;
+class FlowRate;
+class Display;
+class BatteryMonitor;
+class ShotDetector;
+class BluetoothScale;
+
+// Everything the dashboard, the SSE stream, the OLED and BLE show, taken at
+// one instant on the weight task. Strings point at static text.
+struct TelemetrySnapshot {
+    uint32_t sequence;        // Publish count - 0 = nothing published yet
+    uint32_t publishedMs;     // millis() when the weight task built this copy
+    uint32_t sampleMs;        // Timestamp of the newest weight sample, 0 = none yet
+    uint32_t sampleSequence;  // WeightSample::sequence of that sample
+
+    int32_t weightCg;
+    float flowRate;           // g/s, 0 while the filter does not estimate it
+    bool scaleConnected;
+    uint8_t filterStateCode;  // Scale::getFilterStateCode()
+    const char* filterState;
+
+    bool timerRunning;        // Running and not paused
+    bool timerAuto;           // Started by the shot detector
+    uint32_t timerElapsedMs;
+    bool hasTimerAverage;
+    float timerAverageFlowRate;
+    uint32_t shotEventSeq;
+
+    // Slow-moving status, refreshed every STATUS_INTERVAL_MS
+    float batteryVoltage;
+    int batteryPercentage;
+    int batterySegments;
+    bool batteryLow;
+    bool batteryCritical;
+    bool batteryCharging;
+    const char* batteryStatus;
+    int wifiSignal;
+    const char* wifiSignalQuality;
+    bool bluetoothConnected;
+    int bluetoothSignal;
+    uint8_t bluetoothConnections;
+};
+
+// Builds one TelemetrySnapshot per weight task cycle and publishes it through
+// a seqlock, so readers on any task (async_tcp, NimBLE, the loop) copy a
+// consistent, versioned set of values in constant time instead of calling
+// a dozen getters that race with the weight task.
+class TelemetryPublisher {
+public:
+    TelemetryPublisher(Scale* scale, FlowRate* flowRate, Display* display, BatteryMonitor* battery,
+                       ShotDetector* shotDetector, BluetoothScale* bluetoothScale);
+
+    // Weight task, after the cycle's samples are processed
+    const TelemetrySnapshot& publish();
+
+    // Any task
+    uint32_t read(TelemetrySnapshot& out) const { return snapshots.read(out); }
+    uint32_t getSequence() const { return snapshots.getVersion(); }
+
+private:
+    static const uint32_t STATUS_INTERVAL_MS = 1000; // Battery, WiFi and BLE status are re-read this often
+
+    Scale* scale;
+    FlowRate* flowRate;
+    Display* display;
+    BatteryMonitor* battery;
+    ShotDetector* shotDetector;
+    BluetoothScale* bluetoothScale;
+
+    Seqlock<TelemetrySnapshot> snapshots;
+    TelemetrySnapshot next;   // Weight task copy - status fields carry over between refreshes
+    uint32_t lastStatusMs;
+
+    void refreshStatus(uint32_t now);
+};
+
+#endif
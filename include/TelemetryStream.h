@@ -0,0 +1,78 @@
+#ifndef TELEMETRYSTREAM_H
+#define TELEMETRYSTREAM_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "JsonWriter.h"
+#include "PollWaker.h"
+#include "TelemetryPublisher.h"
+
+// Live dashboard values pushed as Server-Sent Events on /api/events, so the
+// page no longer polls /api/dashboard. The event source is not safe to use
+// outside async_tcp, so frames are encoded and sent there: each tab's
+// connection poll reads the published snapshot and sends at most one frame,
+// which the event source queues to every open tab. After publishing, the
+// weight task calls wake(), which has those polls run now instead of on
+// AsyncTCP's ~500 ms tick.
+//
+// Frames ("t" events) are JSON objects with the /api/dashboard field names,
+// holding only the fields that changed since the previous frame - a tab that
+// connects gets every field once. While a shot is on frames follow the sensor
+// rate; when idle changes are sent at most every IDLE_INTERVAL_MS and an empty
+// frame every HEARTBEAT_MS tells the page the stream is alive. Frames are
+// skipped (and their changes carried into the next one) while clients are
+// still draining earlier ones.
+class TelemetryStream {
+public:
+    explicit TelemetryStream(TelemetryPublisher& telemetry);
+
+    void attach(AsyncWebServer& server);               // Registers /api/events
+    void wake(const TelemetrySnapshot& snapshot);      // Weight task
+    void writeStatsJson(JsonWriter& json) const;       // async_tcp
+
+private:
+    static const uint32_t IDLE_INTERVAL_MS = 100;
+    static const uint32_t HEARTBEAT_MS = 5000;
+    static const uint32_t RECONNECT_MS = 2000;        // Browser retry delay after the stream drops
+    static const size_t MAX_WAITING_PACKETS = 8;      // Per client - beyond this frames are skipped
+    static const size_t FRAME_SIZE = 512;
+
+    TelemetryPublisher& telemetry;
+    AsyncEventSource events;
+    PollWaker waker;
+    uint32_t lastWakeMs;        // Weight task
+
+    // Everything below is async_tcp only
+    bool fullPending;           // A tab connected - next frame carries every field
+
+    // Values as last sent
+    int32_t weightCg;
+    int32_t flowDg;             // Flow in 0.1 g/s, the precision the page shows
+    bool scaleConnected;
+    bool timerRunning;
+    bool timerAuto;
+    uint32_t timerElapsedMs;
+    int32_t timerAvgCg;         // Average flow in 0.01 g/s, -1 = none
+    uint32_t shotEventSeq;
+    int batteryPercentage;
+    bool batteryLow;
+    bool batteryCritical;
+    int wifiSignal;
+    bool bluetoothConnected;
+    int bluetoothSignal;
+
+    uint32_t lastFrameMs;
+    uint32_t lastCheckMs;       // Last time values were compared
+    char frame[FRAME_SIZE];
+    FixedBufferPrint frameOut;
+
+    uint32_t framesSent;
+    uint32_t fullFrames;
+    uint32_t heartbeats;
+    uint32_t framesSkipped;
+    uint32_t bytesSent;         // Encoded once, whatever the number of tabs
+
+    void flush();               // async_tcp - sends the published snapshot's changes
+};
+
+#endif
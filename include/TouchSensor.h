@@ -39,6 +39,7 @@ private:
     void handleTouch();
     void scheduleDelayedTare();
     void checkDelayedTare();
+    static void onTareComplete(bool success, void* context); // Scale tare callback
     void handleLongPress();
     void handleStatusPageToggle(); // Handle status page toggle on medium press
     void handleWiFiToggle(); // Handle WiFi toggle on long press (5 seconds)
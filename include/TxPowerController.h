@@ -0,0 +1,57 @@
+#ifndef TXPOWERCONTROLLER_H
+#define TXPOWERCONTROLLER_H
+
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+
+class JsonWriter;
+
+// Per-connection transmit power driven by the link's RSSI. The RSSI read here
+// is the central's signal, so it tracks path loss and does not move with our
+// own power - the controller steps power down while the client is close and
+// back up as the link weakens, without chasing its own changes. Steps are
+// one level at a time with a hold between them; a collapsing link jumps
+// straight to full power.
+class TxPowerController {
+public:
+    TxPowerController();
+    void onConnect(uint16_t connHandle); // NimBLE host task - only records the handle
+    void onDisconnect();
+    void update(uint32_t now);           // BLE task - samples RSSI, steps power
+
+    bool hasRssi() const { return samples > 0; }
+    int8_t getRssi() const { return (int8_t)(rssiQ4 / 16); } // Smoothed dBm
+    int8_t getTxPowerDbm() const;
+    void writeJson(JsonWriter& json) const; // RSSI history (oldest first) and power decisions
+
+private:
+    static const uint32_t SAMPLE_INTERVAL_MS = 1000;
+    static const uint32_t STEP_HOLD_MS = 4000;     // Let the smoothed RSSI follow a step before the next
+    static const int16_t RSSI_STRONG_DBM = -55;    // Above: client close by, step down
+    static const int16_t RSSI_WEAK_DBM = -72;      // Below: margin shrinking, step up
+    static const int16_t RSSI_CRITICAL_DBM = -85;  // Below: go to full power at once
+    static const uint8_t HISTORY_SIZE = 16;
+
+    volatile uint16_t connHandle;
+    volatile bool connected;
+    volatile bool pendingStart;  // Connected, start level not applied yet
+    bool powerControl;           // Handle maps to a controller power slot
+
+    int16_t rssiQ4;              // Smoothed RSSI, dBm * 16
+    int8_t history[HISTORY_SIZE];
+    uint8_t historyHead;
+    uint8_t historyCount;
+
+    uint8_t level;               // Index into the power table
+    uint32_t lastSampleMs;
+    uint32_t lastStepMs;
+    uint32_t samples;
+    uint32_t sampleFailures;
+    uint32_t raises;
+    uint32_t lowers;
+    const char* lastDecision;
+
+    void setLevel(uint8_t newLevel, const char* reason, uint32_t now);
+};
+
+#endif
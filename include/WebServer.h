@@ -6,10 +6,19 @@
 #include "BluetoothScale.h"
 #include "Display.h"
 #include "BatteryMonitor.h"
+#include "Scheduler.h"
+#include "BootSequence.h"
+#include "ShotRecorder.h"
+#include "StopTrigger.h"
+#include "ShotDetector.h"
+#include "CommandQueue.h"
+#include "TelemetryPublisher.h"
+#include "TelemetryStream.h"
+#include "BrewPoll.h"
 
 extern float calibrationFactor;
 
-void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothScale, Display &display, BatteryMonitor &battery);
+void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothScale, Display &display, BatteryMonitor &battery, Scheduler &scheduler, BootSequence &bootSequence, ShotRecorder &shotRecorder, StopTrigger &stopTrigger, ShotDetector &shotDetector, CommandQueue &commandQueue, TelemetryPublisher &telemetry, TelemetryStream &telemetryStream, BrewPoll &brewPoll);
 void startWebServer();
 void stopWebServer();
 
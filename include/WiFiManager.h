@@ -5,6 +5,8 @@
 #include <Preferences.h>
 #include <ESPmDNS.h>
 
+class JsonWriter;
+
 // Configuration for SuperMini antenna fix
 // Set to true to enable maximum power mode for boards with poor antenna design
 #define ENABLE_SUPERMINI_ANTENNA_FIX true
@@ -23,8 +25,8 @@ bool attemptSTAConnection(const char* ssid, const char* password); // Attempt ST
 void switchToAPMode(); // Switch back to AP mode if STA connection fails
 void applySuperMiniAntennaFix(); // Apply maximum power settings for problematic SuperMini boards
 int getWiFiSignalStrength(); // Get current WiFi signal strength in dBm
-String getWiFiSignalQuality(); // Get WiFi signal quality description
-String getWiFiConnectionInfo(); // Get detailed WiFi connection information
+const char* getWiFiSignalQuality(); // Get WiFi signal quality description
+void writeWiFiConnectionInfo(JsonWriter& json); // Get detailed WiFi connection information
 
 // WiFi Power Management
 bool isWiFiEnabled(); // Check if WiFi is currently enabled
@@ -0,0 +1,237 @@
+#ifndef WINDOWFILTER_H
+#define WINDOWFILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+#include <math.h>
+
+// Sliding-window filters with per-sample cost independent of window size.
+// The mean and median windows are always full: reset() pre-fills them with a
+// seed value, matching how Scale primes its sample buffer on the first reading.
+
+// Running-sum mean. Sum is the accumulator type (use a wider integer type
+// for integer samples, which are then exact). For floating point the sum is
+// rebuilt from the window once per wrap so rounding error cannot accumulate
+// (amortised O(1)).
+template <typename T, typename Sum, size_t N>
+class SlidingMean {
+public:
+    SlidingMean() : size(1), index(0), sum(0) { window[0] = 0; }
+
+    void reset(size_t windowSize, T fill) {
+        size = (windowSize < 1) ? 1 : (windowSize > N ? N : windowSize);
+        for (size_t i = 0; i < size; i++) {
+            window[i] = fill;
+        }
+        index = 0;
+        sum = (Sum)fill * (Sum)size;
+    }
+
+    T push(T value) {
+        sum += (Sum)value - (Sum)window[index];
+        window[index] = value;
+        if (++index == size) {
+            index = 0;
+            if (std::is_floating_point<Sum>::value) {
+                Sum exact = 0;
+                for (size_t i = 0; i < size; i++) {
+                    exact += (Sum)window[i];
+                }
+                sum = exact;
+            }
+        }
+        return mean();
+    }
+
+    T mean() const { return (T)(sum / (Sum)size); }
+    size_t windowSize() const { return size; }
+
+private:
+    T window[N];
+    size_t size;
+    size_t index;
+    Sum sum;
+};
+
+// Sliding median over an indexable sorted copy of the window. Each push
+// removes the oldest value and inserts the new one with two binary searches
+// and a single memmove of the span between them - no per-sample sort.
+template <typename T, size_t N>
+class SlidingMedian {
+public:
+    SlidingMedian() : size(1), index(0) { window[0] = sorted[0] = 0; }
+
+    void reset(size_t windowSize, T fill) {
+        size = (windowSize < 1) ? 1 : (windowSize > N ? N : windowSize);
+        for (size_t i = 0; i < size; i++) {
+            window[i] = fill;
+            sorted[i] = fill;
+        }
+        index = 0;
+    }
+
+    T push(T value) {
+        T oldest = window[index];
+        window[index] = value;
+        index = (index + 1 == size) ? 0 : index + 1;
+
+        size_t removeAt = lowerBound(oldest);
+        size_t insertAt = lowerBound(value);
+        if (insertAt > removeAt) {
+            // Slot freed below the insertion point - shift the span down by one
+            insertAt--;
+            memmove(&sorted[removeAt], &sorted[removeAt + 1], (insertAt - removeAt) * sizeof(T));
+        } else if (insertAt < removeAt) {
+            memmove(&sorted[insertAt + 1], &sorted[insertAt], (removeAt - insertAt) * sizeof(T));
+        }
+        sorted[insertAt] = value;
+        return median();
+    }
+
+    T median() const { return sorted[size / 2]; } // Upper median for even windows
+    size_t windowSize() const { return size; }
+
+private:
+    T window[N];  // Arrival order - tells us which value leaves next
+    T sorted[N];  // Same values kept in ascending order
+    size_t size;
+    size_t index;
+
+    size_t lowerBound(T value) const {
+        size_t lo = 0, hi = size;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (sorted[mid] < value) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+};
+
+// Least-squares line through the timestamped samples of the last windowMs
+// milliseconds - a first-order Savitzky-Golay differentiator that does not
+// need uniform sample spacing. Time (ms, relative to a moving base) and value
+// (integer units, e.g. centigrams) feed exact int64 running sums, so adding
+// and evicting a sample is O(1) and nothing drifts; float is only used when
+// the slope and residual are read out. N bounds the samples in one window.
+template <size_t N>
+class SlidingSlope {
+public:
+    SlidingSlope() : windowMs(1000) { reset(); }
+
+    void reset() {
+        head = 0;
+        count = 0;
+        baseMs = 0;
+        St = Sy = Stt = Sty = Syy = 0;
+    }
+
+    void setWindowMs(uint32_t ms) { windowMs = ms; }
+    uint32_t getWindowMs() const { return windowMs; }
+
+    void push(uint32_t timestampMs, int32_t value) {
+        if (count == 0) {
+            baseMs = timestampMs;
+        }
+
+        // Drop samples older than the window, and the oldest one if full
+        while (count > 0 && (count == N || timestampMs - times[oldest()] > windowMs)) {
+            remove(times[oldest()], values[oldest()]);
+            count--;
+        }
+        if (count > 0 && timestampMs - baseMs > REBASE_MS) {
+            rebase(times[oldest()]);
+        } else if (count == 0) {
+            baseMs = timestampMs;
+        }
+
+        times[head] = timestampMs;
+        values[head] = value;
+        head = (head + 1) % N;
+        count++;
+
+        int64_t t = (int64_t)(timestampMs - baseMs);
+        St += t;
+        Sy += value;
+        Stt += t * t;
+        Sty += t * value;
+        Syy += (int64_t)value * value;
+    }
+
+    size_t size() const { return count; }
+    uint32_t spanMs() const { return count > 0 ? times[newest()] - times[oldest()] : 0; }
+    bool valid() const { return count >= 3 && timeSpread() > 0; }
+
+    // Fitted slope in value units per millisecond
+    float slope() const {
+        int64_t dtt = timeSpread();
+        if (count < 2 || dtt <= 0) {
+            return 0.0f;
+        }
+        return (float)((int64_t)count * Sty - St * Sy) / (float)dtt;
+    }
+
+    // RMS distance of the samples from the fitted line, in value units
+    float residualRms() const {
+        int64_t dtt = timeSpread();
+        if (count < 3 || dtt <= 0) {
+            return 0.0f;
+        }
+        // Centred sums are exact in int64; only the final combination is float
+        float dty = (float)((int64_t)count * Sty - St * Sy);
+        float dyy = (float)((int64_t)count * Syy - Sy * Sy);
+        float sse = (dyy - dty * dty / (float)dtt) / (float)count;
+        if (sse < 0.0f) sse = 0.0f;
+        return sqrtf(sse / (float)(count - 2));
+    }
+
+    // Standard error of slope(), value units per millisecond
+    float slopeStdError() const {
+        int64_t dtt = timeSpread();
+        if (count < 3 || dtt <= 0) {
+            return 0.0f;
+        }
+        return residualRms() / sqrtf((float)dtt / (float)count);
+    }
+
+private:
+    static const uint32_t REBASE_MS = 60000; // Keeps t^2 sums small on long uptimes
+
+    uint32_t times[N];
+    int32_t values[N];
+    size_t head;
+    size_t count;
+    uint32_t windowMs;
+    uint32_t baseMs;
+    int64_t St, Sy, Stt, Sty, Syy;
+
+    size_t oldest() const { return (head + N - count) % N; }
+    size_t newest() const { return (head + N - 1) % N; }
+    int64_t timeSpread() const { return (int64_t)count * Stt - St * St; }
+
+    void remove(uint32_t timestampMs, int32_t value) {
+        int64_t t = (int64_t)(timestampMs - baseMs);
+        St -= t;
+        Sy -= value;
+        Stt -= t * t;
+        Sty -= t * value;
+        Syy -= (int64_t)value * value;
+    }
+
+    // Move the time origin forward by d ms: t' = t - d, adjusted exactly in O(1)
+    void rebase(uint32_t newBaseMs) {
+        int64_t d = (int64_t)(newBaseMs - baseMs);
+        int64_t n = (int64_t)count;
+        Stt += n * d * d - 2 * d * St;
+        Sty -= d * Sy;
+        St -= n * d;
+        baseMs = newBaseMs;
+    }
+};
+
+#endif
@@ -0,0 +1,52 @@
+#include "AdvertisingPolicy.h"
+#include "JsonWriter.h"
+
+AdvertisingPolicy::AdvertisingPolicy()
+    : mode(ADV_FAST), started(false), fastUntilMs(0), seenDisconnects(0), switches(0) {
+}
+
+bool AdvertisingPolicy::update(uint32_t now, uint32_t disconnects, bool broadcast) {
+    if (!started || disconnects != seenDisconnects) {
+        fastUntilMs = now + FAST_WINDOW_MS;
+        seenDisconnects = disconnects;
+    }
+
+    Mode wanted = broadcast ? ADV_BROADCAST : (int32_t)(now - fastUntilMs) < 0 ? ADV_FAST : ADV_SLOW;
+    if (started && wanted == mode) {
+        return false;
+    }
+    if (started) {
+        switches++;
+    }
+    started = true;
+    mode = wanted;
+    return true;
+}
+
+const char* AdvertisingPolicy::getModeName() const {
+    switch (mode) {
+        case ADV_FAST: return "fast";
+        case ADV_SLOW: return "slow";
+        case ADV_BROADCAST: return "broadcast";
+        default: return "unknown";
+    }
+}
+
+uint16_t AdvertisingPolicy::getMinInterval() const {
+    return mode == ADV_SLOW ? SLOW_MIN : FAST_MIN;
+}
+
+uint16_t AdvertisingPolicy::getMaxInterval() const {
+    return mode == ADV_SLOW ? SLOW_MAX : FAST_MAX;
+}
+
+void AdvertisingPolicy::writeJson(JsonWriter& json, uint32_t now) const {
+    int32_t fastRemaining = (int32_t)(fastUntilMs - now);
+    json.beginObject();
+    json.field("mode", getModeName());
+    json.field("min_interval_ms", getMinInterval() * 0.625f, 1);
+    json.field("max_interval_ms", getMaxInterval() * 0.625f, 1);
+    json.field("fast_remaining_ms", mode == ADV_FAST && fastRemaining > 0 ? fastRemaining : 0);
+    json.field("switches", switches);
+    json.endObject();
+}
@@ -100,7 +100,7 @@ int BatteryMonitor::getBatteryPercentage() {
     return constrain(percentage, 0, 100);
 }
 
-String BatteryMonitor::getBatteryStatus() {
+const char* BatteryMonitor::getBatteryStatus() {
     float voltage = getBatteryVoltage();
     
     if (voltage >= BATTERY_FULL) {
@@ -0,0 +1,96 @@
+#include "BleLifecycle.h"
+#include "JsonWriter.h"
+
+BleLifecycle::BleLifecycle()
+    : state(LINK_WAITING), restartAtMs(0), backoffMs(SETTLE_MS), connects(0), disconnects(0), shortDisconnects(0),
+      seenDisconnects(0), seenShortDisconnects(0), advertisingRestarts(0), advertisingFailures(0) {
+}
+
+void BleLifecycle::onConnect() {
+    connects.fetch_add(1);
+}
+
+void BleLifecycle::onDisconnect(uint32_t connectedForMs) {
+    if (connectedForMs < FLAP_WINDOW_MS) {
+        shortDisconnects.fetch_add(1);
+    }
+    disconnects.fetch_add(1); // Last - update() reads the short count after seeing this
+}
+
+BleLifecycle::Action BleLifecycle::update(uint32_t now, uint8_t connections, bool slotFree, bool advertising) {
+    uint32_t disconnectCount = disconnects.load();
+    uint32_t shortCount = shortDisconnects.load();
+
+    if (disconnectCount != seenDisconnects) {
+        uint32_t newShort = shortCount - seenShortDisconnects;
+        uint32_t newTotal = disconnectCount - seenDisconnects;
+        seenDisconnects = disconnectCount;
+        seenShortDisconnects = shortCount;
+
+        // A link that held resets the backoff; each one that dropped straight away doubles it
+        if (newShort < newTotal) {
+            backoffMs = SETTLE_MS;
+        }
+        for (uint32_t i = 0; i < newShort && backoffMs < MAX_BACKOFF_MS; i++) {
+            backoffMs = min(backoffMs * 2, (uint32_t)MAX_BACKOFF_MS);
+        }
+        if (newShort > 0) {
+            waitFor(now, backoffMs);
+            if (advertising) {
+                return ACTION_STOP_ADVERTISING;
+            }
+        } else if (!advertising) {
+            waitFor(now, SETTLE_MS);
+        }
+    }
+
+    if (advertising) {
+        state = LINK_ADVERTISING;
+        return ACTION_NONE;
+    }
+    if (!slotFree) {
+        state = LINK_FULL;
+        return ACTION_NONE;
+    }
+    if (state != LINK_WAITING) {
+        // A connect stopped advertising (or the stack did) and a slot is still free
+        waitFor(now, connections > 0 ? READVERTISE_MS : SETTLE_MS);
+    }
+    return (int32_t)(now - restartAtMs) >= 0 ? ACTION_START_ADVERTISING : ACTION_NONE;
+}
+
+void BleLifecycle::advertisingStarted(bool ok, uint32_t now) {
+    if (ok) {
+        state = LINK_ADVERTISING;
+        advertisingRestarts++;
+        return;
+    }
+    advertisingFailures++;
+    backoffMs = min(backoffMs * 2, (uint32_t)MAX_BACKOFF_MS);
+    waitFor(now, backoffMs);
+}
+
+void BleLifecycle::waitFor(uint32_t now, uint32_t delayMs) {
+    state = LINK_WAITING;
+    restartAtMs = now + delayMs;
+}
+
+const char* BleLifecycle::getStateName() const {
+    switch (state) {
+        case LINK_ADVERTISING: return "advertising";
+        case LINK_FULL: return "full";
+        default: return "waiting";
+    }
+}
+
+void BleLifecycle::writeJson(JsonWriter& json) const {
+    json.beginObject();
+    json.field("state", getStateName());
+    json.field("backoff_ms", backoffMs);
+    json.field("connects", getConnects());
+    json.field("disconnects", getDisconnects());
+    json.field("short_disconnects", shortDisconnects.load());
+    json.field("advertising_restarts", advertisingRestarts);
+    json.field("advertising_failures", advertisingFailures);
+    json.endObject();
+}
@@ -1,5 +1,6 @@
 #include "BluetoothScale.h"
 #include "Display.h"
+#include "JsonWriter.h"
 #include <Arduino.h>
 #include <stdexcept>
 #include <esp_bt.h>
@@ -9,13 +10,18 @@ const char* BluetoothScale::SERVICE_UUID = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E
 const char* BluetoothScale::WEIGHT_CHARACTERISTIC_UUID = "6E400004-B5A3-F393-E0A9-E50E24DCCA9E";  // Bean Conqueror (new UUID)
 const char* BluetoothScale::GAGGIMATE_CHARACTERISTIC_UUID = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E";  // GaggiMate (original UUID)
 const char* BluetoothScale::COMMAND_CHARACTERISTIC_UUID = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E";
+const char* BluetoothScale::SHOT_CHARACTERISTIC_UUID = "6E400005-B5A3-F393-E0A9-E50E24DCCA9E";  // Shot history pages
+const char* BluetoothScale::BATCH_CHARACTERISTIC_UUID = "6E400006-B5A3-F393-E0A9-E50E24DCCA9E";  // Batched samples
 
 BluetoothScale::BluetoothScale() 
-    : scale(nullptr), display(nullptr), server(nullptr), service(nullptr), 
+    : scale(nullptr), display(nullptr), shotRecorder(nullptr), stopTrigger(nullptr), commandQueue(nullptr), server(nullptr), service(nullptr), 
       weightCharacteristic(nullptr), gaggiMateWeightCharacteristic(nullptr), 
-      commandCharacteristic(nullptr), advertising(nullptr), deviceConnected(false), 
+      commandCharacteristic(nullptr), shotCharacteristic(nullptr), batchCharacteristic(nullptr), advertising(nullptr), deviceConnected(false), 
       oldDeviceConnected(false), lastHeartbeat(0), lastWeightSent(0), lastWeight(0.0f),
-      connectionRSSI(-100), connectionHandle(0) {
+      lastSamplePublished(0), gaggiMateStats{0, 0, 0}, beanConquerorStats{0, 0, 0}, commandStats{0, 0, 0},
+      batchStats{0, 0, 0}, batchStartedMs(0), batchSamplesSent(0), commandValueLength(0), connectionRSSI(-100),
+      broadcastEnabled(false), broadcastIntervalMs(100), broadcastLayoutPending(false), broadcastLayoutActive(false),
+      lastBroadcastMs(0), broadcastUpdates(0), broadcastFrame{0, 0, 0, 0, 0}, telemetry(nullptr), latest() {
 }
 
 BluetoothScale::~BluetoothScale() {
@@ -55,9 +61,14 @@ void BluetoothScale::begin(Scale* scaleInstance) {
         // This avoids the problematic Bluetooth controller initialization
         initializeBLE();
         
-        // Small delay before starting advertising
-        delay(200);
+        // Broadcast mode is opt-in; update() switches the advertising layout if it was left on
+        preferences.begin("ble", true);
+        broadcastEnabled = preferences.getBool("broadcast", false);
+        broadcastIntervalMs = constrain(preferences.getUShort("bcast_ms", 100), 50, 1000);
+        preferences.end();
+        broadcastLayoutPending = broadcastEnabled;
         
+        // NimBLEDevice::init() returns once the host is synced - advertising can start right away
         startAdvertising();
         
         Serial.println("BluetoothScale: Successfully started advertising as WeighMyBru");
@@ -107,9 +118,6 @@ void BluetoothScale::initializeBLE() {
     // Set moderate power to reduce current draw during boot while maintaining connectivity
     NimBLEDevice::setPower(ESP_PWR_LVL_N0);  // Moderate BLE power reduction (0dBm)
     
-    // Small delay to let power settle
-    delay(100);
-    
     Serial.printf("BluetoothScale: Free heap after NimBLEDevice::init: %u bytes\n", ESP.getFreeHeap());
     
     Serial.println("BluetoothScale: Creating BLE server...");
@@ -120,6 +128,7 @@ void BluetoothScale::initializeBLE() {
         throw std::runtime_error("Failed to create BLE server");
     }
     server->setCallbacks(this);
+    server->advertiseOnDisconnect(false); // BleLifecycle decides when to re-advertise
     
     Serial.println("BluetoothScale: Creating BLE service...");
     
@@ -144,6 +153,7 @@ void BluetoothScale::initializeBLE() {
         throw std::runtime_error("Failed to create GaggiMate weight characteristic");
     }
     
+    gaggiMateWeightCharacteristic->setCallbacks(this); // onStatus() counts delivery results
     Serial.println("BluetoothScale: GaggiMate characteristic created successfully");
     
     // Note: NimBLE automatically creates 0x2902 descriptors for characteristics with NOTIFY/INDICATE properties
@@ -161,6 +171,7 @@ void BluetoothScale::initializeBLE() {
         throw std::runtime_error("Failed to create Bean Conqueror weight characteristic");
     }
     
+    weightCharacteristic->setCallbacks(this);
     Serial.println("BluetoothScale: Bean Conqueror characteristic created successfully");
     
     // Note: NimBLE automatically creates 0x2902 descriptors for characteristics with NOTIFY/INDICATE properties
@@ -178,6 +189,27 @@ void BluetoothScale::initializeBLE() {
     }
     commandCharacteristic->setCallbacks(this);
     
+    // Shot history characteristic - filled on demand by the SHOT_PAGE command, then read
+    shotCharacteristic = service->createCharacteristic(
+        SHOT_CHARACTERISTIC_UUID,
+        NIMBLE_PROPERTY::READ
+    );
+    
+    if (!shotCharacteristic) {
+        throw std::runtime_error("Failed to create shot characteristic");
+    }
+    
+    // Batched sample characteristic - every sample, varint-packed (see SampleBatchCodec.h)
+    batchCharacteristic = service->createCharacteristic(
+        BATCH_CHARACTERISTIC_UUID,
+        NIMBLE_PROPERTY::NOTIFY
+    );
+    
+    if (!batchCharacteristic) {
+        throw std::runtime_error("Failed to create batch characteristic");
+    }
+    batchCharacteristic->setCallbacks(this);
+    
     Serial.println("BluetoothScale: Starting service...");
     
     // Start the service
@@ -204,10 +236,8 @@ void BluetoothScale::initializeBLE() {
     Serial.println("BluetoothScale: BLE initialization completed successfully");
 }
 
-void BluetoothScale::startAdvertising() {
-    if (advertising) {
-        advertising->start();
-    }
+bool BluetoothScale::startAdvertising() {
+    return advertising != nullptr && advertising->start();
 }
 
 void BluetoothScale::stopAdvertising() {
@@ -218,17 +248,67 @@ void BluetoothScale::stopAdvertising() {
 
 void BluetoothScale::update() {
     // Return early if initialization failed
-    if (scale == nullptr) {
+    if (server == nullptr) {
         return;
     }
     
     uint32_t now = millis();
     
+    // Advertising follows the connection state on timers - a connect or disconnect never stalls the loop
+    bool advertisingNow = advertising != nullptr && advertising->isAdvertising();
+    BleLifecycle::Action action = lifecycle.update(now, connections.getCount(), connections.hasFreeSlot(), advertisingNow);
+    if (action == BleLifecycle::ACTION_STOP_ADVERTISING) {
+        stopAdvertising();
+        Serial.printf("BluetoothScale: Link dropped early - advertising paused for %lu ms\n", (unsigned long)lifecycle.getBackoffMs());
+    } else if (action == BleLifecycle::ACTION_START_ADVERTISING) {
+        bool started = startAdvertising();
+        lifecycle.advertisingStarted(started, now);
+        if (started) {
+            Serial.println("BluetoothScale: Advertising restarted");
+        } else {
+            Serial.printf("BluetoothScale: Advertising start failed - retry in %lu ms\n", (unsigned long)lifecycle.getBackoffMs());
+        }
+    }
+    
+    // Fast advertising after boot and disconnects, slow once nobody has connected for a while
+    if (advertisingPolicy.update(now, lifecycle.getDisconnects(), broadcastLayoutActive)) {
+        applyAdvertisingInterval();
+    }
+    
+    if (telemetry != nullptr) {
+        telemetry->read(latest); // Same loop task as the weight task - never retries
+    }
+    
+    // Weight notifications are sample-driven (publishWeight). Without samples
+    // (HX711 missing or stalled) keep the clients fed at the policy's keepalive rate.
+    if (deviceConnected && (lastSamplePublished == 0 || now - lastSamplePublished >= SAMPLE_STALE_MS)) {
+        int32_t currentWeightCg = latest.weightCg;
+        if (notifyPolicy.evaluate(currentWeightCg, 0.0f, now) != NotifyPolicy::SUPPRESS) {
+            sendWeightNotification(currentWeightCg, 0.0f);
+            notifyPolicy.markSent(currentWeightCg, now);
+            lastWeight = currentWeightCg / 100.0f;
+            lastWeightSent = now;
+        }
+    }
+    
+    // Everything below needs the scale (not set without an HX711)
+    if (scale == nullptr) {
+        return;
+    }
+    
+    // Broadcast rides on the advertising that is on anyway while a connection slot is free
+    if (broadcastLayoutPending) {
+        broadcastLayoutPending = false;
+        applyAdvertisingLayout();
+    }
+    if (broadcastEnabled && now - lastBroadcastMs >= broadcastIntervalMs) {
+        lastBroadcastMs = now;
+        updateBroadcast(false);
+    }
+    
     // Handle connection state changes
     if (!deviceConnected && oldDeviceConnected) {
-        delay(500); // Give the bluetooth stack time to get ready
-        server->startAdvertising();
-        Serial.println("BluetoothScale: Start advertising after disconnect");
+        Serial.println("BluetoothScale: Last client disconnected");
         oldDeviceConnected = deviceConnected;
     }
     
@@ -236,22 +316,32 @@ void BluetoothScale::update() {
         Serial.println("BluetoothScale: Client connected");
         oldDeviceConnected = deviceConnected;
         lastHeartbeat = now;
-        
-        // Send initialization response for WeighMyBru client
-        delay(100); // Give time for connection to stabilize
-        sendNotificationRequest();
+    }
+    
+    // Every newly connected central gets the WeighMyBru handshake once its link has settled
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        PeerConnection& peer = connections.slot(i);
+        if (peer.active && peer.welcomePending && now - peer.connectedMs >= WELCOME_DELAY_MS) {
+            peer.welcomePending = false;
+            notifyPolicy.reset(); // New client gets the current weight straight away
+            sendNotificationRequest();
+        }
     }
     
     if (deviceConnected) {
-        // Send weight updates - faster for GaggiMate brewing applications
-        if (scale && (now - lastWeightSent >= WEIGHT_SEND_INTERVAL)) {
-            float currentWeight = scale->getCurrentWeight();
-            // Send all weight updates for real-time brewing feedback
-            sendWeightNotification(currentWeight);
-            lastWeight = currentWeight;
-            lastWeightSent = now;
+        // Don't hold a partial batch when samples stop arriving
+        if (!batchEncoder.empty() && now - batchStartedMs >= BATCH_MAX_AGE_MS) {
+            flushSampleBatch();
         }
         
+        // Short connection interval while a shot is on, relaxed when idle
+        bool brewing = notifyPolicy.isActive() || latest.timerRunning;
+        connections.update(brewing);
+        
+        // Signal strength reported for the oldest connection
+        PeerConnection* peer = connections.first();
+        connectionRSSI = peer && peer->power.hasRssi() ? peer->power.getRssi() : -100;
+        
         // Send heartbeat
         if (now - lastHeartbeat >= HEARTBEAT_INTERVAL) {
             sendHeartbeat();
@@ -260,20 +350,259 @@ void BluetoothScale::update() {
     }
 }
 
+void BluetoothScale::publishWeight(const TelemetrySnapshot& snapshot) {
+    uint32_t now = millis();
+    lastSamplePublished = now;
+    latest = snapshot;
+    if (!deviceConnected || scale == nullptr) {
+        return;
+    }
+    
+    NotifyPolicy::Decision decision = notifyPolicy.evaluate(snapshot.weightCg, snapshot.flowRate, now);
+    if (decision == NotifyPolicy::SUPPRESS) {
+        gaggiMateStats.suppressed++;
+        beanConquerorStats.suppressed++;
+        return;
+    }
+    sendWeightNotification(snapshot.weightCg, snapshot.flowRate);
+    notifyPolicy.markSent(snapshot.weightCg, now);
+    lastWeight = snapshot.weightCg / 100.0f;
+    lastWeightSent = now;
+}
+
+void BluetoothScale::queueBatchSample(const WeightSample& sample) {
+    if (!deviceConnected || batchCharacteristic == nullptr || !connections.isSubscribed(BLE_CHAR_BATCH)) {
+        batchEncoder.reset();
+        return;
+    }
+    
+    BatchSample entry = { sample.sequence, sample.timestampMs, sample.weightCg };
+    if (!batchEncoder.empty() && !batchEncoder.add(entry)) {
+        flushSampleBatch(); // Full, or a sequence gap - start a new frame with this sample
+    }
+    if (batchEncoder.empty()) {
+        // Size each frame to the smallest subscriber MTU so no notification is truncated
+        uint16_t mtu = connections.getMinMtu(server, BLE_CHAR_BATCH);
+        size_t capacity = mtu > 23 ? min((size_t)(mtu - 3), sizeof(batchBuffer)) : 20;
+        batchEncoder.begin(batchBuffer, capacity);
+        batchEncoder.add(entry);
+        batchStartedMs = millis();
+    }
+    if (millis() - batchStartedMs >= BATCH_MAX_AGE_MS) {
+        flushSampleBatch();
+    }
+}
+
+// Broadcast layout: flags + manufacturer data in the advertisement, the service
+// UUID and name move to the scan response (31 bytes each). Without broadcast
+// the UUID goes back into the advertisement where scanners filtering on it
+// expect it.
+void BluetoothScale::applyAdvertisingLayout() {
+    if (advertising == nullptr) {
+        return;
+    }
+    // Data changes take effect on air at once; the interval follows from the policy in update()
+    NimBLEAdvertisementData scanResponse;
+    if (broadcastEnabled) {
+        scanResponse.setCompleteServices(NimBLEUUID(SERVICE_UUID));
+        scanResponse.setName("WeighMyBru");
+        advertising->setScanResponseData(scanResponse);
+        updateBroadcast(true);
+    } else {
+        NimBLEAdvertisementData advertisement;
+        advertisement.setFlags(BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP);
+        advertisement.setCompleteServices(NimBLEUUID(SERVICE_UUID));
+        advertising->setAdvertisementData(advertisement);
+        scanResponse.setName("WeighMyBru");
+        advertising->setScanResponseData(scanResponse);
+    }
+    broadcastLayoutActive = broadcastEnabled;
+    Serial.printf("BluetoothScale: Broadcast %s\n", broadcastEnabled ? "enabled" : "disabled");
+}
+
+void BluetoothScale::applyAdvertisingInterval() {
+    if (advertising == nullptr) {
+        return;
+    }
+    bool wasAdvertising = advertising->isAdvertising();
+    if (wasAdvertising) {
+        advertising->stop(); // Interval changes only apply to a fresh start
+    }
+    advertising->setMinInterval(advertisingPolicy.getMinInterval());
+    advertising->setMaxInterval(advertisingPolicy.getMaxInterval());
+    if (wasAdvertising && !startAdvertising()) {
+        Serial.println("BluetoothScale: Advertising restart failed - lifecycle retries");
+    }
+    Serial.printf("BluetoothScale: Advertising interval %s (%.1f-%.1f ms)\n", advertisingPolicy.getModeName(),
+                  advertisingPolicy.getMinInterval() * 0.625f, advertisingPolicy.getMaxInterval() * 0.625f);
+}
+
+void BluetoothScale::updateBroadcast(bool force) {
+    if (advertising == nullptr || !broadcastLayoutActive) {
+        return;
+    }
+    
+    BroadcastFrame frame;
+    frame.weightCg = latest.weightCg;
+    frame.flowCgps = (int16_t)constrain(lroundf(latest.flowRate * 100.0f), -32768L, 32767L);
+    frame.timerMs = latest.timerElapsedMs;
+    frame.flags = (latest.timerRunning ? BROADCAST_FLAG_TIMER_RUNNING : 0) |
+                  (notifyPolicy.isActive() ? BROADCAST_FLAG_FLOWING : 0) |
+                  (deviceConnected ? BROADCAST_FLAG_CONNECTED : 0);
+    
+    // Unchanged readings keep the last frame (and sequence) on air
+    if (!force && frame.weightCg == broadcastFrame.weightCg && frame.flowCgps == broadcastFrame.flowCgps &&
+        frame.timerMs / 100 == broadcastFrame.timerMs / 100 && frame.flags == broadcastFrame.flags) {
+        return;
+    }
+    frame.sequence = broadcastFrame.sequence + 1;
+    broadcastFrame = frame;
+    
+    uint8_t data[BROADCAST_MFR_DATA_SIZE];
+    Broadcast::encode(frame, data);
+    NimBLEAdvertisementData advertisement;
+    advertisement.setFlags(BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP);
+    advertisement.setManufacturerData(std::string((const char*)data, sizeof(data)));
+    advertising->setAdvertisementData(advertisement); // Takes effect on air immediately
+    broadcastUpdates++;
+}
+
+void BluetoothScale::setBroadcast(bool enabled, uint16_t intervalMs) {
+    broadcastIntervalMs = constrain(intervalMs, 50, 1000);
+    if (enabled != broadcastEnabled) {
+        broadcastEnabled = enabled;
+        broadcastLayoutPending = true;
+    }
+    preferences.begin("ble", false);
+    preferences.putBool("broadcast", enabled);
+    preferences.putUShort("bcast_ms", broadcastIntervalMs);
+    preferences.end();
+}
+
+void BluetoothScale::writeBroadcastJson(JsonWriter& json) const {
+    json.beginObject();
+    json.field("enabled", broadcastEnabled);
+    json.field("interval_ms", broadcastIntervalMs);
+    json.field("company_id", BROADCAST_COMPANY_ID);
+    json.field("sequence", broadcastFrame.sequence);
+    json.field("updates", broadcastUpdates);
+    json.endObject();
+}
+
+void BluetoothScale::flushSampleBatch() {
+    if (batchEncoder.empty()) {
+        return;
+    }
+    batchCharacteristic->setValue(batchEncoder.data(), batchEncoder.size());
+    notifyCharacteristic(batchCharacteristic, batchStats, batchEncoder.size());
+    batchSamplesSent += batchEncoder.samples();
+    batchEncoder.reset();
+}
+
+// Notify only when someone listens; the stack reports the outcome through onStatus()
+void BluetoothScale::notifyCharacteristic(NimBLECharacteristic* characteristic, NotifyStats& stats, size_t length) {
+    BleCharacteristicId id = idFor(characteristic);
+    if (id == BLE_CHAR_COUNT || !connections.isSubscribed(id)) {
+        stats.suppressed++;
+        return;
+    }
+    characteristic->notify();
+    connections.recordNotify(id, length);
+}
+
+BleCharacteristicId BluetoothScale::idFor(NimBLECharacteristic* characteristic) const {
+    if (characteristic == gaggiMateWeightCharacteristic) return BLE_CHAR_GAGGIMATE;
+    if (characteristic == weightCharacteristic) return BLE_CHAR_BEANCONQUEROR;
+    if (characteristic == commandCharacteristic) return BLE_CHAR_COMMAND;
+    if (characteristic == batchCharacteristic) return BLE_CHAR_BATCH;
+    return BLE_CHAR_COUNT;
+}
+
+// CCCD writes - per connection, so notifications only go out for what someone reads
+void BluetoothScale::onSubscribe(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc, uint16_t subValue) {
+    BleCharacteristicId id = idFor(pCharacteristic);
+    if (id != BLE_CHAR_COUNT) {
+        connections.setSubscribed(desc->conn_handle, id, subValue != 0);
+    }
+}
+
+NotifyStats* BluetoothScale::statsFor(NimBLECharacteristic* characteristic) {
+    if (characteristic == gaggiMateWeightCharacteristic) return &gaggiMateStats;
+    if (characteristic == weightCharacteristic) return &beanConquerorStats;
+    if (characteristic == commandCharacteristic) return &commandStats;
+    if (characteristic == batchCharacteristic) return &batchStats;
+    return nullptr;
+}
+
+void BluetoothScale::onStatus(NimBLECharacteristic* pCharacteristic, Status status, int code) {
+    NotifyStats* stats = statsFor(pCharacteristic);
+    if (stats == nullptr) {
+        return;
+    }
+    switch (status) {
+        case SUCCESS_NOTIFY:
+        case SUCCESS_INDICATE:
+            stats->sent++;
+            break;
+        case ERROR_NOTIFY_DISABLED:
+        case ERROR_INDICATE_DISABLED:
+        case ERROR_NO_CLIENT:
+            stats->suppressed++;
+            break;
+        default:
+            stats->failed++;
+            break;
+    }
+}
+
+static void writeNotifyStats(JsonWriter& json, const char* key, const NotifyStats& stats) {
+    json.beginObject(key);
+    json.field("sent", stats.sent).field("suppressed", stats.suppressed).field("failed", stats.failed);
+    json.endObject();
+}
+
+void BluetoothScale::writeNotificationStatsJson(JsonWriter& json) const {
+    json.beginObject();
+    writeNotifyStats(json, "gaggimate", gaggiMateStats);
+    writeNotifyStats(json, "beanconqueror", beanConquerorStats);
+    writeNotifyStats(json, "command", commandStats);
+    writeNotifyStats(json, "batch", batchStats);
+    json.field("batch_samples", batchSamplesSent);
+    json.beginObject("policy");
+    json.field("active", notifyPolicy.isActive());
+    json.field("deadband_cg", notifyPolicy.getDeadbandCg());
+    json.field("keepalive_ms", notifyPolicy.getKeepaliveMs());
+    json.field("active_sends", notifyPolicy.getActiveSends());
+    json.field("change_sends", notifyPolicy.getChangeSends());
+    json.field("keepalive_sends", notifyPolicy.getKeepaliveSends());
+    json.field("suppressed", notifyPolicy.getSuppressed());
+    json.endObject();
+    json.endObject();
+}
+
 bool BluetoothScale::isConnected() {
     return deviceConnected;
 }
 
-void BluetoothScale::sendWeightNotification(float weight) {
+void BluetoothScale::sendWeightNotification(int32_t weightCg, float flowRate) {
     if (!deviceConnected) {
         return;
     }
     
+    // Only encode the formats a connected client subscribed to
     // Send to GaggiMate first (WeighMyBru protocol format) - critical for backward compatibility
-    sendGaggiMateWeight(weight);
+    if (connections.isSubscribed(BLE_CHAR_GAGGIMATE)) {
+        sendGaggiMateWeight(weightCg, flowRate);
+    } else {
+        gaggiMateStats.suppressed++;
+    }
     
     // Send to Bean Conqueror (simple float format)  
-    sendBeanConquerorWeight(weight);
+    if (connections.isSubscribed(BLE_CHAR_BEANCONQUEROR)) {
+        sendBeanConquerorWeight(weightCg / 100.0f);
+    } else {
+        beanConquerorStats.suppressed++;
+    }
 }
 
 void BluetoothScale::sendBeanConquerorWeight(float weight) {
@@ -292,7 +621,7 @@ void BluetoothScale::sendBeanConquerorWeight(float weight) {
         
         // ESP32 is little-endian, so bytes are already in correct order for Bean Conqueror
         weightCharacteristic->setValue(weightData.bytes, 4);
-        weightCharacteristic->notify();
+        notifyCharacteristic(weightCharacteristic, beanConquerorStats, 4);
         
         //Serial.printf("BluetoothScale: Sent Bean Conqueror weight %.2fg as 4-byte float\n", weight);
     } catch (const std::exception& e) {
@@ -300,49 +629,36 @@ void BluetoothScale::sendBeanConquerorWeight(float weight) {
     }
 }
 
-void BluetoothScale::sendGaggiMateWeight(float weight) {
+void BluetoothScale::sendGaggiMateWeight(int32_t weightCg, float flowRate) {
     if (!gaggiMateWeightCharacteristic) {
         Serial.println("BluetoothScale: WARNING - GaggiMate characteristic is null!");
         return;
     }
     
     try {
-        // Convert weight to integer (grams * 100 for 0.01g precision)
-        int32_t weightInt = (int32_t)(weight * 100);
-        
-        // Create weight message following WeighMyBru protocol
-        uint8_t payload[PROTOCOL_LENGTH] = {0};
-        
-        // Header
-        payload[0] = PRODUCT_NUMBER; // Product number
-        payload[1] = static_cast<uint8_t>(WeighMyBruMessageType::WEIGHT); // Message type
-        payload[2] = 0x00; // Reserved
-        payload[3] = 0x00; // Reserved
-        payload[4] = 0x00; // Reserved
-        payload[5] = 0x00; // Reserved
+        // Scale already delivers grams * 100 (0.01g precision) - no float round trip
+        GaggiMateWeight frame = {};
+        frame.weightCg = weightCg;
         
-        // Sign (positive = 43, negative = 45)
-        payload[6] = (weightInt >= 0) ? 43 : 45;
-        
-        // Weight data (3 bytes, big endian)
-        uint32_t absWeight = abs(weightInt);
-        payload[7] = (absWeight >> 16) & 0xFF;
-        payload[8] = (absWeight >> 8) & 0xFF;
-        payload[9] = absWeight & 0xFF;
-        
-        // Fill remaining bytes with zeros
-        for (int i = 10; i < PROTOCOL_LENGTH - 1; i++) {
-            payload[i] = 0x00;
+        // Flow, timer and sequence in the spare bytes once a client asked for them
+        frame.extension = connections.getFrameExtension();
+        if (frame.extension != 0) {
+            frame.flowCgps = (int16_t)constrain(lroundf(flowRate * 100.0f), -32768L, 32767L);
+            frame.timerMs = latest.timerElapsedMs;
+            frame.state = (latest.sequence != 0 ? latest.filterStateCode : GAGGIMATE_FILTER_STABLE) |
+                          (latest.timerRunning ? GAGGIMATE_STATE_TIMER_RUNNING : 0) |
+                          (notifyPolicy.isActive() ? GAGGIMATE_STATE_FLOWING : 0);
+            frame.sequence = (uint16_t)latest.sampleSequence;
         }
         
-        // Calculate and set checksum (last byte)
-        payload[PROTOCOL_LENGTH - 1] = calculateChecksum(payload, PROTOCOL_LENGTH - 1);
+        uint8_t payload[PROTOCOL_LENGTH];
+        GaggiMateFrame::encode(frame, payload);
         
         // Send notification
         gaggiMateWeightCharacteristic->setValue(payload, PROTOCOL_LENGTH);
-        gaggiMateWeightCharacteristic->notify();
+        notifyCharacteristic(gaggiMateWeightCharacteristic, gaggiMateStats, PROTOCOL_LENGTH);
         
-        //Serial.printf("BluetoothScale: Sent GaggiMate weight %.2fg as WeighMyBru protocol\n", weight);
+        //Serial.printf("BluetoothScale: Sent GaggiMate weight %.2fg as WeighMyBru protocol\n", weightCg / 100.0f);
     } catch (const std::exception& e) {
         Serial.printf("BluetoothScale: ERROR sending GaggiMate weight: %s\n", e.what());
     }
@@ -361,9 +677,13 @@ void BluetoothScale::sendHeartbeat() {
 void BluetoothScale::sendNotificationRequest() {
     if (!deviceConnected) return;
     
-    // Send notification request for WeighMyBru initialization
-    uint8_t payload[] = {0x06, 0x00, 0x00, 0x00, 0x00, 0x00};
+    // Send notification request for WeighMyBru initialization - byte 1 offers the
+    // highest GaggiMate frame extension; clients opt in with FRAME_EXTENSION
+    uint8_t payload[] = {0x06, GAGGIMATE_EXTENSION_VERSION, 0x00, 0x00, 0x00, 0x00};
     sendMessage(WeighMyBruMessageType::SYSTEM, payload, sizeof(payload));
+    if (commandCharacteristic) {
+        notifyCharacteristic(commandCharacteristic, commandStats, commandValueLength); // The client waits for the offer
+    }
     
     Serial.println("BluetoothScale: Notification request sent");
 }
@@ -382,37 +702,85 @@ void BluetoothScale::sendMessage(WeighMyBruMessageType msgType, const uint8_t* p
     
     // Send via command characteristic
     commandCharacteristic->setValue(message, length + 1);
+    commandValueLength = length + 1;
 }
 
 uint8_t BluetoothScale::calculateChecksum(const uint8_t* data, size_t length) {
-    uint8_t checksum = data[0];
-    for (size_t i = 1; i < length; i++) {
-        checksum ^= data[i];
-    }
-    return checksum;
+    return GaggiMateFrame::checksum(data, length);
 }
 
 void BluetoothScale::handleTareCommand() {
-    if (scale) {
-        Serial.println("BluetoothScale: Executing tare command");
-        scale->tare(10);
-        
-        // Send tare confirmation
-        uint8_t payload[] = {0x03, 0x0a, 0x01, 0x00, 0x00};
-        sendMessage(WeighMyBruMessageType::SYSTEM, payload, sizeof(payload));
+    if (scale && commandQueue) {
+        Serial.println("BluetoothScale: Queueing tare command");
+        // Runs inside the NimBLE write callback - queue the tare and confirm once it completes
+        if (!commandQueue->push(CMD_TARE, CMD_SOURCE_BLE, 10, 0.0f, 0.0f, onTareComplete, this)) {
+            Serial.println("BluetoothScale: Command queue full - tare dropped");
+        }
+    }
+}
+
+void BluetoothScale::onTareComplete(bool success, void* context) {
+    BluetoothScale* self = static_cast<BluetoothScale*>(context);
+    if (!success) {
+        Serial.println("BluetoothScale: Tare failed - no confirmation sent");
+        return;
+    }
+    
+    // Send tare confirmation and push it, since the client is no longer waiting on its write
+    uint8_t payload[] = {0x03, 0x0a, 0x01, 0x00, 0x00};
+    self->sendMessage(WeighMyBruMessageType::SYSTEM, payload, sizeof(payload));
+    if (self->deviceConnected && self->commandCharacteristic) {
+        self->notifyCharacteristic(self->commandCharacteristic, self->commandStats, self->commandValueLength);
+    }
+}
+
+void BluetoothScale::onStopTriggered(int32_t weightCg, int32_t targetCg, void* context) {
+    BluetoothScale* self = static_cast<BluetoothScale*>(context);
+    
+    // Pushed straight from the weight task - the client acts on it instead of its own weight polling
+    uint32_t absWeight = abs(weightCg);
+    uint8_t payload[] = {0x03, 0x0a, static_cast<uint8_t>(BeanConquerorCommand::STOP_NOW),
+                         (uint8_t)(weightCg >= 0 ? 43 : 45),
+                         (uint8_t)((absWeight >> 16) & 0xFF), (uint8_t)((absWeight >> 8) & 0xFF), (uint8_t)(absWeight & 0xFF)};
+    self->sendMessage(WeighMyBruMessageType::SYSTEM, payload, sizeof(payload));
+    if (self->deviceConnected && self->commandCharacteristic) {
+        self->notifyCharacteristic(self->commandCharacteristic, self->commandStats, self->commandValueLength);
+    }
+}
+
+void BluetoothScale::onShotEvent(ShotEvent event, uint32_t eventMs, void* context) {
+    BluetoothScale* self = static_cast<BluetoothScale*>(context);
+    
+    // Same codes as the timer confirmations, 0x02 = automatic. The last two bytes
+    // (big-endian ms) say how long ago the backdated event happened, so the client
+    // can align its own timer.
+    uint32_t agoMs = min((uint32_t)(millis() - eventMs), (uint32_t)0xFFFF);
+    BeanConquerorCommand command = event == SHOT_EVENT_START ? BeanConquerorCommand::TIMER_START : BeanConquerorCommand::TIMER_STOP;
+    uint8_t payload[] = {0x03, 0x0a, static_cast<uint8_t>(command), 0x02,
+                         (uint8_t)((agoMs >> 8) & 0xFF), (uint8_t)(agoMs & 0xFF)};
+    self->sendMessage(WeighMyBruMessageType::SYSTEM, payload, sizeof(payload));
+    if (self->deviceConnected && self->commandCharacteristic) {
+        self->notifyCharacteristic(self->commandCharacteristic, self->commandStats, self->commandValueLength);
     }
 }
 
 void BluetoothScale::handleTimerCommand(BeanConquerorCommand command) {
-    if (!display) {
+    if (!display || !commandQueue) {
         Serial.println("BluetoothScale: Display not available for timer command");
         return;
     }
     
+    // Runs inside the NimBLE write callback - the weight task applies it within one cycle
+    CommandType type = command == BeanConquerorCommand::TIMER_START ? CMD_TIMER_START :
+                       command == BeanConquerorCommand::TIMER_STOP ? CMD_TIMER_STOP : CMD_TIMER_RESET;
+    if (!commandQueue->push(type, CMD_SOURCE_BLE)) {
+        Serial.println("BluetoothScale: Command queue full - timer command dropped");
+        return;
+    }
+    
     switch (command) {
         case BeanConquerorCommand::TIMER_START:
             Serial.println("BluetoothScale: Starting timer");
-            display->startTimer();
             // Send timer start confirmation
             {
                 uint8_t payload[] = {0x03, 0x0a, 0x02, 0x01, 0x00};
@@ -422,7 +790,6 @@ void BluetoothScale::handleTimerCommand(BeanConquerorCommand command) {
             
         case BeanConquerorCommand::TIMER_STOP:
             Serial.println("BluetoothScale: Stopping timer");
-            display->stopTimer();
             // Send timer stop confirmation
             {
                 uint8_t payload[] = {0x03, 0x0a, 0x03, 0x01, 0x00};
@@ -432,7 +799,6 @@ void BluetoothScale::handleTimerCommand(BeanConquerorCommand command) {
             
         case BeanConquerorCommand::TIMER_RESET:
             Serial.println("BluetoothScale: Resetting timer");
-            display->resetTimer();
             // Send timer reset confirmation
             {
                 uint8_t payload[] = {0x03, 0x0a, 0x04, 0x01, 0x00};
@@ -446,7 +812,40 @@ void BluetoothScale::handleTimerCommand(BeanConquerorCommand command) {
     }
 }
 
-void BluetoothScale::processIncomingMessage(uint8_t* data, size_t length) {
+// Loads one page of the latest complete shot into the shot characteristic.
+// Layout (little-endian): shot id u16, page u16, total pages u16, records u16,
+// base time u32 (ms since shot start), base weight i32 (cg), then the raw
+// 6-byte ShotRecords. The base is the decoded state just before the page's
+// first record, so each page can be decoded on its own.
+void BluetoothScale::handleShotPageCommand(uint16_t page) {
+    bool ok = false;
+    ShotInfo info;
+    
+    if (shotCharacteristic && shotRecorder && shotRecorder->getLatestShot(info)) {
+        uint16_t totalPages = (info.samples + SHOT_BLE_PAGE_RECORDS - 1) / SHOT_BLE_PAGE_RECORDS;
+        uint32_t first = (uint32_t)page * SHOT_BLE_PAGE_RECORDS;
+        uint16_t count = first < info.samples ? min((uint32_t)SHOT_BLE_PAGE_RECORDS, info.samples - first) : 0;
+        
+        static uint8_t buffer[16 + SHOT_BLE_PAGE_RECORDS * sizeof(ShotRecord)];
+        uint32_t baseTimeMs;
+        int32_t baseWeightCg;
+        if (shotRecorder->decodeBase(info.id, first < info.samples ? first : info.samples, baseTimeMs, baseWeightCg) &&
+            shotRecorder->readRecords(info.id, first, (ShotRecord*)&buffer[16], count)) {
+            uint16_t header[4] = { (uint16_t)info.id, page, totalPages, count };
+            memcpy(&buffer[0], header, sizeof(header));
+            memcpy(&buffer[8], &baseTimeMs, sizeof(baseTimeMs));
+            memcpy(&buffer[12], &baseWeightCg, sizeof(baseWeightCg));
+            shotCharacteristic->setValue(buffer, 16 + count * sizeof(ShotRecord));
+            ok = true;
+        }
+    }
+    
+    Serial.printf("BluetoothScale: Shot page %u %s\n", page, ok ? "ready" : "unavailable");
+    uint8_t payload[] = {0x03, 0x0a, static_cast<uint8_t>(BeanConquerorCommand::SHOT_PAGE), (uint8_t)(ok ? 0x01 : 0x00), 0x00};
+    sendMessage(WeighMyBruMessageType::SYSTEM, payload, sizeof(payload));
+}
+
+void BluetoothScale::processIncomingMessage(uint8_t* data, size_t length, uint16_t connHandle) {
     if (length < 2) return;
     
     uint8_t productNumber = data[0];
@@ -489,6 +888,36 @@ void BluetoothScale::processIncomingMessage(uint8_t* data, size_t length) {
                 }
                 break;
                 
+            case BeanConquerorCommand::TARGET_WEIGHT:
+                if (length >= 6 && stopTrigger) {
+                    int32_t targetCg = ((int32_t)data[3] << 16) | ((int32_t)data[4] << 8) | data[5];
+                    stopTrigger->setTarget(targetCg);
+                    Serial.printf("BluetoothScale: Target weight %.2fg\n", targetCg / 100.0f);
+                    uint8_t payload[] = {0x03, 0x0a, static_cast<uint8_t>(BeanConquerorCommand::TARGET_WEIGHT), 0x01, 0x00};
+                    sendMessage(WeighMyBruMessageType::SYSTEM, payload, sizeof(payload));
+                }
+                break;
+                
+            case BeanConquerorCommand::FRAME_EXTENSION: {
+                // Unknown (newer) versions fall back to the newest we can send
+                uint8_t version = min(data[3], (uint8_t)GAGGIMATE_EXTENSION_VERSION);
+                connections.setFrameExtension(connHandle, version);
+                Serial.printf("BluetoothScale: Frame extension v%u for connection %u\n", version, connHandle);
+                uint8_t payload[] = {0x03, 0x0a, static_cast<uint8_t>(BeanConquerorCommand::FRAME_EXTENSION), version, 0x00};
+                sendMessage(WeighMyBruMessageType::SYSTEM, payload, sizeof(payload));
+                if (commandCharacteristic) {
+                    // Pushed - the client needs the accepted version before it parses extended frames
+                    notifyCharacteristic(commandCharacteristic, commandStats, commandValueLength);
+                }
+                break;
+            }
+                
+            case BeanConquerorCommand::SHOT_PAGE:
+                if (length >= 5) {
+                    handleShotPageCommand(((uint16_t)data[3] << 8) | data[4]);
+                }
+                break;
+                
             default:
                 Serial.printf("BluetoothScale: Unknown command: 0x%02X\n", static_cast<uint8_t>(command));
                 break;
@@ -496,20 +925,33 @@ void BluetoothScale::processIncomingMessage(uint8_t* data, size_t length) {
     }
 }
 
-// BLE Server Callbacks
+// BLE Server Callbacks - NimBLE calls both overloads, the handle-carrying ones do the work
 void BluetoothScale::onConnect(NimBLEServer* pServer) {
-    deviceConnected = true;
-    NimBLEDevice::stopAdvertising();
     Serial.println("BluetoothScale: Device connected");
 }
 
+void BluetoothScale::onConnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) {
+    if (connections.add(pServer, desc->conn_handle) == nullptr) {
+        pServer->disconnect(desc->conn_handle); // No slot - shouldn't happen with advertising stopped when full
+        return;
+    }
+    deviceConnected = true;
+    lifecycle.onConnect(); // Re-advertising for the remaining slots happens in update()
+    Serial.printf("BluetoothScale: %u of %d connections in use\n", connections.getCount(), BLE_MAX_CONNECTIONS);
+}
+
 void BluetoothScale::onDisconnect(NimBLEServer* pServer) {
-    deviceConnected = false;
     Serial.println("BluetoothScale: Device disconnected");
 }
 
+void BluetoothScale::onDisconnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) {
+    uint32_t connectedFor = connections.remove(desc->conn_handle);
+    deviceConnected = connections.getCount() > 0;
+    lifecycle.onDisconnect(connectedFor);
+}
+
 // BLE Characteristic Callbacks
-void BluetoothScale::onWrite(NimBLECharacteristic* pCharacteristic) {
+void BluetoothScale::onWrite(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc) {
     std::string value = pCharacteristic->getValue();
     
     if (value.length() > 0) {
@@ -517,7 +959,7 @@ void BluetoothScale::onWrite(NimBLECharacteristic* pCharacteristic) {
         size_t length = value.length();
         
         Serial.printf("BluetoothScale: Received %d bytes\n", length);
-        processIncomingMessage(data, length);
+        processIncomingMessage(data, length, desc->conn_handle);
     }
 }
 
@@ -531,58 +973,85 @@ void BluetoothScale::setScale(Scale* scaleInstance) {
     Serial.println("BluetoothScale: Scale reference set");
 }
 
+void BluetoothScale::setTelemetry(TelemetryPublisher* publisher) {
+    telemetry = publisher;
+}
+
 void BluetoothScale::setDisplay(Display* displayInstance) {
     display = displayInstance;
     Serial.println("BluetoothScale: Display reference set");
 }
 
+void BluetoothScale::setShotRecorder(ShotRecorder* recorder) {
+    shotRecorder = recorder;
+}
+
+void BluetoothScale::setShotDetector(ShotDetector* detector) {
+    if (detector) {
+        detector->addListener(onShotEvent, this);
+    }
+}
+
+void BluetoothScale::setCommandQueue(CommandQueue* queue) {
+    commandQueue = queue;
+}
+
+void BluetoothScale::setStopTrigger(StopTrigger* trigger) {
+    stopTrigger = trigger;
+    if (stopTrigger) {
+        stopTrigger->addListener(onStopTriggered, this);
+    }
+}
+
 // Get BLE signal strength (RSSI)
 int BluetoothScale::getBluetoothSignalStrength() {
     if (!deviceConnected || !server) {
         return -100; // Return very weak signal if not connected
     }
     
-    // Try to get RSSI from the BLE connection
-    // Note: ESP32 BLE library doesn't directly expose RSSI for server connections
-    // This is a limitation of the current BLE implementation
-    return connectionRSSI; // Will be updated when available
+    // Smoothed RSSI of the oldest connection, sampled by its TxPowerController
+    return connectionRSSI;
 }
 
 // Get detailed BLE connection information
-String BluetoothScale::getBluetoothConnectionInfo() {
-    String info = "{";
-    
-    info += "\"connected\":" + String(deviceConnected ? "true" : "false") + ",";
-    info += "\"advertising\":" + String((advertising != nullptr) ? "true" : "false") + ",";
+void BluetoothScale::writeBluetoothConnectionInfo(JsonWriter& json) {
+    json.beginObject();
+    json.field("connected", deviceConnected);
+    json.field("advertising", advertising != nullptr);
     
     if (deviceConnected) {
-        info += "\"signal_strength\":" + String(connectionRSSI) + ",";
+        json.field("signal_strength", connectionRSSI);
         
         if (connectionRSSI >= -30) {
-            info += "\"signal_quality\":\"Excellent\",";
+            json.field("signal_quality", "Excellent");
         } else if (connectionRSSI >= -50) {
-            info += "\"signal_quality\":\"Very Good\",";
+            json.field("signal_quality", "Very Good");
         } else if (connectionRSSI >= -60) {
-            info += "\"signal_quality\":\"Good\",";
+            json.field("signal_quality", "Good");
         } else if (connectionRSSI >= -70) {
-            info += "\"signal_quality\":\"Fair\",";
+            json.field("signal_quality", "Fair");
         } else if (connectionRSSI >= -80) {
-            info += "\"signal_quality\":\"Weak\",";
+            json.field("signal_quality", "Weak");
         } else {
-            info += "\"signal_quality\":\"Very Weak\",";
+            json.field("signal_quality", "Very Weak");
         }
         
-        info += "\"connection_handle\":" + String(connectionHandle) + ",";
-        info += "\"service_uuid\":\"" + String(SERVICE_UUID) + "\",";
-        info += "\"device_name\":\"WeighMyBru\"";
+        PeerConnection* peer = connections.first();
+        json.field("connection_handle", peer ? peer->handle : 0);
+        json.field("connection_count", connections.getCount());
+        json.key("connections");
+        connections.writeJson(json, server);
+        json.key("lifecycle");
+        lifecycle.writeJson(json);
+        json.key("advertising_policy");
+        advertisingPolicy.writeJson(json, millis());
     } else {
-        info += "\"signal_strength\":null,";
-        info += "\"signal_quality\":\"Disconnected\",";
-        info += "\"connection_handle\":null,";
-        info += "\"service_uuid\":\"" + String(SERVICE_UUID) + "\",";
-        info += "\"device_name\":\"WeighMyBru\"";
+        json.fieldNull("signal_strength");
+        json.field("signal_quality", "Disconnected");
+        json.fieldNull("connection_handle");
+        json.field("connection_count", 0);
     }
-    
-    info += "}";
-    return info;
+    json.field("service_uuid", SERVICE_UUID);
+    json.field("device_name", "WeighMyBru");
+    json.endObject();
 }
@@ -0,0 +1,120 @@
+#include "BootSequence.h"
+#include <esp_timer.h>
+#include "JsonWriter.h"
+
+static const char* READY_NAMES[] = { "display", "ble", "wifi", "scale_probed", "weight" };
+static const size_t READY_COUNT = sizeof(READY_NAMES) / sizeof(READY_NAMES[0]);
+
+BootSequence::BootSequence() : stageCount(0), events(nullptr) {
+    memset(stages, 0, sizeof(stages));
+    memset(readyUs, 0, sizeof(readyUs));
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void BootSequence::begin() {
+    events = xEventGroupCreate();
+    Serial.printf("Boot: setup() entered at %.1f ms\n", esp_timer_get_time() / 1000.0f);
+}
+
+int BootSequence::beginStage(const char* name) {
+    int64_t now = esp_timer_get_time();
+    int id = -1;
+    portENTER_CRITICAL(&lock);
+    if (stageCount < BOOT_MAX_STAGES) {
+        id = (int)stageCount++;
+        stages[id].name = name;
+        stages[id].startUs = now;
+        stages[id].endUs = 0;
+        stages[id].ok = false;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (id < 0) {
+        Serial.printf("Boot: stage table full, not tracking '%s'\n", name);
+    }
+    return id;
+}
+
+void BootSequence::endStage(int stageId, bool ok) {
+    if (stageId < 0 || stageId >= (int)stageCount) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    stages[stageId].endUs = now;
+    stages[stageId].ok = ok;
+    BootStage stage = stages[stageId];
+    portEXIT_CRITICAL(&lock);
+
+    Serial.printf("Boot: %-12s %8.1f -> %8.1f ms (%.1f ms)%s\n", stage.name,
+                  stage.startUs / 1000.0f, stage.endUs / 1000.0f,
+                  (stage.endUs - stage.startUs) / 1000.0f, ok ? "" : " FAILED");
+}
+
+void BootSequence::setReady(EventBits_t bits) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < READY_COUNT; i++) {
+        if ((bits & (1 << i)) && readyUs[i] == 0) {
+            readyUs[i] = now;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (events != nullptr) {
+        xEventGroupSetBits(events, bits);
+    }
+}
+
+bool BootSequence::isReady(EventBits_t bits) const {
+    if (events == nullptr) {
+        return false;
+    }
+    return (xEventGroupGetBits(events) & bits) == bits;
+}
+
+bool BootSequence::waitReady(EventBits_t bits, uint32_t timeoutMs) {
+    if (events == nullptr) {
+        return false;
+    }
+    EventBits_t set = xEventGroupWaitBits(events, bits, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeoutMs));
+    return (set & bits) == bits;
+}
+
+void BootSequence::writeProfileJson(JsonWriter& json) const {
+    BootStage snapshot[BOOT_MAX_STAGES];
+    int64_t readySnapshot[READY_COUNT];
+    portENTER_CRITICAL(&lock);
+    size_t count = stageCount;
+    memcpy(snapshot, stages, sizeof(BootStage) * count);
+    memcpy(readySnapshot, readyUs, sizeof(readySnapshot));
+    portEXIT_CRITICAL(&lock);
+
+    json.beginObject();
+    json.beginArray("stages");
+    for (size_t i = 0; i < count; i++) {
+        const BootStage& stage = snapshot[i];
+        json.beginObject();
+        json.field("name", stage.name);
+        json.field("start_ms", stage.startUs / 1000.0f, 1);
+        if (stage.endUs > 0) {
+            json.field("end_ms", stage.endUs / 1000.0f, 1);
+            json.field("duration_ms", (stage.endUs - stage.startUs) / 1000.0f, 1);
+            json.field("ok", stage.ok);
+        } else {
+            json.fieldNull("end_ms").fieldNull("duration_ms").fieldNull("ok");
+        }
+        json.endObject();
+    }
+    json.endArray();
+    json.beginObject("ready_ms");
+    for (size_t i = 0; i < READY_COUNT; i++) {
+        if (readySnapshot[i] > 0) {
+            json.field(READY_NAMES[i], readySnapshot[i] / 1000.0f, 1);
+        } else {
+            json.fieldNull(READY_NAMES[i]);
+        }
+    }
+    json.endObject();
+    json.endObject();
+}
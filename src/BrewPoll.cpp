@@ -0,0 +1,136 @@
+#include "BrewPoll.h"
+#include "GaggiMateFrame.h"
+#include "JsonWriter.h"
+#include <memory>
+
+BrewPoll::BrewPoll(TelemetryPublisher& telemetry)
+    : telemetry(telemetry), heldCount(0), immediate(0), woken(0), timedOut(0), overflow(0), dropped(0) {
+}
+
+void BrewPoll::attach(AsyncWebServer& server) {
+    server.on("/api/brew/bin", HTTP_GET, [this](AsyncWebServerRequest* request) { handle(request); });
+}
+
+void BrewPoll::wake() {
+    waker.wake(); // Nothing to do unless a request is held
+}
+
+void BrewPoll::handle(AsyncWebServerRequest* request) {
+    TelemetrySnapshot snapshot;
+    telemetry.read(snapshot);
+    uint32_t now = millis();
+
+    if (!request->hasParam("since")) {
+        immediate++;
+        send(request, snapshot, now);
+        return;
+    }
+    uint32_t since = strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+    if (isNewer(snapshot.sampleSequence, since)) {
+        immediate++; // Client is already behind - no need to wait
+        send(request, snapshot, now);
+        return;
+    }
+    if (heldCount >= MAX_HELD) {
+        overflow++;
+        send(request, snapshot, now);
+        return;
+    }
+    uint32_t wait = DEFAULT_WAIT_MS;
+    if (request->hasParam("wait")) {
+        wait = min((uint32_t)strtoul(request->getParam("wait")->value().c_str(), nullptr, 10), MAX_WAIT_MS);
+    }
+    hold(request, since, wait);
+}
+
+void BrewPoll::hold(AsyncWebServerRequest* request, uint32_t since, uint32_t wait) {
+    // Shared by the filler and the disconnect callback, whichever finishes the hold first
+    struct Hold {
+        uint32_t since;
+        uint32_t deadlineMs;
+        int wakeSlot;
+        bool answered;
+        bool released;
+    };
+    std::shared_ptr<Hold> state(new Hold{ since, (uint32_t)(millis() + wait), waker.add(request->client()), false, false });
+    heldCount++;
+
+    request->onDisconnect([this, state]() {
+        if (!state->released) {
+            state->released = true;
+            waker.remove(state->wakeSlot);
+            heldCount--;
+            dropped++;
+        }
+    });
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/octet-stream",
+        [this, state](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            if (state->answered) {
+                return 0; // Frame sent - ends the chunked body
+            }
+            if (maxLen < BREW_FRAME_LENGTH) {
+                return RESPONSE_TRY_AGAIN;
+            }
+            TelemetrySnapshot snapshot;
+            telemetry.read(snapshot);
+            uint32_t now = millis();
+            bool ready = isNewer(snapshot.sampleSequence, state->since);
+            if (!ready && (int32_t)(now - state->deadlineMs) < 0) {
+                return RESPONSE_TRY_AGAIN;
+            }
+            if (ready) {
+                woken++;
+            } else {
+                timedOut++;
+            }
+            state->answered = true;
+            if (!state->released) {
+                state->released = true;
+                waker.remove(state->wakeSlot);
+                heldCount--;
+            }
+            encode(snapshot, now, buffer);
+            return BREW_FRAME_LENGTH;
+        });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
+
+void BrewPoll::encode(const TelemetrySnapshot& snapshot, uint32_t now, uint8_t out[BREW_FRAME_LENGTH]) {
+    BrewWeight frame;
+    frame.flags = (snapshot.filterStateCode == GAGGIMATE_FILTER_STABLE ? BREW_FLAG_STABLE : 0) |
+                  (snapshot.timerRunning ? BREW_FLAG_TIMER_RUNNING : 0) |
+                  (snapshot.timerAuto ? BREW_FLAG_TIMER_AUTO : 0) |
+                  (snapshot.scaleConnected ? BREW_FLAG_SCALE_CONNECTED : 0);
+    frame.filterState = snapshot.filterStateCode;
+    frame.weightCg = snapshot.weightCg;
+    frame.timerMs = snapshot.timerElapsedMs;
+    frame.sequence = snapshot.sampleSequence;
+    frame.flowCgps = (int16_t)constrain(lroundf(snapshot.flowRate * 100.0f), -32768L, 32767L);
+    uint32_t age = snapshot.sampleMs != 0 ? now - snapshot.sampleMs : UINT16_MAX;
+    frame.sampleAgeMs = age > UINT16_MAX ? UINT16_MAX : age;
+    BrewFrame::encode(frame, out);
+}
+
+void BrewPoll::send(AsyncWebServerRequest* request, const TelemetrySnapshot& snapshot, uint32_t now) {
+    uint8_t bytes[BREW_FRAME_LENGTH];
+    encode(snapshot, now, bytes);
+    AsyncResponseStream* response = request->beginResponseStream("application/octet-stream", BREW_FRAME_LENGTH);
+    response->write(bytes, BREW_FRAME_LENGTH);
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
+
+void BrewPoll::writeStatsJson(JsonWriter& json) const {
+    json.beginObject();
+    json.field("held", heldCount);
+    json.field("immediate", immediate);
+    json.field("woken", woken);
+    json.field("timed_out", timedOut);
+    json.field("overflow", overflow);
+    json.field("dropped", dropped);
+    json.key("wake");
+    waker.writeStatsJson(json);
+    json.endObject();
+}
@@ -0,0 +1,127 @@
+#include "CommandQueue.h"
+#include <esp_timer.h>
+#include "JsonWriter.h"
+
+static const char* const COMMAND_NAMES[CMD_TYPE_COUNT] = {
+    "tare", "timer_start", "timer_stop", "timer_reset", "set_calibration",
+    "set_brewing_threshold", "set_stability_timeout", "set_median_samples", "set_average_samples",
+    "set_filter_mode", "set_kalman_noise", "set_flow_mode", "set_flow_window",
+    "set_auto_timer", "set_auto_start_flow", "set_auto_start_ms", "set_auto_stop_flow", "set_auto_stop_ms",
+    "reset_drip_learning"
+};
+
+CommandQueue::CommandQueue()
+    : enqueuePos(0), dequeuePos(0), wakeCallback(nullptr), wakeContext(nullptr), rejected(0), maxDepth(0) {
+    for (uint32_t i = 0; i < COMMAND_QUEUE_CAPACITY; i++) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    memset(stats, 0, sizeof(stats));
+}
+
+bool CommandQueue::push(const Command& command) {
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells[pos & MASK];
+        uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0) {
+            // Cell is free for this position - claim it
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Consumer hasn't freed the cell from the previous lap - full
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed); // Another producer took it
+        }
+    }
+
+    cell->command = command;
+    cell->command.enqueuedUs = (uint32_t)esp_timer_get_time();
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    if (wakeCallback != nullptr) {
+        wakeCallback(wakeContext);
+    }
+    return true;
+}
+
+bool CommandQueue::push(CommandType type, CommandSource source, int32_t intValue, float value0, float value1,
+                        CommandCallback callback, void* context) {
+    Command command = { type, source, intValue, { value0, value1 }, callback, context, 0 };
+    return push(command);
+}
+
+void CommandQueue::setWakeCallback(void (*wake)(void*), void* context) {
+    wakeContext = context;
+    wakeCallback = wake;
+}
+
+size_t CommandQueue::process(CommandHandler handler, void* context) {
+    uint32_t depth = enqueuePos.load(std::memory_order_relaxed) - dequeuePos;
+    if (depth > maxDepth) {
+        maxDepth = depth;
+    }
+
+    size_t processed = 0;
+    for (;;) {
+        Cell* cell = &cells[dequeuePos & MASK];
+        uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+        if ((int32_t)(sequence - (dequeuePos + 1)) < 0) {
+            break; // Empty, or the producer that claimed this cell is still writing it
+        }
+        Command command = cell->command;
+        cell->sequence.store(dequeuePos + COMMAND_QUEUE_CAPACITY, std::memory_order_release);
+        dequeuePos++;
+
+        uint32_t startUs = (uint32_t)esp_timer_get_time();
+        bool ok = handler(command, context);
+        uint32_t endUs = (uint32_t)esp_timer_get_time();
+
+        if (command.type < CMD_TYPE_COUNT) {
+            CommandStats& s = stats[command.type];
+            uint32_t waitUs = startUs - command.enqueuedUs;
+            uint32_t execUs = endUs - startUs;
+            s.executed++;
+            if (!ok) s.failed++;
+            s.waitTotalUs += waitUs;
+            s.execTotalUs += execUs;
+            if (waitUs > s.waitMaxUs) s.waitMaxUs = waitUs;
+            if (execUs > s.execMaxUs) s.execMaxUs = execUs;
+        }
+        processed++;
+    }
+    return processed;
+}
+
+const char* CommandQueue::getTypeName(CommandType type) {
+    return type < CMD_TYPE_COUNT ? COMMAND_NAMES[type] : "unknown";
+}
+
+void CommandQueue::writeStatsJson(JsonWriter& json) const {
+    json.beginObject();
+    json.field("capacity", COMMAND_QUEUE_CAPACITY);
+    json.field("pending", enqueuePos.load(std::memory_order_relaxed) - dequeuePos);
+    json.field("max_depth", maxDepth);
+    json.field("rejected", getRejected());
+    json.beginObject("commands");
+    for (int i = 0; i < CMD_TYPE_COUNT; i++) {
+        const CommandStats& s = stats[i];
+        if (s.executed == 0) {
+            continue;
+        }
+        json.beginObject(COMMAND_NAMES[i]);
+        json.field("executed", s.executed);
+        json.field("failed", s.failed);
+        json.field("wait_avg_us", (uint32_t)(s.waitTotalUs / s.executed));
+        json.field("wait_max_us", s.waitMaxUs);
+        json.field("exec_avg_us", (uint32_t)(s.execTotalUs / s.executed));
+        json.field("exec_max_us", s.execMaxUs);
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+}
@@ -0,0 +1,202 @@
+#include "ConnectionTable.h"
+#include "JsonWriter.h"
+
+static const char* const CHARACTERISTIC_NAMES[BLE_CHAR_COUNT] = { "gaggimate", "beanconqueror", "command", "batch" };
+
+ConnectionTable::ConnectionTable() {
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        slots[i].active = false;
+        slots[i].welcomePending = false;
+        slots[i].handle = BLE_HS_CONN_HANDLE_NONE;
+        slots[i].subscriptions = 0;
+        slots[i].frameExtension = 0;
+    }
+}
+
+PeerConnection* ConnectionTable::add(NimBLEServer* server, uint16_t handle) {
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        PeerConnection& peer = slots[i];
+        if (peer.active) {
+            continue;
+        }
+        uint32_t now = millis();
+        peer.handle = handle;
+        peer.subscriptions = 0;
+        peer.frameExtension = 0;
+        peer.connectedMs = now;
+        peer.notifications = 0;
+        peer.bytes = 0;
+        peer.windowBytes = 0;
+        peer.windowStartMs = now;
+        peer.bytesPerSecond = 0;
+        peer.tuner.onConnect(server, handle);
+        peer.power.onConnect(handle);
+        peer.welcomePending = true;
+        peer.active = true; // Last - the BLE task only looks at active slots
+        return &peer;
+    }
+    return nullptr;
+}
+
+uint32_t ConnectionTable::remove(uint16_t handle) {
+    uint32_t connectedFor = 0;
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        PeerConnection& peer = slots[i];
+        if (peer.active && peer.handle == handle) {
+            peer.active = false;
+            peer.subscriptions = 0;
+            peer.frameExtension = 0;
+            peer.welcomePending = false;
+            peer.tuner.onDisconnect();
+            peer.power.onDisconnect();
+            connectedFor = millis() - peer.connectedMs;
+        }
+    }
+    return connectedFor;
+}
+
+void ConnectionTable::setSubscribed(uint16_t handle, BleCharacteristicId id, bool subscribed) {
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        PeerConnection& peer = slots[i];
+        if (peer.active && peer.handle == handle) {
+            uint8_t mask = 1 << id;
+            peer.subscriptions = subscribed ? (peer.subscriptions | mask) : (peer.subscriptions & ~mask);
+        }
+    }
+}
+
+void ConnectionTable::setFrameExtension(uint16_t handle, uint8_t version) {
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        PeerConnection& peer = slots[i];
+        if (peer.active && peer.handle == handle) {
+            peer.frameExtension = version;
+        }
+    }
+}
+
+void ConnectionTable::update(bool brewing) {
+    uint32_t now = millis();
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        PeerConnection& peer = slots[i];
+        if (!peer.active) {
+            continue;
+        }
+        if (now - peer.windowStartMs >= THROUGHPUT_WINDOW_MS) {
+            peer.bytesPerSecond = peer.windowBytes * 1000UL / (now - peer.windowStartMs);
+            peer.windowBytes = 0;
+            peer.windowStartMs = now;
+        }
+        peer.tuner.update(brewing);
+        peer.power.update(now);
+    }
+}
+
+void ConnectionTable::recordNotify(BleCharacteristicId id, size_t length) {
+    uint8_t mask = 1 << id;
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        PeerConnection& peer = slots[i];
+        if (peer.active && (peer.subscriptions & mask)) {
+            peer.notifications++;
+            peer.bytes += length;
+            peer.windowBytes += length;
+        }
+    }
+}
+
+bool ConnectionTable::isSubscribed(BleCharacteristicId id) const {
+    return getSubscriberCount(id) > 0;
+}
+
+uint8_t ConnectionTable::getSubscriberCount(BleCharacteristicId id) const {
+    uint8_t mask = 1 << id;
+    uint8_t count = 0;
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        if (slots[i].active && (slots[i].subscriptions & mask)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint16_t ConnectionTable::getMinMtu(NimBLEServer* server, BleCharacteristicId id) const {
+    uint8_t mask = 1 << id;
+    uint16_t minMtu = 0;
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        if (slots[i].active && (slots[i].subscriptions & mask)) {
+            uint16_t mtu = server->getPeerMTU(slots[i].handle);
+            if (minMtu == 0 || mtu < minMtu) {
+                minMtu = mtu;
+            }
+        }
+    }
+    return minMtu;
+}
+
+uint8_t ConnectionTable::getFrameExtension() const {
+    // All subscribers share one notification value, so pick what every client that asked can read.
+    // Clients that never asked ignore bytes 10-18 anyway.
+    uint8_t mask = 1 << BLE_CHAR_GAGGIMATE;
+    uint8_t version = 0;
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        uint8_t requested = slots[i].frameExtension;
+        if (slots[i].active && (slots[i].subscriptions & mask) && requested != 0 &&
+            (version == 0 || requested < version)) {
+            version = requested;
+        }
+    }
+    return version;
+}
+
+uint8_t ConnectionTable::getCount() const {
+    uint8_t count = 0;
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        if (slots[i].active) {
+            count++;
+        }
+    }
+    return count;
+}
+
+PeerConnection* ConnectionTable::first() {
+    PeerConnection* oldest = nullptr;
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        if (slots[i].active && (oldest == nullptr || (int32_t)(slots[i].connectedMs - oldest->connectedMs) < 0)) {
+            oldest = &slots[i];
+        }
+    }
+    return oldest;
+}
+
+void ConnectionTable::writeJson(JsonWriter& json, NimBLEServer* server) const {
+    uint32_t now = millis();
+    json.beginArray();
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        const PeerConnection& peer = slots[i];
+        if (!peer.active) {
+            continue;
+        }
+        json.beginObject();
+        json.field("handle", peer.handle);
+        json.field("connected_s", (now - peer.connectedMs) / 1000);
+        if (server != nullptr) {
+            json.field("mtu", server->getPeerMTU(peer.handle));
+        }
+        json.beginArray("subscribed");
+        for (int c = 0; c < BLE_CHAR_COUNT; c++) {
+            if (peer.subscriptions & (1 << c)) {
+                json.value(CHARACTERISTIC_NAMES[c]);
+            }
+        }
+        json.endArray();
+        json.field("frame_extension", peer.frameExtension);
+        json.field("notifications", peer.notifications);
+        json.field("bytes", peer.bytes);
+        json.field("bytes_per_s", peer.bytesPerSecond);
+        json.key("link");
+        peer.tuner.writeInfoJson(json);
+        json.key("power");
+        peer.power.writeJson(json);
+        json.endObject();
+    }
+    json.endArray();
+}
@@ -0,0 +1,91 @@
+#include "ConnectionTuner.h"
+#include "JsonWriter.h"
+
+const ConnectionProfile ConnectionTuner::PROFILE_BREWING = { "brewing", 6, 12, 0, 200 }; // 7.5-15 ms, 2 s timeout
+const ConnectionProfile ConnectionTuner::PROFILE_IDLE = { "idle", 40, 80, 4, 600 };      // 50-100 ms, skip up to 4, 6 s timeout
+
+ConnectionTuner::ConnectionTuner()
+    : server(nullptr), connHandle(0), connected(false), pendingSetup(false), connectedAtMs(0),
+      requested(&PROFILE_IDLE), lastBrewingMs(0), profileRequests(0) {
+}
+
+void ConnectionTuner::onConnect(NimBLEServer* bleServer, uint16_t handle) {
+    server = bleServer;
+    connHandle = handle;
+    connectedAtMs = millis();
+    connected = true;
+    pendingSetup = true;
+}
+
+void ConnectionTuner::onDisconnect() {
+    connected = false;
+    pendingSetup = false;
+}
+
+void ConnectionTuner::update(bool brewing) {
+    if (!connected || server == nullptr) {
+        return;
+    }
+    uint32_t now = millis();
+    if (brewing) {
+        lastBrewingMs = now;
+    }
+
+    if (pendingSetup) {
+        if (now - connectedAtMs < CONNECT_SETTLE_MS) {
+            return;
+        }
+        pendingSetup = false;
+
+        // 2M PHY halves airtime per packet; the central falls back to 1M if it can't
+        int rc = ble_gap_set_prefered_le_phy(connHandle, BLE_GAP_LE_PHY_2M_MASK | BLE_GAP_LE_PHY_1M_MASK,
+                                             BLE_GAP_LE_PHY_2M_MASK | BLE_GAP_LE_PHY_1M_MASK, BLE_GAP_LE_PHY_CODED_ANY);
+        if (rc != 0) {
+            Serial.printf("ConnectionTuner: 2M PHY request failed (rc=%d)\n", rc);
+        }
+        server->setDataLen(connHandle, DATA_LEN_OCTETS);
+        requestProfile(brewing ? PROFILE_BREWING : PROFILE_IDLE);
+        return;
+    }
+
+    // Tighten at once, relax only after brewing has been over for a while
+    if (brewing && requested != &PROFILE_BREWING) {
+        requestProfile(PROFILE_BREWING);
+    } else if (!brewing && requested != &PROFILE_IDLE && now - lastBrewingMs >= IDLE_DELAY_MS) {
+        requestProfile(PROFILE_IDLE);
+    }
+}
+
+void ConnectionTuner::requestProfile(const ConnectionProfile& profile) {
+    requested = &profile;
+    profileRequests++;
+    server->updateConnParams(connHandle, profile.minInterval, profile.maxInterval, profile.latency, profile.timeout);
+    Serial.printf("ConnectionTuner: Requested %s profile (%.2f-%.2f ms, latency %u)\n", profile.name,
+                  profile.minInterval * 1.25f, profile.maxInterval * 1.25f, profile.latency);
+}
+
+void ConnectionTuner::writeInfoJson(JsonWriter& json) const {
+    json.beginObject();
+    json.field("requested_profile", requested->name);
+    json.field("profile_requests", profileRequests);
+
+    ble_gap_conn_desc desc;
+    if (connected && ble_gap_conn_find(connHandle, &desc) == 0) {
+        json.field("interval_ms", desc.conn_itvl * 1.25f, 2);
+        json.field("latency", desc.conn_latency);
+        json.field("supervision_timeout_ms", desc.supervision_timeout * 10);
+
+        uint8_t txPhy = 0;
+        uint8_t rxPhy = 0;
+        if (ble_gap_read_le_phy(connHandle, &txPhy, &rxPhy) == 0) {
+            json.field("tx_phy", txPhy).field("rx_phy", rxPhy); // 1 = 1M, 2 = 2M, 3 = coded
+        }
+        if (server != nullptr) {
+            json.field("mtu", server->getPeerMTU(connHandle));
+        }
+        json.field("requested_data_len", DATA_LEN_OCTETS);
+    } else {
+        json.fieldNull("interval_ms").fieldNull("latency").fieldNull("supervision_timeout_ms");
+    }
+    json.endObject();
+}
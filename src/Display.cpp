@@ -4,11 +4,12 @@
 #include "BluetoothScale.h"
 #include "PowerManager.h"
 #include "BatteryMonitor.h"
+#include "ShotRecorder.h"
 #include <WiFi.h>
 #include "WiFiManager.h"
 
 Display::Display(uint8_t sdaPin, uint8_t sclPin, Scale* scale, FlowRate* flowRate)
-    : sdaPin(sdaPin), sclPin(sclPin), scalePtr(scale), flowRatePtr(flowRate), bluetoothPtr(nullptr), powerManagerPtr(nullptr), batteryPtr(nullptr), wifiManagerPtr(nullptr),
+    : sdaPin(sdaPin), sclPin(sclPin), scalePtr(scale), flowRatePtr(flowRate), bluetoothPtr(nullptr), powerManagerPtr(nullptr), batteryPtr(nullptr), wifiManagerPtr(nullptr), shotRecorderPtr(nullptr), telemetryPtr(nullptr), telemetry(),
       messageStartTime(0), messageDuration(2000), showingMessage(false), 
       timerStartTime(0), timerPausedTime(0), timerRunning(false), timerPaused(false),
       lastFlowRate(0.0), showingStatusPage(false), statusPageStartTime(0) {
@@ -139,14 +140,21 @@ void Display::update() {
         }
     }
     
+    if (telemetryPtr != nullptr) {
+        telemetryPtr->read(telemetry);
+    }
+    
     // Show status page if active
     if (showingStatusPage) {
         showStatusPage();
     }
     // Show normal weight display when not showing message or status page
+    else if (!showingMessage && telemetry.sequence != 0) {
+        // Weight, flow and timer from the same weight task cycle
+        showWeightWithFlowAndTimer(telemetry.weightCg / 100.0f, telemetry.flowRate, telemetry.timerElapsedMs / 1000.0f);
+    }
     else if (!showingMessage && scalePtr != nullptr) {
-        float weight = scalePtr->getCurrentWeight();
-        showWeightWithFlowAndTimer(weight);
+        showWeight(scalePtr->getCurrentWeight());
     }
 }
 
@@ -159,7 +167,8 @@ void Display::showWeight(float weight) {
     if (showingMessage) return; // Don't override messages
     
     // Use the unified display showing weight, flow rate, and timer
-    showWeightWithFlowAndTimer(weight);
+    float currentFlowRate = flowRatePtr != nullptr ? flowRatePtr->getFlowRate() : 0.0f;
+    showWeightWithFlowAndTimer(weight, isnan(currentFlowRate) ? 0.0f : currentFlowRate, getTimerSeconds());
 }
 
 void Display::showMessage(const String& message, int duration) {
@@ -597,6 +606,10 @@ void Display::setPowerManager(PowerManager* powerManager) {
     powerManagerPtr = powerManager;
 }
 
+void Display::setShotRecorder(ShotRecorder* recorder) {
+    shotRecorderPtr = recorder;
+}
+
 void Display::setBatteryMonitor(BatteryMonitor* battery) {
     batteryPtr = battery;
 }
@@ -605,6 +618,10 @@ void Display::setWiFiManager(WiFiManager* wifi) {
     wifiManagerPtr = wifi;
 }
 
+void Display::setTelemetry(TelemetryPublisher* publisher) {
+    telemetryPtr = publisher;
+}
+
 void Display::drawBluetoothStatus() {
     // Return early if display is not connected
     if (!displayConnected) {
@@ -737,7 +754,7 @@ void Display::showWeightWithTimer(float weight) - REMOVED FUNCTION
 Function removed as part of mode simplification - unified into showWeightWithFlowAndTimer()
 */
 
-void Display::showWeightWithFlowAndTimer(float weight) {
+void Display::showWeightWithFlowAndTimer(float weight, float currentFlowRate, float currentTime) {
     // Return early if display is not connected
     if (!displayConnected) {
         return;
@@ -810,15 +827,6 @@ void Display::showWeightWithFlowAndTimer(float weight) {
     // Right side: Timer and flow rate stacked (size 2)
     display->setTextSize(2);
     
-    // Get timer value and format without "s"
-    float currentTime = getTimerSeconds();
-    
-    // Get flow rate and format without "g/s"
-    float currentFlowRate = 0.0;
-    if (flowRatePtr != nullptr) {
-        currentFlowRate = flowRatePtr->getFlowRate();
-    }
-    
     // Apply deadband to flow rate
     float displayFlowRate = currentFlowRate;
     if (currentFlowRate >= -0.1 && currentFlowRate <= 0.1) {
@@ -928,14 +936,7 @@ void Display::showWeightWithFlowAndTimer(float weight) {
 void Display::startTimer() {
     if (!timerRunning) {
         // Fresh start
-        timerStartTime = millis();
-        timerRunning = true;
-        timerPaused = false;
-        
-        // Start flow rate averaging when timer starts
-        if (flowRatePtr != nullptr) {
-            flowRatePtr->startTimerAveraging();
-        }
+        startTimerAt(millis());
     } else if (timerPaused) {
         // Resume from paused state
         timerStartTime = millis() - timerPausedTime;
@@ -945,19 +946,48 @@ void Display::startTimer() {
         if (flowRatePtr != nullptr) {
             flowRatePtr->startTimerAveraging();
         }
+        
+        if (shotRecorderPtr != nullptr) {
+            shotRecorderPtr->resumeShot();
+        }
     }
     // If timer is already running and not paused, do nothing
 }
 
+void Display::startTimerAt(unsigned long startMs) {
+    // Always a fresh start - a paused timer from the previous shot is discarded
+    timerStartTime = startMs;
+    timerPausedTime = 0;
+    timerRunning = true;
+    timerPaused = false;
+    
+    // Start flow rate averaging when timer starts
+    if (flowRatePtr != nullptr) {
+        flowRatePtr->startTimerAveraging();
+    }
+    
+    if (shotRecorderPtr != nullptr) {
+        shotRecorderPtr->startShot(startMs);
+    }
+}
+
 void Display::stopTimer() {
+    stopTimerAt(millis());
+}
+
+void Display::stopTimerAt(unsigned long stopMs) {
     if (timerRunning && !timerPaused) {
-        timerPausedTime = millis() - timerStartTime;
+        timerPausedTime = (long)(stopMs - timerStartTime) > 0 ? stopMs - timerStartTime : 0;
         timerPaused = true;
         
         // Stop flow rate averaging when timer stops
         if (flowRatePtr != nullptr) {
             flowRatePtr->stopTimerAveraging();
         }
+        
+        if (shotRecorderPtr != nullptr) {
+            shotRecorderPtr->stopShot();
+        }
     }
 }
 
@@ -971,6 +1001,11 @@ void Display::resetTimer() {
     if (flowRatePtr != nullptr) {
         flowRatePtr->resetTimerAveraging();
     }
+
+    // A reset while running ends the shot as well
+    if (shotRecorderPtr != nullptr && shotRecorderPtr->isRecording()) {
+        shotRecorderPtr->stopShot();
+    }
 }
 
 bool Display::isTimerRunning() const {
@@ -1001,7 +1036,7 @@ void Display::showStatusPage() {
     
     // Battery percentage (left) - without "BAT:" prefix
     if (batteryPtr != nullptr) {
-        int batteryPercent = batteryPtr->getBatteryPercentage();
+        int batteryPercent = telemetry.sequence != 0 ? telemetry.batteryPercentage : batteryPtr->getBatteryPercentage();
         display->setCursor(0, 0);
         display->print(batteryPercent);
         display->print("%");
@@ -1011,7 +1046,8 @@ void Display::showStatusPage() {
     }
     
     // Scale status (center) - HX711 text with rectangle border when connected
-    bool scaleConnected = (scalePtr != nullptr && scalePtr->isHX711Connected());
+    bool scaleConnected = telemetry.sequence != 0 ? telemetry.scaleConnected
+                                                  : (scalePtr != nullptr && scalePtr->isHX711Connected());
     display->setCursor(50, 0);
     display->print("HX711");
     if (scaleConnected) {
@@ -1022,7 +1058,9 @@ void Display::showStatusPage() {
     // Bluetooth status (right) - BT text with rectangle border when connected
     display->setCursor(110, 0);
     display->print("BT");
-    if (bluetoothPtr != nullptr && bluetoothPtr->isConnected()) {
+    bool bluetoothConnected = telemetry.sequence != 0 ? telemetry.bluetoothConnected
+                                                      : (bluetoothPtr != nullptr && bluetoothPtr->isConnected());
+    if (bluetoothConnected) {
         // Draw rectangle around "BT" when connected (with proper spacing)
         display->drawRect(108, -1, 16, 10, SSD1306_WHITE); // Rectangle around "BT"
     }
@@ -4,19 +4,134 @@
 
 FlowRate::FlowRate() : lastWeight(0), lastTime(0), flowRate(0), bufferIndex(0), bufferCount(0),
     timerAveragingActive(false), timerFlowRateSum(0), timerFlowRateSamples(0), 
-    timerAverageFlowRate(0), hasValidTimerAverage(false), calculationPaused(false) {
+    timerAverageFlowRate(0), hasValidTimerAverage(false), calculationPaused(false),
+    mode(MODE_REGRESSION), lastWeightCg(0), fitResidual(0), flowStdError(0) {
     for (int i = 0; i < FLOWRATE_AVG_WINDOW; ++i) flowRateBuffer[i] = 0;
+    regression.setWindowMs(1500);
+}
+
+void FlowRate::begin() {
+    preferences.begin("flowrate", true);
+    mode = preferences.getUChar("mode", MODE_REGRESSION) == MODE_DIFFERENCE ? MODE_DIFFERENCE : MODE_REGRESSION;
+    regression.setWindowMs(preferences.getULong("window_ms", 1500));
+    preferences.end();
+    Serial.println("Flow rate mode: " + getModeName() + ", regression window " + String(regression.getWindowMs()) + "ms");
+}
+
+void FlowRate::setMode(Mode newMode) {
+    if (newMode != MODE_DIFFERENCE && newMode != MODE_REGRESSION) {
+        return;
+    }
+    if (mode != newMode) {
+        mode = newMode;
+        clearFlowRateBuffer();
+        preferences.begin("flowrate", false);
+        preferences.putUChar("mode", (uint8_t)mode);
+        preferences.end();
+    }
+}
+
+void FlowRate::setRegressionWindow(uint32_t windowMs) {
+    if (windowMs >= 200 && windowMs <= 3000) {
+        regression.setWindowMs(windowMs);
+        preferences.begin("flowrate", false);
+        preferences.putULong("window_ms", windowMs);
+        preferences.end();
+    }
 }
 
 void FlowRate::update(float currentWeight) {
+    update(currentWeight, millis());
+}
+
+void FlowRate::update(const WeightSample& sample) {
+    if (!isnan(sample.flowRate)) {
+        applyEstimatedFlow(sample.flowRate, sample.weight, sample.timestampMs);
+    } else if (mode == MODE_REGRESSION) {
+        updateRegression(sample.weightCg, sample.timestampMs);
+    } else {
+        updateDifference(sample.weight, sample.timestampMs);
+    }
+}
+
+void FlowRate::applyEstimatedFlow(float estimatedFlow, float currentWeight, unsigned long timestampMs) {
+    // Skip flow rate calculation if paused (during tare operations)
+    if (calculationPaused) {
+        return;
+    }
+    
+    // Estimator already smooths jointly with weight - no finite difference or averaging window
+    flowRate = estimatedFlow;
+    
+    // Track flow rate for timer-based averaging (only when positive flow)
+    if (timerAveragingActive && flowRate > 0.1f) {
+        timerFlowRateSum += flowRate;
+        timerFlowRateSamples++;
+    }
+    
+    // Apply zero threshold to eliminate tiny fluctuations
+    if (abs(flowRate) < ZERO_THRESHOLD) {
+        flowRate = 0.0f;
+    }
+    
+    lastWeight = currentWeight;
+    lastTime = timestampMs;
+}
+
+void FlowRate::update(float currentWeight, unsigned long timestampMs) {
+    if (mode == MODE_REGRESSION) {
+        updateRegression((int32_t)lroundf(currentWeight * 100.0f), timestampMs);
+    } else {
+        updateDifference(currentWeight, timestampMs);
+    }
+}
+
+void FlowRate::updateRegression(int32_t weightCg, unsigned long timestampMs) {
+    // Skip flow rate calculation if paused (during tare operations)
+    if (calculationPaused) {
+        return;
+    }
+    
+    if (lastTime > 0 && (long)(timestampMs - lastTime) < 0) {
+        return; // Ignore samples captured before the last resume
+    }
+    
+    // A step no pour can produce (cup placed/removed, tare) - fit only what comes after it
+    if (regression.size() > 0 && abs(weightCg - lastWeightCg) > REGRESSION_JUMP_CG) {
+        regression.reset();
+    }
+    regression.push((uint32_t)timestampMs, weightCg);
+    lastWeightCg = weightCg;
+    
+    if (!regression.valid()) {
+        fitResidual = 0.0f;
+        flowStdError = 0.0f;
+        flowRate = 0.0f;
+        lastWeight = weightCg / 100.0f;
+        lastTime = timestampMs;
+        return;
+    }
+    
+    // Slope is centigrams per ms: x 1000 ms/s / 100 cg/g
+    fitResidual = regression.residualRms() / 100.0f;
+    flowStdError = regression.slopeStdError() * 10.0f;
+    applyEstimatedFlow(regression.slope() * 10.0f, weightCg / 100.0f, timestampMs);
+}
+
+void FlowRate::updateDifference(float currentWeight, unsigned long timestampMs) {
     // Skip flow rate calculation if paused (during tare operations)
     if (calculationPaused) {
         return;
     }
     
-    unsigned long now = millis();
+    unsigned long now = timestampMs;
     
     if (lastTime > 0) {
+        // Ignore samples captured before the last resume
+        if ((long)(now - lastTime) < 0) {
+            return;
+        }
+        
         float deltaWeight = currentWeight - lastWeight;
         float deltaTime = (now - lastTime) / 1000.0f; // seconds
         
@@ -177,6 +292,7 @@ void FlowRate::resumeCalculation() {
     calculationPaused = false;
     // Reset timing to avoid using old weight data
     lastTime = millis();
+    regression.reset();
     Serial.println("Flow rate calculation resumed");
 }
 
@@ -190,6 +306,9 @@ void FlowRate::clearFlowRateBuffer() {
     flowRate = 0.0f;
     lastWeight = 0.0f;
     lastTime = 0;
+    regression.reset();
+    fitResidual = 0.0f;
+    flowStdError = 0.0f;
     Serial.println("Flow rate buffer cleared for fresh start");
 }
 
@@ -0,0 +1,288 @@
+#include "JsonWriter.h"
+#include <math.h>
+
+JsonWriter::JsonWriter(Print& out) : out(out), depth(0), hasItems(0), keyPending(false), length(0) {
+}
+
+void JsonWriter::raw(const char* text, size_t count) {
+    length += out.write((const uint8_t*)text, count);
+}
+
+void JsonWriter::raw(const char* text) {
+    raw(text, strlen(text));
+}
+
+void JsonWriter::separator() {
+    if (keyPending) {
+        keyPending = false;
+        return;
+    }
+    uint16_t bit = 1 << depth;
+    if (hasItems & bit) {
+        raw(",", 1);
+    }
+    hasItems |= bit;
+}
+
+void JsonWriter::member(const char* name) {
+    separator();
+    string(name);
+    raw(":", 1);
+}
+
+void JsonWriter::string(const char* text) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    raw("\"", 1);
+    const char* run = text; // Copy unescaped stretches in one write
+    for (const char* p = text; *p; p++) {
+        uint8_t c = *p;
+        if (c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+        raw(run, p - run);
+        run = p + 1;
+        if (c == '"' || c == '\\') {
+            char escaped[2] = { '\\', (char)c };
+            raw(escaped, 2);
+        } else {
+            char escaped[6] = { '\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0x0F] };
+            raw(escaped, 6);
+        }
+    }
+    raw(run, strlen(run));
+    raw("\"", 1);
+}
+
+void JsonWriter::number(unsigned long long value, bool negative) {
+    char buffer[21];
+    char* p = buffer + sizeof(buffer);
+    do {
+        *--p = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    if (negative) {
+        *--p = '-';
+    }
+    raw(p, buffer + sizeof(buffer) - p);
+}
+
+void JsonWriter::number(long long value) {
+    number(value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value, value < 0);
+}
+
+void JsonWriter::number(double value, uint8_t decimals) {
+    static const uint32_t POWERS[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+    if (isnan(value) || isinf(value) || fabs(value) >= 9.0e12) {
+        raw("null", 4);
+        return;
+    }
+    decimals = min(decimals, (uint8_t)6);
+    // Round once in fixed point, then print integer and fraction digits
+    unsigned long long scaled = (unsigned long long)llround(fabs(value) * POWERS[decimals]);
+    bool negative = value < 0 && scaled > 0;
+    number(scaled / POWERS[decimals], negative);
+    if (decimals > 0) {
+        char fraction[8];
+        uint32_t rest = scaled % POWERS[decimals];
+        fraction[0] = '.';
+        for (int i = decimals; i > 0; i--) {
+            fraction[i] = '0' + rest % 10;
+            rest /= 10;
+        }
+        raw(fraction, decimals + 1);
+    }
+}
+
+void JsonWriter::open(char bracket) {
+    raw(&bracket, 1);
+    if (depth < MAX_DEPTH - 1) {
+        depth++;
+    }
+    hasItems &= ~(1 << depth);
+}
+
+void JsonWriter::close(char bracket) {
+    if (depth > 0) {
+        depth--;
+    }
+    raw(&bracket, 1);
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separator();
+    open('{');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginObject(const char* name) {
+    member(name);
+    open('{');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    close('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separator();
+    open('[');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray(const char* name) {
+    member(name);
+    open('[');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    close(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    member(name);
+    keyPending = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, bool v) {
+    member(name);
+    raw(v ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, long long v) {
+    member(name);
+    number(v);
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, unsigned long long v) {
+    member(name);
+    number(v, false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, double v, uint8_t decimals) {
+    member(name);
+    number(v, decimals);
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, const char* v) {
+    member(name);
+    if (v == nullptr) {
+        raw("null", 4);
+    } else {
+        string(v);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::fieldNull(const char* name) {
+    member(name);
+    raw("null", 4);
+    return *this;
+}
+
+size_t JsonWriter::formatCentigrams(char* buffer, size_t size, int32_t cg, uint8_t decimals) {
+    bool negative = cg < 0;
+    uint32_t magnitude = negative ? -(int64_t)cg : cg;
+    int length;
+    if (decimals >= 2) {
+        length = snprintf(buffer, size, "%s%lu.%02lu", negative ? "-" : "",
+                          (unsigned long)(magnitude / 100), (unsigned long)(magnitude % 100));
+    } else {
+        uint32_t decigrams = (magnitude + 5) / 10;
+        negative = negative && decigrams > 0;
+        length = snprintf(buffer, size, "%s%lu.%lu", negative ? "-" : "",
+                          (unsigned long)(decigrams / 10), (unsigned long)(decigrams % 10));
+    }
+    return length < 0 ? 0 : min((size_t)length, size - 1);
+}
+
+JsonWriter& JsonWriter::fieldCentigrams(const char* name, int32_t cg, uint8_t decimals) {
+    member(name);
+    char buffer[16];
+    raw(buffer, formatCentigrams(buffer, sizeof(buffer), cg, decimals));
+    return *this;
+}
+
+JsonWriter& JsonWriter::fieldIp(const char* name, const IPAddress& ip) {
+    member(name);
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    string(buffer);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool v) {
+    separator();
+    raw(v ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long long v) {
+    separator();
+    number(v);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long long v) {
+    separator();
+    number(v, false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double v, uint8_t decimals) {
+    separator();
+    number(v, decimals);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* v) {
+    separator();
+    if (v == nullptr) {
+        raw("null", 4);
+    } else {
+        string(v);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::valueNull() {
+    separator();
+    raw("null", 4);
+    return *this;
+}
+
+FixedBufferPrint::FixedBufferPrint(char* buffer, size_t capacity)
+    : buffer(buffer), capacity(capacity), used(0), overflow(false) {
+    clear();
+}
+
+void FixedBufferPrint::clear() {
+    used = 0;
+    overflow = false;
+    if (capacity > 0) {
+        buffer[0] = '\0';
+    }
+}
+
+size_t FixedBufferPrint::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t FixedBufferPrint::write(const uint8_t* data, size_t size) {
+    if (capacity == 0 || used + size > capacity - 1) {
+        overflow = true;
+        return 0;
+    }
+    memcpy(buffer + used, data, size);
+    used += size;
+    buffer[used] = '\0';
+    return size;
+}
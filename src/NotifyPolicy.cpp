@@ -0,0 +1,47 @@
+#include "NotifyPolicy.h"
+
+NotifyPolicy::NotifyPolicy()
+    : deadbandCg(5), keepaliveMs(1000), active(false), forceNext(true), lastActiveMs(0),
+      lastSentCg(0), lastSentMs(0), activeSends(0), changeSends(0), keepaliveSends(0), suppressed(0) {
+}
+
+void NotifyPolicy::reset() {
+    forceNext = true;
+    active = false;
+}
+
+NotifyPolicy::Decision NotifyPolicy::evaluate(int32_t weightCg, float flowRate, uint32_t now) {
+    if (fabsf(flowRate) >= ACTIVE_FLOW) {
+        active = true;
+        lastActiveMs = now;
+    } else if (active && now - lastActiveMs >= ACTIVE_HOLD_MS) {
+        active = false;
+    }
+
+    Decision decision = SUPPRESS;
+    if (forceNext) {
+        decision = SEND_CHANGE;
+    } else if (now - lastSentMs < MIN_INTERVAL_MS) {
+        decision = SUPPRESS;
+    } else if (active) {
+        decision = weightCg != lastSentCg || now - lastSentMs >= keepaliveMs ? SEND_ACTIVE : SUPPRESS;
+    } else if (abs(weightCg - lastSentCg) > deadbandCg) {
+        decision = SEND_CHANGE;
+    } else if (now - lastSentMs >= keepaliveMs) {
+        decision = SEND_KEEPALIVE;
+    }
+
+    switch (decision) {
+        case SEND_ACTIVE: activeSends++; break;
+        case SEND_CHANGE: changeSends++; break;
+        case SEND_KEEPALIVE: keepaliveSends++; break;
+        default: suppressed++; break;
+    }
+    return decision;
+}
+
+void NotifyPolicy::markSent(int32_t weightCg, uint32_t now) {
+    lastSentCg = weightCg;
+    lastSentMs = now;
+    forceNext = false;
+}
@@ -0,0 +1,82 @@
+#include "PollWaker.h"
+#include "JsonWriter.h"
+#include <AsyncTCP.h>
+#include <lwip/tcpip.h>
+#include <lwip/priv/tcp_priv.h>
+
+PollWaker::PollWaker() : registered(0), pending(false), posted(0), coalesced(0), queueFull(0) {
+    for (size_t i = 0; i < SLOTS; i++) {
+        pcbs[i] = nullptr;
+        clients[i] = nullptr;
+    }
+}
+
+int PollWaker::add(AsyncClient* client) {
+    tcp_pcb* pcb = client != nullptr ? client->pcb() : nullptr;
+    if (pcb == nullptr) {
+        return -1;
+    }
+    for (size_t i = 0; i < SLOTS; i++) {
+        if (pcbs[i].load() == nullptr) {
+            clients[i] = client;
+            pcbs[i] = pcb; // Last - run() only looks at slots with a pcb
+            registered++;
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void PollWaker::remove(int slot) {
+    if (slot >= 0 && slot < (int)SLOTS && pcbs[slot].exchange(nullptr) != nullptr) {
+        registered--;
+    }
+}
+
+void PollWaker::wake() {
+    if (registered.load() == 0) {
+        return;
+    }
+    if (pending.exchange(true)) {
+        coalesced++;
+        return;
+    }
+    if (tcpip_try_callback(run, this) == ERR_OK) {
+        posted++;
+    } else {
+        pending = false; // lwIP mailbox full - the connection poll still runs the handler
+        queueFull++;
+    }
+}
+
+void PollWaker::run(void* context) {
+    PollWaker* waker = static_cast<PollWaker*>(context);
+    waker->pending = false; // Samples published from here on need another wake
+
+    for (size_t i = 0; i < SLOTS; i++) {
+        tcp_pcb* target = waker->pcbs[i].load();
+        if (target == nullptr) {
+            continue;
+        }
+        // The pcb may have been closed and freed since it was registered -
+        // only touch it while lwIP still lists it as active, and only while
+        // AsyncTCP's callbacks are still attached to the same client
+        for (tcp_pcb* pcb = tcp_active_pcbs; pcb != nullptr; pcb = pcb->next) {
+            if (pcb == target) {
+                if (pcb->callback_arg == waker->clients[i].load() && pcb->poll != nullptr) {
+                    pcb->poll(pcb->callback_arg, pcb);
+                }
+                break;
+            }
+        }
+    }
+}
+
+void PollWaker::writeStatsJson(JsonWriter& json) const {
+    json.beginObject();
+    json.field("registered", registered.load());
+    json.field("posted", posted.load());
+    json.field("coalesced", coalesced.load());
+    json.field("queue_full", queueFull.load());
+    json.endObject();
+}
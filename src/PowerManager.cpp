@@ -173,6 +173,15 @@ void PowerManager::handleTimerControl() {
     lastTimerControlTime = currentTime;
     Serial.println("Timer control triggered");
     
+    // The auto timer (and BLE/web) can move the timer behind our back - follow the display
+    if (displayPtr->isTimerRunning()) {
+        timerState = TimerState::RUNNING;
+    } else if (displayPtr->getElapsedTime() > 0) {
+        timerState = TimerState::PAUSED;
+    } else {
+        timerState = TimerState::STOPPED;
+    }
+    
     // Unified mode timer control
     switch (timerState) {
         case TimerState::STOPPED:
@@ -5,12 +5,8 @@
 
 Scale::Scale(uint8_t dataPin, uint8_t clockPin, float calibrationFactor)
     : dataPin(dataPin), clockPin(clockPin), calibrationFactor(calibrationFactor), currentWeight(0.0f),
-      readingIndex(0), samplesInitialized(false), previousFilteredWeight(0), medianSamples(3), averageSamples(2),
-      currentFilterState(STABLE), lastBrewingActivity(0), lastStableWeight(0.0f) {
-    // Initialize readings array
-    for (int i = 0; i < MAX_SAMPLES; i++) {
-        readings[i] = 0.0f;
-    }
+      samplesInitialized(false), medianSamples(3), averageSamples(2),
+      currentFilterState(STABLE), lastBrewingActivity(0), lastStableCounts(0) {
 }
 
 bool Scale::begin() {
@@ -41,6 +37,7 @@ bool Scale::begin() {
     }
     
     preferences.end();
+    updateFixedPointScale();
     
     // Initialize HX711 with error handling
     Serial.println("Initializing HX711...");
@@ -52,26 +49,22 @@ bool Scale::begin() {
     unsigned long startTime = millis();
     bool testPassed = false;
     
-    // Try to get a reading with 3 second timeout
+    // Try to get a reading with 3 second timeout. Runs on its own boot task, so poll
+    // finely - the first conversion is ready within one sample period (100ms at 10 SPS)
     while (millis() - startTime < 3000) {
         if (hx711.is_ready()) {
             long testReading = hx711.read();
             if (testReading != 0) {  // HX711 returns 0 when not connected
                 testPassed = true;
-                Serial.println("HX711 test reading: " + String(testReading));
+                Serial.println("HX711 test reading: " + String(testReading) + " after " + String(millis() - startTime) + "ms");
                 break;
             }
         }
-        delay(100);  // Small delay between attempts
+        delay(5);
     }
     
     if (testPassed) {
         Serial.println("HX711 connected successfully");
-        isConnected = true;
-        
-        // Only tare if connection is confirmed
-        Serial.println("Performing initial tare...");
-        hx711.tare();
         
         Serial.println("Smart Scale filtering configured:");
         Serial.println("Brewing threshold: " + String(brewingThreshold) + "g");
@@ -80,6 +73,11 @@ bool Scale::begin() {
         Serial.println("Average samples (stable): " + String(averageSamples));
         Serial.println("Smart filtering: ENABLED - Dynamic filter switching based on brewing activity");
         
+        // Hand the HX711 over to the acquisition task - no direct reads after this point.
+        // No weight is published until the first requestTare() establishes the zero.
+        startAcquisition();
+        isConnected = true;
+        
         return true;
     } else {
         Serial.println("ERROR: HX711 not responding!");
@@ -95,36 +93,116 @@ bool Scale::begin() {
     }
 }
 
-void Scale::tare(uint8_t times) {
+bool Scale::requestTare(uint8_t times, TareCallback callback, void* context) {
     if (!isConnected) {
         Serial.println("Cannot tare: HX711 not connected");
-        return;
+        return false;
+    }
+    if (times == 0) {
+        times = 1;
     }
     
-    // Pause flow rate calculation to prevent tare operation from affecting flow rate
-    if (flowRatePtr != nullptr) {
-        flowRatePtr->pauseCalculation();
+    bool registered = true;
+    portENTER_CRITICAL(&tareLock);
+    if (requestedTareSamples == 0) {
+        requestedTareTime = millis();
     }
+    if (times > requestedTareSamples) {
+        requestedTareSamples = times;
+    }
+    if (callback != nullptr) {
+        if (requestedWaiterCount < TARE_MAX_WAITERS) {
+            requestedWaiters[requestedWaiterCount++] = {callback, context};
+        } else {
+            registered = false;
+        }
+    }
+    tareState = TARE_PENDING;
+    portEXIT_CRITICAL(&tareLock);
     
-    Serial.println("Taring scale...");
-    hx711.tare(times);
-    Serial.println("Tare complete");
+    Serial.println("Tare requested (" + String(times) + " samples)");
+    return registered;
+}
+
+const char* Scale::getTareStateName() const {
+    switch (tareState) {
+        case TARE_PENDING: return "pending";
+        case TARE_DONE: return "done";
+        case TARE_FAILED: return "failed";
+        default: return "idle";
+    }
+}
+
+void Scale::serviceTare() {
+    if (tareActive) {
+        // HX711 stopped converting - give up rather than leave callers waiting forever
+        if (millis() - tareStartTime > (unsigned long)tareTarget * 150 + 500) {
+            Serial.println("Tare timed out waiting for HX711 conversions");
+            finishTare(false);
+        }
+        return;
+    }
     
-    // Reset smart filter state after taring - return to stable mode
-    currentFilterState = STABLE;
-    lastBrewingActivity = 0;
-    currentWeight = 0.0f;
-    lastStableWeight = 0.0f;
+    portENTER_CRITICAL(&tareLock);
+    if (requestedTareSamples > 0) {
+        tareActive = true;
+        tareTarget = requestedTareSamples;
+        tareStartTime = requestedTareTime;
+        for (uint8_t i = 0; i < requestedWaiterCount; i++) {
+            activeWaiters[i] = requestedWaiters[i];
+        }
+        activeWaiterCount = requestedWaiterCount;
+        requestedTareSamples = 0;
+        requestedWaiterCount = 0;
+    }
+    portEXIT_CRITICAL(&tareLock);
+    
+    if (tareActive) {
+        tareCollected = 0;
+        tareSum = 0;
+        Serial.println("Taring scale...");
+        
+        // Pause flow rate calculation to prevent the offset swap from affecting flow rate
+        if (flowRatePtr != nullptr) {
+            flowRatePtr->pauseCalculation();
+        }
+    }
+}
+
+void Scale::finishTare(bool success) {
+    tareActive = false;
     
-    // Reinitialize sample buffer
-    samplesInitialized = false;
-    Serial.println("Smart filter reset to STABLE state");
+    if (success) {
+        // Single 32-bit store - readers on other tasks see either the old or the new offset
+        hx711.set_offset((int32_t)(tareSum / tareCollected));
+        tareCount++;
+        Serial.println("Tare complete");
+        
+        // Reset smart filter state after taring - return to stable mode
+        currentFilterState = STABLE;
+        lastBrewingActivity = 0;
+        currentWeight = 0.0f;
+        currentWeightCg = 0;
+        currentCounts = 0;
+        lastStableCounts = 0;
+        
+        // Reinitialize sample buffer
+        samplesInitialized = false;
+        Serial.println("Smart filter reset to STABLE state");
+    }
     
-    // Resume flow rate calculation after a short delay to ensure stable readings
     if (flowRatePtr != nullptr) {
-        delay(100); // Short delay to let scale stabilize
         flowRatePtr->resumeCalculation();
     }
+    
+    portENTER_CRITICAL(&tareLock);
+    tareState = requestedTareSamples > 0 ? TARE_PENDING : (success ? TARE_DONE : TARE_FAILED);
+    portEXIT_CRITICAL(&tareLock);
+    
+    for (uint8_t i = 0; i < activeWaiterCount; i++) {
+        activeWaiters[i].callback(success, activeWaiters[i].context);
+    }
+    activeWaiterCount = 0;
 }
 
 void Scale::set_scale(float factor) {
@@ -132,6 +210,7 @@ void Scale::set_scale(float factor) {
     if (calibrationFactor != factor) {
         calibrationFactor = factor;
         hx711.set_scale(calibrationFactor);
+        updateFixedPointScale();
         saveCalibration();
     }
 }
@@ -146,6 +225,72 @@ void Scale::loadCalibration() {
     preferences.begin("scale", true);
     calibrationFactor = preferences.getFloat("calib", calibrationFactor);
     preferences.end();
+    updateFixedPointScale();
+}
+
+void Scale::updateFixedPointScale() {
+    cgScale = centigramScale(calibrationFactor);
+    brewingThresholdCounts = gramsToCounts(brewingThreshold, calibrationFactor);
+    jumpThresholdCounts = gramsToCounts(JUMP_THRESHOLD_G, calibrationFactor);
+}
+
+bool Scale::startAcquisition() {
+    if (acquisitionTask != nullptr) {
+        return true;
+    }
+    
+    rawCursor = rawRing.current();
+    
+    // Pin to the Arduino core above loop() priority so WiFi/BLE/OLED load cannot delay conversions
+    BaseType_t created = xTaskCreatePinnedToCore(acquisitionLoop, "hx711", 3072, this,
+                                                 configMAX_PRIORITIES - 5, &acquisitionTask,
+                                                 ARDUINO_RUNNING_CORE);
+    if (created != pdPASS) {
+        Serial.println("ERROR: Could not start HX711 acquisition task - falling back to polling");
+        acquisitionTask = nullptr;
+        return false;
+    }
+    
+    // HX711 pulls DOUT low when a conversion is ready
+    attachInterruptArg(digitalPinToInterrupt(dataPin), onDataReady, this, FALLING);
+    Serial.println("HX711 acquisition task started (DRDY interrupt on GPIO " + String(dataPin) + ")");
+    return true;
+}
+
+void IRAM_ATTR Scale::onDataReady(void* arg) {
+    Scale* self = static_cast<Scale*>(arg);
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(self->acquisitionTask, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void Scale::acquisitionLoop(void* arg) {
+    Scale* self = static_cast<Scale*>(arg);
+    
+    for (;;) {
+        // Wait for DRDY; the timeout is a safety net in case an edge is ever missed
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(200));
+        
+        while (self->hx711.is_ready()) {
+            RawSample sample;
+            sample.timestampMs = millis();
+            sample.counts = (int32_t)self->hx711.read();
+            
+            // Clocking out the conversion toggles DOUT and fires spurious edges - discard them.
+            // A real DRDY that raced with this is caught by the is_ready() re-check.
+            ulTaskNotifyTake(pdTRUE, 0);
+            
+            // HX711 returns 0 when disconnected - never publish it as a reading
+            if (sample.counts != 0) {
+                self->rawRing.push(sample);
+                if (self->sampleCallback != nullptr) {
+                    self->sampleCallback();
+                }
+            }
+        }
+    }
 }
 
 float Scale::getWeight() {
@@ -154,55 +299,97 @@ float Scale::getWeight() {
         return 0.0f;
     }
     
-    static unsigned long lastReadTime = 0;
-    unsigned long currentTime = millis();
+    if (acquisitionTask == nullptr) {
+        // No acquisition task - poll the HX711 directly
+        if (hx711.is_ready()) {
+            RawSample sample;
+            sample.timestampMs = millis();
+            sample.counts = (int32_t)hx711.read();
+            rawRing.push(sample);
+        }
+    }
+    
+    // Pick up tare requests before draining so their averaging starts with this batch
+    serviceTare();
     
-    // Read at 50Hz (every 20ms) for good responsiveness
-    if (currentTime - lastReadTime < 20) {
-        return currentWeight;
+    // Run every conversion queued since the last call through the filter
+    RawSample sample;
+    while (rawRing.pop(rawCursor, sample, &droppedSamples)) {
+        processSample(sample);
     }
-    lastReadTime = currentTime;
+    
+    return currentWeight;
+}
 
-    // Check if HX711 is ready before attempting to read
-    if (!hx711.is_ready()) {
-        return currentWeight;  // Return last known value if not ready
-    }
+void Scale::processSample(const RawSample& sample) {
+    uint32_t startCycles = ESP.getCycleCount();
+    unsigned long currentTime = sample.timestampMs;
     
-    float rawReading = hx711.get_units(1);
+    // Tare averages conversions captured after the request; the swap applies from this sample on
+    if (tareActive && (long)(currentTime - tareStartTime) >= 0) {
+        tareSum += sample.counts;
+        if (++tareCollected >= tareTarget) {
+            finishTare(true);
+        }
+    }
     
-    // Handle NaN or invalid readings
-    if (isnan(rawReading)) {
-        return currentWeight;
+    // No zero reference yet (first tare still running) or uncalibrated - nothing meaningful to publish
+    if (tareCount == 0 || cgScale.perCountQ24 == 0) {
+        return;
     }
+    int32_t counts = sample.counts - hx711.get_offset();
     
-    // Initialize sample buffer on first valid reading
+    float estimatedFlow = NAN;
     if (!samplesInitialized) {
-        initializeSamples(rawReading);
-        currentWeight = rawReading;
-        lastStableWeight = rawReading;
+        // Initialize sample buffer on first valid reading
+        initializeSamples(counts);
+        kalmanFilter.reset((float)counts / calibrationFactor, currentTime);
+        currentCounts = counts;
+        currentWeightCg = countsToCentigrams(counts, cgScale);
+        lastStableCounts = counts;
         currentFilterState = STABLE;
-        return currentWeight;
+        if (filterMode == FILTER_KALMAN) {
+            estimatedFlow = 0.0f;
+        }
+    } else if (filterMode == FILTER_KALMAN) {
+        // Weight and flow estimated jointly from the raw sample - no second differentiation stage.
+        // The covariance math stays in float; only its output is quantised to centigrams.
+        kalmanFilter.update((float)counts / calibrationFactor, currentTime);
+        currentWeightCg = (int32_t)lroundf(kalmanFilter.weight() * 100.0f);
+        estimatedFlow = kalmanFilter.flow();
+    } else {
+        currentCounts = smartFilter(counts, currentTime);
+        currentWeightCg = countsToCentigrams(currentCounts, cgScale);
     }
+    currentWeight = currentWeightCg / 100.0f;
     
-    // Store reading in circular buffer
-    readings[readingIndex] = rawReading;
-    readingIndex = (readingIndex + 1) % MAX_SAMPLES;
+    weightRing.push({rawCursor, sample.timestampMs, currentWeight, currentWeightCg, estimatedFlow});
     
-    // Smart filtering based on brewing activity detection
-    float weightChange = abs(rawReading - currentWeight);
+    // Track filter cost (1/8 exponential average) for /api/filter-debug
+    uint32_t cycles = ESP.getCycleCount() - startCycles;
+    filterCycles = filterCycles == 0 ? cycles : filterCycles - (filterCycles >> 3) + (cycles >> 3);
+}
+
+int32_t Scale::smartFilter(int32_t counts, unsigned long currentTime) {
+    // Slide both filter windows - O(1) mean, O(log n) search + one memmove for the median
+    int32_t averageCounts = averageWindow.push(counts);
+    int32_t medianCounts = medianWindow.push(counts);
+    
+    // Smart filtering based on brewing activity detection (thresholds pre-scaled to counts)
+    int32_t weightChange = abs(counts - currentCounts);
     bool brewingDetected = false;
     
     // Detect brewing activity using configurable threshold
     if (currentFilterState == STABLE) {
         // Check if weight change exceeds brewing threshold
-        if (weightChange > brewingThreshold) {
+        if (weightChange > brewingThresholdCounts) {
             brewingDetected = true;
             currentFilterState = BREWING;
             lastBrewingActivity = currentTime;
         }
     } else if (currentFilterState == BREWING) {
         // Continue monitoring for brewing activity
-        if (weightChange > brewingThreshold) {
+        if (weightChange > brewingThresholdCounts) {
             brewingDetected = true;
             lastBrewingActivity = currentTime;
         } else {
@@ -213,7 +400,7 @@ float Scale::getWeight() {
         }
     } else if (currentFilterState == TRANSITIONING) {
         // In transition phase - verify stability
-        if (weightChange > brewingThreshold) {
+        if (weightChange > brewingThresholdCounts) {
             // Activity detected again - back to brewing
             brewingDetected = true;
             currentFilterState = BREWING;
@@ -221,29 +408,29 @@ float Scale::getWeight() {
         } else if (currentTime - lastBrewingActivity > stabilityTimeout * 2) {
             // Extended stability confirmed - switch to stable mode
             currentFilterState = STABLE;
-            lastStableWeight = currentWeight;
+            lastStableCounts = currentCounts;
         }
     }
     
     // Apply appropriate filter based on current state
-    float filteredWeight;
+    int32_t filteredCounts = counts;
     switch (currentFilterState) {
         case BREWING:
             // Use median filter during brewing for noise rejection
-            filteredWeight = medianFilter(medianSamples);
+            filteredCounts = medianCounts;
             break;
         case STABLE:
         case TRANSITIONING:
             // Use average filter for stable readings - smoother and faster
-            filteredWeight = averageFilter(averageSamples);
+            filteredCounts = averageCounts;
             break;
     }
     
     // Handle rapid changes (>5g) with immediate response regardless of filter state
-    if (weightChange > 5.0f) {
-        filteredWeight = rawReading;
+    if (weightChange > jumpThresholdCounts) {
+        filteredCounts = counts;
         // Reset sample buffer for immediate response
-        initializeSamples(rawReading);
+        initializeSamples(counts);
         // Update state appropriately
         if (currentFilterState == STABLE) {
             currentFilterState = BREWING;
@@ -251,71 +438,55 @@ float Scale::getWeight() {
         }
     }
     
-    currentWeight = filteredWeight;
-    return currentWeight;
+    return filteredCounts;
 }
 
 float Scale::getCurrentWeight() {
+    WeightSample sample;
+    if (getLatestSample(sample)) {
+        return sample.weight;
+    }
     return currentWeight;
 }
 
-long Scale::getRawValue() {
-    if (!isConnected) {
-        return 0;  // Return 0 if HX711 not connected
+int32_t Scale::getCurrentWeightCg() {
+    WeightSample sample;
+    if (getLatestSample(sample)) {
+        return sample.weightCg;
     }
-    return hx711.get_value(1); // Get raw value from HX711
+    return currentWeightCg;
 }
 
-void Scale::initializeSamples(float initialValue) {
-    for (int i = 0; i < MAX_SAMPLES; i++) {
-        readings[i] = initialValue;
-    }
-    samplesInitialized = true;
+bool Scale::getLatestSample(WeightSample& sample) const {
+    return weightRing.latest(sample);
 }
 
-float Scale::medianFilter(int samples) {
-    if (samples > MAX_SAMPLES) samples = MAX_SAMPLES;
-    
-    // Copy recent readings
-    float temp[samples];
-    for (int i = 0; i < samples; i++) {
-        int idx = (readingIndex - 1 - i + MAX_SAMPLES) % MAX_SAMPLES;
-        temp[i] = readings[idx];
+long Scale::getRawValue() {
+    if (!isConnected) {
+        return 0;  // Return 0 if HX711 not connected
     }
-    
-    // Simple bubble sort for median (efficient for small arrays)
-    for (int i = 0; i < samples - 1; i++) {
-        for (int j = 0; j < samples - i - 1; j++) {
-            if (temp[j] > temp[j + 1]) {
-                float swap = temp[j];
-                temp[j] = temp[j + 1];
-                temp[j + 1] = swap;
-            }
+    if (acquisitionTask != nullptr) {
+        // The acquisition task owns the HX711 - use the latest conversion it captured
+        RawSample sample;
+        if (!rawRing.latest(sample)) {
+            return 0;
         }
+        return sample.counts - hx711.get_offset();
     }
-    return temp[samples / 2]; // Return median
+    return hx711.get_value(1); // Get raw value from HX711
 }
 
-float Scale::averageFilter(int samples) {
-    if (samples > MAX_SAMPLES) samples = MAX_SAMPLES;
-    
-    float sum = 0;
-    int validSamples = 0;
-    
-    // Calculate average of recent samples
-    for (int i = 0; i < samples; i++) {
-        int idx = (readingIndex - 1 - i + MAX_SAMPLES) % MAX_SAMPLES;
-        sum += readings[idx];
-        validSamples++;
-    }
-    
-    return sum / validSamples; // Return simple average without additional smoothing
+void Scale::initializeSamples(int32_t initialCounts) {
+    averageWindow.reset(averageSamples, initialCounts);
+    medianWindow.reset(medianSamples, initialCounts);
+    samplesInitialized = true;
 }
 
 // Filter parameter setters with validation
 void Scale::setBrewingThreshold(float threshold) {
     if (threshold >= 0.05f && threshold <= 1.0f) { // Reasonable bounds
         brewingThreshold = threshold;
+        updateFixedPointScale();
         saveFilterSettings();
     }
 }
@@ -330,6 +501,7 @@ void Scale::setStabilityTimeout(unsigned long timeout) {
 void Scale::setMedianSamples(int samples) {
     if (samples >= 1 && samples <= MAX_SAMPLES) {
         medianSamples = samples;
+        samplesInitialized = false; // Re-prime the window at its new size
         saveFilterSettings();
     }
 }
@@ -337,6 +509,7 @@ void Scale::setMedianSamples(int samples) {
 void Scale::setAverageSamples(int samples) {
     if (samples >= 1 && samples <= MAX_SAMPLES) {
         averageSamples = samples;
+        samplesInitialized = false; // Re-prime the window at its new size
         saveFilterSettings();
     }
 }
@@ -347,6 +520,9 @@ void Scale::saveFilterSettings() {
     preferences.putULong("stab_timeout", stabilityTimeout);
     preferences.putInt("median_samples", medianSamples);
     preferences.putInt("avg_samples", averageSamples);
+    preferences.putUChar("filter_mode", (uint8_t)filterMode);
+    preferences.putFloat("kf_q", kalmanFilter.getProcessNoise());
+    preferences.putFloat("kf_r", kalmanFilter.getMeasurementNoise());
     preferences.end();
     Serial.println("Filter settings saved to EEPROM");
 }
@@ -357,13 +533,46 @@ void Scale::loadFilterSettings() {
     stabilityTimeout = preferences.getULong("stab_timeout", 2000);
     medianSamples = preferences.getInt("median_samples", 3);
     averageSamples = preferences.getInt("avg_samples", 2); // Reduced for faster response
+    filterMode = preferences.getUChar("filter_mode", FILTER_SMART) == FILTER_KALMAN ? FILTER_KALMAN : FILTER_SMART;
+    kalmanFilter.setNoise(preferences.getFloat("kf_q", WeightFlowKalman::Q_DEFAULT), preferences.getFloat("kf_r", WeightFlowKalman::R_DEFAULT));
+}
+
+void Scale::setFilterMode(FilterMode mode) {
+    if (mode != FILTER_SMART && mode != FILTER_KALMAN) {
+        return;
+    }
+    if (filterMode != mode) {
+        filterMode = mode;
+        samplesInitialized = false; // Restart the newly selected filter from the next sample
+        saveFilterSettings();
+    }
+}
+
+void Scale::setKalmanNoise(float processNoise, float measurementNoise) {
+    // Process noise in (g/s^2)^2/s, measurement noise in g^2
+    if (processNoise >= 0.0001f && processNoise <= 10.0f &&
+        measurementNoise >= 0.0001f && measurementNoise <= 1.0f) {
+        kalmanFilter.setNoise(processNoise, measurementNoise);
+        saveFilterSettings();
+    }
+}
+
+float Scale::getEstimatedFlowRate() const {
+    WeightSample sample;
+    if (filterMode == FILTER_KALMAN && weightRing.latest(sample) && !isnan(sample.flowRate)) {
+        return sample.flowRate;
+    }
+    return 0.0f;
 }
 
 void Scale::setFlowRatePtr(FlowRate* flowRatePtr) {
     this->flowRatePtr = flowRatePtr;
 }
 
-String Scale::getFilterState() const {
+const char* Scale::getFilterState() const {
+    if (filterMode == FILTER_KALMAN) {
+        return "KALMAN";
+    }
     switch (currentFilterState) {
         case STABLE: return "STABLE";
         case BREWING: return "BREWING";
@@ -0,0 +1,167 @@
+#include "Scheduler.h"
+#include <esp_timer.h>
+#include "JsonWriter.h"
+
+static const uint32_t JITTER_BUCKET_LIMITS_US[SCHEDULER_JITTER_BUCKETS - 1] = {
+    100, 500, 1000, 2000, 5000, 10000, 50000
+};
+
+Scheduler::Scheduler() : taskCount(0), loopTask(nullptr), pendingNotifications(0) {
+    memset(tasks, 0, sizeof(tasks));
+}
+
+void Scheduler::begin() {
+    loopTask = xTaskGetCurrentTaskHandle();
+
+    // Start every task from a common time base
+    int64_t now = esp_timer_get_time();
+    for (size_t i = 0; i < taskCount; i++) {
+        tasks[i].nextRunUs = now;
+    }
+    Serial.printf("Scheduler started with %u tasks\n", (unsigned)taskCount);
+}
+
+int Scheduler::addTask(const char* name, SchedulerCallback callback, uint32_t periodMs,
+                       uint8_t priority, uint32_t deadlineMs) {
+    if (taskCount >= SCHEDULER_MAX_TASKS || callback == nullptr || periodMs == 0) {
+        Serial.printf("Scheduler: cannot register task '%s'\n", name);
+        return -1;
+    }
+
+    ScheduledTask& task = tasks[taskCount];
+    memset(&task, 0, sizeof(task));
+    task.name = name;
+    task.callback = callback;
+    task.periodUs = periodMs * 1000;
+    task.deadlineUs = deadlineMs * 1000;
+    task.priority = priority;
+    task.nextRunUs = esp_timer_get_time();
+    return (int)taskCount++;
+}
+
+void Scheduler::notify(int taskId) {
+    if (taskId < 0 || taskId >= (int)taskCount || loopTask == nullptr) {
+        return;
+    }
+    xTaskNotify(loopTask, 1UL << taskId, eSetBits);
+}
+
+void Scheduler::runOnce() {
+    int64_t now = esp_timer_get_time();
+
+    // Notified tasks become due immediately
+    uint32_t notified = pendingNotifications;
+    pendingNotifications = 0;
+    for (size_t i = 0; i < taskCount; i++) {
+        if (notified & (1UL << i)) {
+            tasks[i].notifications++;
+            if (tasks[i].nextRunUs > now) {
+                tasks[i].nextRunUs = now;
+            }
+        }
+    }
+
+    // Run due tasks highest priority first. Re-scan after every run so a
+    // high-priority task that became due meanwhile is not starved.
+    for (;;) {
+        int best = -1;
+        now = esp_timer_get_time();
+        for (size_t i = 0; i < taskCount; i++) {
+            if (tasks[i].nextRunUs <= now &&
+                (best < 0 || tasks[i].priority > tasks[best].priority)) {
+                best = (int)i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        runTask(tasks[best], now);
+    }
+
+    // Sleep until the earliest next due time or until someone notifies us
+    int64_t nextDue = INT64_MAX;
+    for (size_t i = 0; i < taskCount; i++) {
+        if (tasks[i].nextRunUs < nextDue) {
+            nextDue = tasks[i].nextRunUs;
+        }
+    }
+    now = esp_timer_get_time();
+    TickType_t waitTicks = 0;
+    if (nextDue > now) {
+        // Round up so we never wake before the task is due
+        waitTicks = (TickType_t)((nextDue - now + (portTICK_PERIOD_MS * 1000) - 1) / (portTICK_PERIOD_MS * 1000));
+    }
+
+    uint32_t bits = 0;
+    if (xTaskNotifyWait(0, UINT32_MAX, &bits, waitTicks) == pdTRUE) {
+        pendingNotifications |= bits;
+    }
+}
+
+void Scheduler::runTask(ScheduledTask& task, int64_t now) {
+    uint32_t jitterUs = (uint32_t)(now - task.nextRunUs);
+    int64_t dueAt = task.nextRunUs;
+
+    task.callback();
+
+    int64_t finished = esp_timer_get_time();
+    uint32_t runUs = (uint32_t)(finished - now);
+
+    task.runs++;
+    task.jitterHistogram[jitterBucket(jitterUs)]++;
+    if (jitterUs > task.maxJitterUs) task.maxJitterUs = jitterUs;
+    if (runUs > task.maxRunUs) task.maxRunUs = runUs;
+    if (task.deadlineUs > 0 && finished - dueAt > (int64_t)task.deadlineUs) {
+        task.overruns++;
+    }
+
+    // Keep the original phase; if whole periods were missed, skip them rather than bursting
+    task.nextRunUs = dueAt + task.periodUs;
+    if (task.nextRunUs <= finished) {
+        uint32_t missed = (uint32_t)((finished - task.nextRunUs) / task.periodUs) + 1;
+        task.skipped += missed;
+        task.nextRunUs += (int64_t)missed * task.periodUs;
+    }
+}
+
+uint8_t Scheduler::jitterBucket(uint32_t jitterUs) {
+    for (uint8_t i = 0; i < SCHEDULER_JITTER_BUCKETS - 1; i++) {
+        if (jitterUs < JITTER_BUCKET_LIMITS_US[i]) {
+            return i;
+        }
+    }
+    return SCHEDULER_JITTER_BUCKETS - 1;
+}
+
+void Scheduler::writeStatsJson(JsonWriter& json) const {
+    json.beginObject();
+    json.beginArray("jitter_buckets_us");
+    for (uint8_t i = 0; i < SCHEDULER_JITTER_BUCKETS - 1; i++) {
+        json.value(JITTER_BUCKET_LIMITS_US[i]);
+    }
+    json.valueNull().endArray();
+
+    json.beginArray("tasks");
+    for (size_t i = 0; i < taskCount; i++) {
+        const ScheduledTask& task = tasks[i];
+        json.beginObject();
+        json.field("name", task.name);
+        json.field("period_ms", task.periodUs / 1000);
+        json.field("deadline_ms", task.deadlineUs / 1000);
+        json.field("priority", task.priority);
+        json.field("runs", task.runs);
+        json.field("overruns", task.overruns);
+        json.field("skipped", task.skipped);
+        json.field("notifications", task.notifications);
+        json.field("max_jitter_us", task.maxJitterUs);
+        json.field("max_run_us", task.maxRunUs);
+        json.beginArray("jitter_histogram");
+        for (uint8_t b = 0; b < SCHEDULER_JITTER_BUCKETS; b++) {
+            json.value(task.jitterHistogram[b]);
+        }
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
@@ -0,0 +1,199 @@
+#include "ShotDetector.h"
+#include "Display.h"
+#include "Scale.h"
+#include <algorithm>
+
+static const int32_t JUMP_CG = (int32_t)(Scale::JUMP_THRESHOLD_G * 100.0f); // Cup placed or lifted
+
+ShotDetector::ShotDetector()
+    : display(nullptr), enabled(false), startFlow(0.5f), startHoldMs(600), stopFlow(0.2f), stopHoldMs(2000),
+      historyHead(0), historyCount(0), candidateSinceMs(0), quietSinceMs(0), autoRunning(false),
+      listenerCount(0), lastEvent(SHOT_EVENT_NONE), lastEventMs(0), lastBackdateMs(0), eventCount(0) {
+}
+
+void ShotDetector::begin() {
+    preferences.begin("shotdetect", true);
+    enabled = preferences.getBool("enabled", false);
+    startFlow = constrain(preferences.getFloat("start_flow", 0.5f), 0.1f, 5.0f);
+    startHoldMs = constrain(preferences.getULong("start_ms", 600), 100UL, 5000UL);
+    stopFlow = constrain(preferences.getFloat("stop_flow", 0.2f), 0.05f, 2.0f);
+    stopHoldMs = constrain(preferences.getULong("stop_ms", 2000), 500UL, 10000UL);
+    preferences.end();
+    Serial.printf("ShotDetector: Auto timer %s (start >%.2fg/s for %lums, stop <%.2fg/s for %lums)\n",
+                  enabled ? "enabled" : "disabled", startFlow, (unsigned long)startHoldMs, stopFlow, (unsigned long)stopHoldMs);
+}
+
+void ShotDetector::setDisplay(Display* displayInstance) {
+    display = displayInstance;
+}
+
+bool ShotDetector::addListener(ShotEventCallback callback, void* context) {
+    if (listenerCount >= SHOT_DETECTOR_MAX_LISTENERS) {
+        return false;
+    }
+    listeners[listenerCount] = callback;
+    listenerContexts[listenerCount] = context;
+    listenerCount++;
+    return true;
+}
+
+void ShotDetector::update(const WeightSample& sample, float flowRate) {
+    history[historyHead] = { sample.timestampMs, sample.weightCg };
+    historyHead = (historyHead + 1) % SHOT_DETECTOR_HISTORY;
+    if (historyCount < SHOT_DETECTOR_HISTORY) {
+        historyCount++;
+    }
+
+    if (!enabled || display == nullptr) {
+        candidateSinceMs = 0;
+        autoRunning = false;
+        return;
+    }
+
+    // Stopped, paused or reset by hand - no longer ours to stop
+    if (autoRunning && !display->isTimerRunning()) {
+        autoRunning = false;
+    }
+
+    if (!autoRunning) {
+        // A manually started timer owns the shot
+        if (display->isTimerRunning()) {
+            candidateSinceMs = 0;
+            return;
+        }
+
+        if (flowRate >= startFlow && flowRate <= MAX_POUR_FLOW) {
+            if (candidateSinceMs == 0) {
+                candidateSinceMs = sample.timestampMs;
+            } else if (sample.timestampMs - candidateSinceMs >= startHoldMs) {
+                int32_t restCg = restLevelCg(candidateSinceMs);
+                uint32_t startMs = restCg == INT32_MAX ? candidateSinceMs : findRiseMs(restCg + DRIP_CG, candidateSinceMs);
+
+                display->startTimerAt(startMs);
+                autoRunning = true;
+                quietSinceMs = 0;
+                candidateSinceMs = 0;
+                lastBackdateMs = millis() - startMs;
+                emit(SHOT_EVENT_START, startMs);
+            }
+        } else {
+            candidateSinceMs = 0;
+        }
+        return;
+    }
+
+    if (flowRate < stopFlow) {
+        if (quietSinceMs == 0) {
+            quietSinceMs = sample.timestampMs;
+        } else if (sample.timestampMs - quietSinceMs >= stopHoldMs) {
+            // Last drip: first sample that already reached the final weight
+            uint32_t stopMs = findRiseMs(sample.weightCg - DRIP_CG, quietSinceMs);
+            display->stopTimerAt(stopMs);
+            autoRunning = false;
+            emit(SHOT_EVENT_STOP, stopMs);
+        }
+    } else {
+        quietSinceMs = 0;
+    }
+}
+
+const ShotDetector::HistoryEntry& ShotDetector::recent(size_t n) const {
+    return history[(historyHead + SHOT_DETECTOR_HISTORY - 1 - n) % SHOT_DETECTOR_HISTORY];
+}
+
+bool ShotDetector::isJump(const HistoryEntry& newer, const HistoryEntry& older) {
+    return abs(newer.weightCg - older.weightCg) > JUMP_CG;
+}
+
+// Median weight over the REST_WINDOW_MS up to beforeMs, not reaching back
+// past a jump. A minimum over the whole history would pick up noise, or the
+// scale before the cup went on. INT32_MAX when there is no such sample.
+int32_t ShotDetector::restLevelCg(uint32_t beforeMs) const {
+    int32_t levels[REST_MAX_SAMPLES];
+    size_t count = 0;
+    for (size_t n = 0; n < historyCount && count < REST_MAX_SAMPLES; n++) {
+        const HistoryEntry& entry = recent(n);
+        if (n > 0 && isJump(recent(n - 1), entry)) {
+            break;
+        }
+        int32_t ageMs = (int32_t)(beforeMs - entry.timestampMs);
+        if (ageMs < 0) {
+            continue; // Inside the candidate run
+        }
+        if (ageMs > (int32_t)REST_WINDOW_MS) {
+            break;
+        }
+        levels[count++] = entry.weightCg;
+    }
+    if (count == 0) {
+        return INT32_MAX;
+    }
+    std::nth_element(levels, levels + count / 2, levels + count);
+    return levels[count / 2];
+}
+
+// Timestamp of the sample right after the newest one at or below levelCg,
+// i.e. where the weight last rose through the level. The search stops at
+// the last jump - the weight was never at the level since the cup went on.
+uint32_t ShotDetector::findRiseMs(int32_t levelCg, uint32_t fallbackMs) const {
+    uint32_t newerMs = fallbackMs;
+    for (size_t n = 0; n < historyCount; n++) {
+        const HistoryEntry& entry = recent(n);
+        if (n > 0 && isJump(recent(n - 1), entry)) {
+            return newerMs;
+        }
+        if (entry.weightCg <= levelCg) {
+            return n == 0 ? entry.timestampMs : newerMs;
+        }
+        newerMs = entry.timestampMs;
+    }
+    // Never at the level inside the history window - the oldest sample is the best estimate
+    return historyCount > 0 ? newerMs : fallbackMs;
+}
+
+void ShotDetector::emit(ShotEvent event, uint32_t eventMs) {
+    lastEvent = event;
+    lastEventMs = eventMs;
+    eventCount++;
+
+    for (size_t i = 0; i < listenerCount; i++) {
+        listeners[i](event, eventMs, listenerContexts[i]);
+    }
+    Serial.printf("ShotDetector: Auto %s at %lums (detected %lums later)\n",
+                  event == SHOT_EVENT_START ? "start" : "stop", (unsigned long)eventMs, (unsigned long)(millis() - eventMs));
+}
+
+void ShotDetector::setEnabled(bool enable) {
+    enabled = enable;
+    saveSettings();
+}
+
+void ShotDetector::setStartFlow(float gramsPerSecond) {
+    startFlow = constrain(gramsPerSecond, 0.1f, 5.0f);
+    saveSettings();
+}
+
+void ShotDetector::setStartHoldMs(uint32_t ms) {
+    startHoldMs = constrain(ms, 100UL, 5000UL);
+    saveSettings();
+}
+
+void ShotDetector::setStopFlow(float gramsPerSecond) {
+    stopFlow = constrain(gramsPerSecond, 0.05f, 2.0f);
+    saveSettings();
+}
+
+void ShotDetector::setStopHoldMs(uint32_t ms) {
+    stopHoldMs = constrain(ms, 500UL, 10000UL);
+    saveSettings();
+}
+
+void ShotDetector::saveSettings() {
+    preferences.begin("shotdetect", false);
+    preferences.putBool("enabled", enabled);
+    preferences.putFloat("start_flow", startFlow);
+    preferences.putULong("start_ms", startHoldMs);
+    preferences.putFloat("stop_flow", stopFlow);
+    preferences.putULong("stop_ms", stopHoldMs);
+    preferences.end();
+}
@@ -0,0 +1,264 @@
+#include "ShotRecorder.h"
+#include <esp_heap_caps.h>
+
+ShotRecorder::ShotRecorder()
+    : records(nullptr), slotCount(0), slotCapacity(0), inPsram(false), pendingCommand(CMD_NONE),
+      pendingStartMs(0), preroll(nullptr), prerollHead(0), prerollCount(0),
+      nextShotId(1), activeSlot(-1), recording(false), encodedMs(0), encodedWeightCg(0) {
+    memset(slots, 0, sizeof(slots));
+    for (size_t i = 0; i < SHOT_HISTORY_SLOTS; i++) {
+        slotIds[i].store(0);
+        slotSamples[i].store(0);
+    }
+}
+
+bool ShotRecorder::begin() {
+    if (records != nullptr) {
+        return true;
+    }
+
+    // Preallocate everything up front - nothing is allocated while recording
+    if (psramFound()) {
+        records = (ShotRecord*)ps_malloc(sizeof(ShotRecord) * SHOT_HISTORY_SLOTS * SHOT_MAX_SAMPLES);
+        if (records != nullptr) {
+            slotCount = SHOT_HISTORY_SLOTS;
+            slotCapacity = SHOT_MAX_SAMPLES;
+            inPsram = true;
+        }
+    }
+    if (records == nullptr) {
+        records = (ShotRecord*)malloc(sizeof(ShotRecord) * SHOT_FALLBACK_SLOTS * SHOT_FALLBACK_SAMPLES);
+        if (records == nullptr) {
+            Serial.println("ShotRecorder: ERROR - could not allocate shot buffer, recording disabled");
+            return false;
+        }
+        slotCount = SHOT_FALLBACK_SLOTS;
+        slotCapacity = SHOT_FALLBACK_SAMPLES;
+        inPsram = false;
+    }
+
+    preroll = (PrerollSample*)(inPsram ? ps_malloc(sizeof(PrerollSample) * SHOT_PREROLL_SAMPLES)
+                                       : malloc(sizeof(PrerollSample) * SHOT_PREROLL_SAMPLES));
+    if (preroll == nullptr) {
+        Serial.println("ShotRecorder: Warning - no pre-roll buffer, backdated shots start at detection");
+    }
+
+    Serial.printf("ShotRecorder: %u shots x %u samples (%u bytes) in %s\n",
+                  (unsigned)slotCount, (unsigned)slotCapacity,
+                  (unsigned)(sizeof(ShotRecord) * slotCount * slotCapacity), inPsram ? "PSRAM" : "heap");
+    return true;
+}
+
+void ShotRecorder::startShot(uint32_t startMs) {
+    pendingStartMs.store(startMs);
+    pendingCommand.store(CMD_START);
+}
+
+void ShotRecorder::resumeShot() {
+    pendingCommand.store(CMD_RESUME);
+}
+
+void ShotRecorder::stopShot() {
+    pendingCommand.store(CMD_STOP);
+}
+
+void ShotRecorder::update() {
+    uint8_t command = pendingCommand.exchange(CMD_NONE);
+    if (command == CMD_NONE || records == nullptr) {
+        return;
+    }
+
+    switch (command) {
+        case CMD_START:
+            if (recording) {
+                finishShot();
+            }
+            {
+                uint32_t startMs = pendingStartMs.exchange(0);
+                beginShot(startMs != 0 ? startMs : millis());
+            }
+            break;
+
+        case CMD_RESUME:
+            // Continue the shot the timer paused, as long as it is still the newest one
+            if (!recording && activeSlot >= 0 && slotIds[activeSlot].load() == nextShotId - 1) {
+                slots[activeSlot].complete = false;
+                recording = true;
+            } else if (!recording) {
+                beginShot(millis());
+            }
+            break;
+
+        case CMD_STOP:
+            if (recording) {
+                finishShot();
+            }
+            break;
+    }
+}
+
+void ShotRecorder::beginShot(uint32_t now) {
+    uint32_t id = nextShotId++;
+    int slot = (int)(id % slotCount);
+
+    // Invalidate the slot first so readers of the shot being overwritten notice
+    slotIds[slot].store(0, std::memory_order_release);
+    slotSamples[slot].store(0, std::memory_order_release);
+
+    ShotInfo& info = slots[slot];
+    info.id = id;
+    info.startMs = now;
+    info.startWeightCg = 0;
+    info.finalWeightCg = 0;
+    info.durationMs = 0;
+    info.samples = 0;
+    info.complete = false;
+    info.truncated = false;
+    slotIds[slot].store(id, std::memory_order_release);
+
+    activeSlot = slot;
+    recording = true;
+    encodedMs = now;
+
+    // A backdated start already went past - replay what the pre-roll kept of it
+    size_t replayed = 0;
+    for (size_t n = 0; n < prerollCount; n++) {
+        const PrerollSample& sample = preroll[(prerollHead + SHOT_PREROLL_SAMPLES - prerollCount + n) % SHOT_PREROLL_SAMPLES];
+        if ((int32_t)(sample.timestampMs - now) >= 0) {
+            appendRecord(sample.timestampMs, sample.weightCg, sample.flowRate);
+            replayed++;
+        }
+    }
+    prerollCount = 0;
+
+    Serial.printf("ShotRecorder: Recording shot %u (%u pre-roll samples)\n", (unsigned)id, (unsigned)replayed);
+}
+
+void ShotRecorder::finishShot() {
+    recording = false;
+    if (activeSlot < 0) {
+        return;
+    }
+    ShotInfo& info = slots[activeSlot];
+    info.complete = true;
+    Serial.printf("ShotRecorder: Shot %u finished - %u samples, %.1fs, %.2fg%s\n",
+                  (unsigned)info.id, (unsigned)info.samples, info.durationMs / 1000.0f,
+                  info.finalWeightCg / 100.0f, info.truncated ? " (truncated)" : "");
+}
+
+void ShotRecorder::addSample(uint32_t timestampMs, int32_t weightCg, float flowRate) {
+    if (!recording || activeSlot < 0) {
+        if (preroll != nullptr) {
+            preroll[prerollHead] = { timestampMs, weightCg, flowRate };
+            prerollHead = (prerollHead + 1) % SHOT_PREROLL_SAMPLES;
+            prerollCount = min(prerollCount + 1, (size_t)SHOT_PREROLL_SAMPLES);
+        }
+        return;
+    }
+    appendRecord(timestampMs, weightCg, flowRate);
+}
+
+void ShotRecorder::appendRecord(uint32_t timestampMs, int32_t weightCg, float flowRate) {
+    ShotInfo& info = slots[activeSlot];
+
+    // Samples captured before the timer started belong to no shot
+    if ((int32_t)(timestampMs - encodedMs) < 0) {
+        return;
+    }
+    if (info.samples >= slotCapacity) {
+        info.truncated = true;
+        return;
+    }
+    if (info.samples == 0) {
+        info.startWeightCg = weightCg;
+        encodedWeightCg = weightCg;
+    }
+
+    ShotRecord record;
+    uint32_t dt = timestampMs - encodedMs;
+    record.dtMs = dt > UINT16_MAX ? UINT16_MAX : (uint16_t)dt;
+    int32_t dWeight = constrain(weightCg - encodedWeightCg, INT16_MIN, INT16_MAX);
+    record.dWeightCg = (int16_t)dWeight;
+    int32_t flow = (int32_t)lroundf(flowRate * 100.0f);
+    record.flowCgps = (int16_t)constrain(flow, INT16_MIN, INT16_MAX);
+
+    encodedMs += record.dtMs;
+    encodedWeightCg += record.dWeightCg;
+
+    records[(size_t)activeSlot * slotCapacity + info.samples] = record;
+    info.samples++;
+    info.finalWeightCg = encodedWeightCg;
+    info.durationMs = encodedMs - info.startMs;
+    slotSamples[activeSlot].store(info.samples, std::memory_order_release);
+}
+
+bool ShotRecorder::getShotBySlot(size_t slot, ShotInfo& info) const {
+    if (slot >= slotCount) {
+        return false;
+    }
+    uint32_t id = slotIds[slot].load(std::memory_order_acquire);
+    if (id == 0) {
+        return false;
+    }
+    info = slots[slot];
+    info.samples = slotSamples[slot].load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slotIds[slot].load(std::memory_order_relaxed) == id && info.id == id;
+}
+
+bool ShotRecorder::getLatestShot(ShotInfo& info) const {
+    bool found = false;
+    ShotInfo candidate;
+    for (size_t i = 0; i < slotCount; i++) {
+        if (getShotBySlot(i, candidate) && candidate.complete && (!found || candidate.id > info.id)) {
+            info = candidate;
+            found = true;
+        }
+    }
+    return found;
+}
+
+int ShotRecorder::findSlot(uint32_t shotId) const {
+    if (shotId == 0 || slotCount == 0) {
+        return -1;
+    }
+    int slot = (int)(shotId % slotCount);
+    return slotIds[slot].load(std::memory_order_acquire) == shotId ? slot : -1;
+}
+
+bool ShotRecorder::getShot(uint32_t shotId, ShotInfo& info) const {
+    int slot = findSlot(shotId);
+    return slot >= 0 && getShotBySlot(slot, info) && info.id == shotId;
+}
+
+bool ShotRecorder::readRecords(uint32_t shotId, uint32_t first, ShotRecord* out, size_t count) const {
+    int slot = findSlot(shotId);
+    if (slot < 0 || first + count > slotSamples[slot].load(std::memory_order_acquire)) {
+        return false;
+    }
+    memcpy(out, &records[(size_t)slot * slotCapacity + first], count * sizeof(ShotRecord));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slotIds[slot].load(std::memory_order_relaxed) == shotId;
+}
+
+bool ShotRecorder::decodeBase(uint32_t shotId, uint32_t index, uint32_t& timeMs, int32_t& weightCg) const {
+    ShotInfo info;
+    if (!getShot(shotId, info) || index > info.samples) {
+        return false;
+    }
+    timeMs = 0;
+    weightCg = info.startWeightCg;
+
+    ShotRecord batch[32];
+    for (uint32_t i = 0; i < index; i += 32) {
+        size_t count = min((uint32_t)32, index - i);
+        if (!readRecords(shotId, i, batch, count)) {
+            return false;
+        }
+        for (size_t k = 0; k < count; k++) {
+            timeMs += batch[k].dtMs;
+            weightCg += batch[k].dWeightCg;
+        }
+    }
+    return true;
+}
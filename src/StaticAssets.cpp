@@ -0,0 +1,128 @@
+#include "StaticAssets.h"
+#include "JsonWriter.h"
+
+static const char* MANIFEST_PATH = "/assets.manifest";
+static const char* CACHE_IMMUTABLE = "public, max-age=31536000, immutable"; // ?v= matches the content
+static const char* CACHE_REVALIDATE = "no-cache";                           // Pages and unversioned URLs
+
+StaticAssets::StaticAssets(fs::FS& fs) : fs(fs), assetCount(0), served(0), notModified(0), bytesSent(0) {
+}
+
+bool StaticAssets::begin() {
+    File manifest = fs.open(MANIFEST_PATH, "r");
+    if (!manifest) {
+        Serial.println("Static assets: no manifest, serving plain files");
+        return false;
+    }
+    assetCount = 0;
+    uint32_t total = 0;
+    while (manifest.available() && assetCount < MAX_ASSETS) {
+        String line = manifest.readStringUntil('\n');
+        Asset& asset = assets[assetCount];
+        char encoding = '-';
+        unsigned long size = 0;
+        if (sscanf(line.c_str(), "%39s %15s %c %lu", asset.path, asset.etag, &encoding, &size) != 4) {
+            continue;
+        }
+        asset.gzip = encoding == 'g';
+        asset.size = size;
+        total += size;
+        assetCount++;
+    }
+    manifest.close();
+    Serial.printf("Static assets: %u files, %lu bytes\n", (unsigned)assetCount, (unsigned long)total);
+    return assetCount > 0;
+}
+
+const StaticAssets::Asset* StaticAssets::find(const String& url) const {
+    const char* path = url == "/" ? "/index.html" : url.c_str();
+    for (size_t i = 0; i < assetCount; i++) {
+        if (strcmp(assets[i].path, path) == 0) {
+            return &assets[i];
+        }
+    }
+    return nullptr;
+}
+
+const char* StaticAssets::contentType(const char* path) {
+    static const struct { const char* extension; const char* type; } TYPES[] = {
+        { ".html", "text/html" },
+        { ".css", "text/css" },
+        { ".js", "application/javascript" },
+        { ".json", "application/json" },
+        { ".svg", "image/svg+xml" },
+        { ".png", "image/png" },
+        { ".ico", "image/x-icon" },
+        { ".woff2", "font/woff2" },
+    };
+    const char* extension = strrchr(path, '.');
+    if (extension != nullptr) {
+        for (size_t i = 0; i < sizeof(TYPES) / sizeof(TYPES[0]); i++) {
+            if (strcmp(extension, TYPES[i].extension) == 0) {
+                return TYPES[i].type;
+            }
+        }
+    }
+    return "application/octet-stream";
+}
+
+bool StaticAssets::canHandle(AsyncWebServerRequest* request) {
+    if (request->method() != HTTP_GET || find(request->url()) == nullptr) {
+        return false;
+    }
+    request->addInterestingHeader("If-None-Match");
+    return true;
+}
+
+void StaticAssets::handleRequest(AsyncWebServerRequest* request) {
+    const Asset* asset = find(request->url());
+    if (asset == nullptr) {
+        request->send(404);
+        return;
+    }
+    sendAsset(request, *asset);
+}
+
+bool StaticAssets::send(AsyncWebServerRequest* request, const char* path) {
+    const Asset* asset = find(path);
+    if (asset == nullptr) {
+        return false;
+    }
+    sendAsset(request, *asset);
+    return true;
+}
+
+void StaticAssets::sendAsset(AsyncWebServerRequest* request, const Asset& asset) {
+    char etag[ETAG_SIZE + 2];
+    snprintf(etag, sizeof(etag), "\"%s\"", asset.etag);
+    bool versioned = request->hasParam("v") && request->getParam("v")->value() == asset.etag;
+
+    AsyncWebServerResponse* response;
+    AsyncWebHeader* ifNoneMatch = request->getHeader("If-None-Match");
+    if (ifNoneMatch != nullptr && ifNoneMatch->value().indexOf(etag) >= 0) {
+        response = request->beginResponse(304);
+        notModified++;
+    } else {
+        // Every browser accepts gzip, so the stored encoding is sent as is
+        char storedPath[PATH_SIZE + 4];
+        snprintf(storedPath, sizeof(storedPath), "%s%s", asset.path, asset.gzip ? ".gz" : "");
+        response = request->beginResponse(fs, storedPath, contentType(asset.path));
+        if (asset.gzip) {
+            response->addHeader("Content-Encoding", "gzip");
+        }
+        served++;
+        bytesSent += asset.size;
+    }
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", versioned ? CACHE_IMMUTABLE : CACHE_REVALIDATE);
+    request->send(response);
+}
+
+void StaticAssets::writeStatsJson(JsonWriter& json) const {
+    json.beginObject();
+    json.field("assets", assetCount);
+    json.field("served", served);
+    json.field("not_modified", notModified);
+    json.field("bytes_sent", bytesSent);
+    json.endObject();
+}
@@ -0,0 +1,193 @@
+#include "StopTrigger.h"
+#include "Scale.h"
+
+StopTrigger::StopTrigger()
+    : requestedTarget(NO_REQUEST), state(STOP_IDLE), targetCg(0), dripMs(DEFAULT_DRIP_MS),
+      listenerCount(0), primed(false), flowActive(false), flowSinceMs(0),
+      jumpCg((int32_t)lroundf(Scale::JUMP_THRESHOLD_G * 100.0f)), lastWeightCg(0), hasLastWeight(false),
+      jumpSettling(false), jumpMs(0), fireMs(0), fireWeightCg(0), fireFlow(0.0f), peakWeightCg(0),
+      settledSinceMs(0), lastTargetCg(0), lastFireWeightCg(0), lastFinalWeightCg(0), fireCount(0) {
+}
+
+void StopTrigger::begin() {
+    preferences.begin("stoptrigger", true);
+    dripMs = min((uint32_t)preferences.getULong("drip_ms", DEFAULT_DRIP_MS), (uint32_t)MAX_DRIP_MS);
+    preferences.end();
+    Serial.printf("StopTrigger: Learned drip time %.2fs\n", dripMs / 1000.0f);
+}
+
+void StopTrigger::setTarget(int32_t target) {
+    requestedTarget.store(target > 0 ? target : 0);
+}
+
+bool StopTrigger::addListener(StopCallback callback, void* context) {
+    if (listenerCount >= STOP_TRIGGER_MAX_LISTENERS) {
+        return false;
+    }
+    listeners[listenerCount] = callback;
+    listenerContexts[listenerCount] = context;
+    listenerCount++;
+    return true;
+}
+
+const char* StopTrigger::getStateName() const {
+    switch (state.load()) {
+        case STOP_ARMED: return "armed";
+        case STOP_SETTLING: return "settling";
+        case STOP_DONE: return "done";
+        default: return "idle";
+    }
+}
+
+void StopTrigger::rearm(bool isPrimed) {
+    primed = isPrimed;
+    flowActive = false;
+    flowSinceMs = 0;
+}
+
+void StopTrigger::update(const WeightSample& sample, float flowRate, bool timerRunning) {
+    int32_t request = requestedTarget.exchange(NO_REQUEST);
+    if (request != NO_REQUEST) {
+        targetCg = request;
+        rearm(false);
+        state.store(request > 0 ? STOP_ARMED : STOP_IDLE);
+        if (request > 0) {
+            Serial.printf("StopTrigger: Target %.2fg armed\n", request / 100.0f);
+        } else {
+            Serial.println("StopTrigger: Target cleared");
+        }
+    }
+
+    int32_t weightCg = sample.weightCg;
+    bool jumped = hasLastWeight && abs(weightCg - lastWeightCg) > jumpCg;
+    lastWeightCg = weightCg;
+    hasLastWeight = true;
+    if (jumped) {
+        jumpSettling = true;
+        jumpMs = sample.timestampMs;
+    } else if (jumpSettling && sample.timestampMs - jumpMs >= JUMP_SETTLE_MS) {
+        jumpSettling = false;
+    }
+
+    switch (state.load()) {
+        case STOP_IDLE:
+            break;
+
+        case STOP_ARMED: {
+            // A cup placed or lifted bypasses the filters and throws the flow
+            // estimate - wait for it to settle, then the weight has to drop
+            // below the target again (a tare) before this can fire
+            if (jumped) {
+                rearm(false);
+            }
+            if (jumpSettling) {
+                break;
+            }
+            // Don't fire on a cup that is already past the target when the target arrives
+            if (!primed) {
+                primed = weightCg < targetCg / 4;
+                break;
+            }
+            // Only during a shot: the timer is running or flow has held for a while
+            if (flowRate >= ACTIVE_FLOW) {
+                if (flowSinceMs == 0) {
+                    flowSinceMs = sample.timestampMs;
+                } else if (sample.timestampMs - flowSinceMs >= ACTIVE_FLOW_MS) {
+                    flowActive = true;
+                }
+            } else {
+                flowSinceMs = 0;
+            }
+            if (!timerRunning && !flowActive) {
+                break;
+            }
+            // Predict where the weight ends up if the stop went out now: lag since the
+            // sample was taken plus everything that still lands after the stop signal
+            float lookaheadS = (millis() - sample.timestampMs + dripMs) / 1000.0f;
+            int32_t predictedCg = weightCg + (int32_t)lroundf(max(flowRate, 0.0f) * lookaheadS * 100.0f);
+            if (predictedCg >= targetCg) {
+                fire(sample, flowRate);
+            }
+            break;
+        }
+
+        case STOP_SETTLING:
+            peakWeightCg = max(peakWeightCg, weightCg);
+            if (peakWeightCg - weightCg > CUP_REMOVED_CG) {
+                Serial.println("StopTrigger: Cup removed before settling - not learning from this shot");
+                state.store(STOP_DONE);
+            } else if (sample.timestampMs - fireMs > SETTLE_TIMEOUT_MS) {
+                Serial.println("StopTrigger: Flow did not settle - not learning from this shot");
+                state.store(STOP_DONE);
+            } else if (fabsf(flowRate) < SETTLED_FLOW) {
+                if (settledSinceMs == 0) {
+                    settledSinceMs = sample.timestampMs;
+                } else if (sample.timestampMs - settledSinceMs >= SETTLED_HOLD_MS) {
+                    learn(weightCg);
+                    state.store(STOP_DONE);
+                }
+            } else {
+                settledSinceMs = 0;
+            }
+            break;
+
+        case STOP_DONE:
+            // Next shot: cup removed or scale tared
+            if (!jumpSettling && weightCg < targetCg / 4) {
+                rearm(true);
+                state.store(STOP_ARMED);
+            }
+            break;
+    }
+}
+
+void StopTrigger::fire(const WeightSample& sample, float flowRate) {
+    fireMs = sample.timestampMs;
+    fireWeightCg = sample.weightCg;
+    fireFlow = flowRate;
+    peakWeightCg = sample.weightCg;
+    settledSinceMs = 0;
+    lastTargetCg = targetCg;
+    lastFireWeightCg = sample.weightCg;
+    fireCount++;
+    state.store(STOP_SETTLING);
+
+    // Notify first, log after - this is the latency-critical moment
+    for (size_t i = 0; i < listenerCount; i++) {
+        listeners[i](sample.weightCg, targetCg, listenerContexts[i]);
+    }
+    Serial.printf("StopTrigger: STOP at %.2fg (target %.2fg, flow %.2fg/s, drip %.2fs)\n",
+                  sample.weightCg / 100.0f, targetCg / 100.0f, flowRate, dripMs / 1000.0f);
+}
+
+void StopTrigger::learn(int32_t finalWeightCg) {
+    lastFinalWeightCg = finalWeightCg;
+    Serial.printf("StopTrigger: Settled at %.2fg (target %.2fg, overshoot %+.2fg)\n",
+                  finalWeightCg / 100.0f, lastTargetCg / 100.0f, (finalWeightCg - lastTargetCg) / 100.0f);
+
+    if (fireFlow < MIN_LEARN_FLOW) {
+        return;
+    }
+
+    // Seconds of the flow at fire time that still landed afterwards
+    float observedS = (finalWeightCg - fireWeightCg) / 100.0f / fireFlow;
+    float observedMs = constrain(observedS * 1000.0f, 0.0f, (float)MAX_DRIP_MS);
+    uint32_t learned = (uint32_t)lroundf(dripMs + DRIP_LEARN_RATE * (observedMs - dripMs));
+    if (learned == dripMs) {
+        return;
+    }
+    dripMs = learned;
+
+    // Once per shot; the acquisition task keeps buffering samples while NVS writes
+    preferences.begin("stoptrigger", false);
+    preferences.putULong("drip_ms", dripMs);
+    preferences.end();
+    Serial.printf("StopTrigger: Drip time learned %.2fs (observed %.2fs)\n", dripMs / 1000.0f, observedS);
+}
+
+void StopTrigger::resetLearning() {
+    dripMs = DEFAULT_DRIP_MS;
+    preferences.begin("stoptrigger", false);
+    preferences.putULong("drip_ms", dripMs);
+    preferences.end();
+}
@@ -0,0 +1,67 @@
+#include "TelemetryPublisher.h"
+#include "Scale.h"
+#include "FlowRate.h"
+#include "Display.h"
+#include "BatteryMonitor.h"
+#include "ShotDetector.h"
+#include "BluetoothScale.h"
+#include "WiFiManager.h"
+
+TelemetryPublisher::TelemetryPublisher(Scale* scale, FlowRate* flowRate, Display* display, BatteryMonitor* battery,
+                                       ShotDetector* shotDetector, BluetoothScale* bluetoothScale)
+    : scale(scale), flowRate(flowRate), display(display), battery(battery), shotDetector(shotDetector),
+      bluetoothScale(bluetoothScale), next(), lastStatusMs(0) {
+    next.filterState = "UNKNOWN";
+    next.batteryStatus = "Unknown";
+    next.wifiSignalQuality = "Disconnected";
+}
+
+void TelemetryPublisher::refreshStatus(uint32_t now) {
+    lastStatusMs = now;
+    next.batteryVoltage = battery->getBatteryVoltage();
+    next.batteryPercentage = battery->getBatteryPercentage();
+    next.batterySegments = battery->getBatterySegments();
+    next.batteryLow = battery->isLowBattery();
+    next.batteryCritical = battery->isCriticalBattery();
+    next.batteryCharging = battery->isCharging();
+    next.batteryStatus = battery->getBatteryStatus();
+    next.wifiSignal = getWiFiSignalStrength();
+    next.wifiSignalQuality = getWiFiSignalQuality();
+    next.bluetoothConnected = bluetoothScale->isConnected();
+    next.bluetoothSignal = bluetoothScale->getBluetoothSignalStrength();
+    next.bluetoothConnections = bluetoothScale->getConnectionCount();
+}
+
+const TelemetrySnapshot& TelemetryPublisher::publish() {
+    uint32_t now = millis();
+    if (next.sequence == 0 || now - lastStatusMs >= STATUS_INTERVAL_MS) {
+        refreshStatus(now);
+    }
+
+    // Weight and its sample metadata from the same ring entry
+    WeightSample sample;
+    if (scale->getLatestSample(sample)) {
+        next.weightCg = sample.weightCg;
+        next.sampleMs = sample.timestampMs;
+        next.sampleSequence = sample.sequence;
+    } else {
+        next.weightCg = scale->getCurrentWeightCg();
+    }
+    float flow = flowRate->getFlowRate();
+    next.flowRate = isnan(flow) ? 0.0f : flow;
+    next.scaleConnected = scale->isHX711Connected();
+    next.filterStateCode = scale->getFilterStateCode();
+    next.filterState = scale->getFilterState();
+
+    next.timerRunning = display->isTimerRunning();
+    next.timerAuto = shotDetector->isAutoRunning();
+    next.timerElapsedMs = display->getElapsedTime();
+    next.hasTimerAverage = flowRate->hasTimerAverage();
+    next.timerAverageFlowRate = next.hasTimerAverage ? flowRate->getTimerAverageFlowRate() : 0.0f;
+    next.shotEventSeq = shotDetector->getEventCount();
+
+    next.sequence++;
+    next.publishedMs = now;
+    snapshots.write(next);
+    return next;
+}
@@ -0,0 +1,168 @@
+#include "TelemetryStream.h"
+
+static const float ACTIVE_FLOW = 0.3f; // g/s - above this frames follow the sensor rate
+
+TelemetryStream::TelemetryStream(TelemetryPublisher& telemetry)
+    : telemetry(telemetry), events("/api/events"), lastWakeMs(0), fullPending(true), weightCg(0), flowDg(0),
+      scaleConnected(false), timerRunning(false), timerAuto(false), timerElapsedMs(0), timerAvgCg(-1),
+      shotEventSeq(0), batteryPercentage(0), batteryLow(false), batteryCritical(false), wifiSignal(0),
+      bluetoothConnected(false), bluetoothSignal(0), lastFrameMs(0), lastCheckMs(0), frameOut(frame, FRAME_SIZE),
+      framesSent(0), fullFrames(0), heartbeats(0), framesSkipped(0), bytesSent(0) {
+}
+
+void TelemetryStream::attach(AsyncWebServer& server) {
+    events.onConnect([this](AsyncEventSourceClient* client) {
+        // async_tcp task - the next flush sends the full frame
+        client->send("{}", "t", 0, RECONNECT_MS);
+        fullPending = true;
+
+        // Replaces the poll and disconnect handlers the event source client
+        // just installed on its connection, and still runs them, so its poll
+        // also flushes and a closed tab leaves the waker
+        AsyncClient* connection = client->client();
+        int slot = waker.add(connection);
+        connection->onPoll([this, client](void*, AsyncClient*) {
+            flush();
+            client->_onPoll();
+        });
+        connection->onDisconnect([this, client, slot](void*, AsyncClient* closed) {
+            waker.remove(slot);
+            client->_onDisconnect(); // Deletes the event source client
+            delete closed;
+        });
+    });
+    server.addHandler(&events);
+}
+
+void TelemetryStream::wake(const TelemetrySnapshot& snapshot) {
+    if (waker.empty()) {
+        return;
+    }
+    uint32_t now = millis();
+    bool active = snapshot.timerRunning || fabsf(snapshot.flowRate) >= ACTIVE_FLOW;
+    if (!active && now - lastWakeMs < IDLE_INTERVAL_MS) {
+        return; // Idle - the connection poll covers heartbeats and slow changes
+    }
+    lastWakeMs = now;
+    waker.wake();
+}
+
+void TelemetryStream::flush() {
+    if (events.count() == 0) {
+        return;
+    }
+    TelemetrySnapshot snapshot;
+    telemetry.read(snapshot);
+    uint32_t now = millis();
+    bool full = fullPending; // Full frames bypass both limits below
+    fullPending = false;
+    bool active = snapshot.timerRunning || fabsf(snapshot.flowRate) >= ACTIVE_FLOW;
+
+    if (!full && !active && now - lastCheckMs < IDLE_INTERVAL_MS) {
+        return;
+    }
+    // A slow tab holds everyone back - skip, the changes go out with the next frame
+    if (!full && events.avgPacketsWaiting() > MAX_WAITING_PACKETS) {
+        framesSkipped++;
+        return;
+    }
+    lastCheckMs = now;
+
+    frameOut.clear();
+    JsonWriter json(frameOut);
+    json.beginObject();
+
+    if (full || snapshot.weightCg != weightCg) {
+        weightCg = snapshot.weightCg;
+        json.fieldCentigrams("weight", weightCg, 2);
+    }
+    int32_t flowTenths = lroundf(snapshot.flowRate * 10.0f);
+    if (full || flowTenths != flowDg) {
+        flowDg = flowTenths;
+        json.field("flowrate", flowTenths / 10.0, 1);
+    }
+    if (full || snapshot.scaleConnected != scaleConnected) {
+        scaleConnected = snapshot.scaleConnected;
+        json.field("scale_connected", scaleConnected);
+    }
+
+    if (full || snapshot.timerRunning != timerRunning) {
+        timerRunning = snapshot.timerRunning;
+        json.field("timer_running", timerRunning);
+    }
+    if (full || snapshot.timerAuto != timerAuto) {
+        timerAuto = snapshot.timerAuto;
+        json.field("timer_auto", timerAuto);
+    }
+    if (full || snapshot.timerElapsedMs != timerElapsedMs) {
+        timerElapsedMs = snapshot.timerElapsedMs;
+        json.field("timer_elapsed", timerElapsedMs);
+    }
+    int32_t average = snapshot.hasTimerAverage ? lroundf(snapshot.timerAverageFlowRate * 100.0f) : -1;
+    if (full || average != timerAvgCg) {
+        timerAvgCg = average;
+        if (average < 0) {
+            json.fieldNull("timer_avg_flowrate");
+        } else {
+            json.field("timer_avg_flowrate", average / 100.0, 2);
+        }
+    }
+    if (full || snapshot.shotEventSeq != shotEventSeq) {
+        shotEventSeq = snapshot.shotEventSeq;
+        json.field("shot_event_seq", shotEventSeq);
+    }
+
+    // Slow-moving status - the publisher refreshes these about once a second
+    if (full || snapshot.batteryPercentage != batteryPercentage || snapshot.batteryLow != batteryLow ||
+        snapshot.batteryCritical != batteryCritical) {
+        batteryPercentage = snapshot.batteryPercentage;
+        batteryLow = snapshot.batteryLow;
+        batteryCritical = snapshot.batteryCritical;
+        json.field("battery_percentage", batteryPercentage);
+        json.field("battery_low", batteryLow);
+        json.field("battery_critical", batteryCritical);
+    }
+    if (full || snapshot.wifiSignal != wifiSignal) {
+        wifiSignal = snapshot.wifiSignal;
+        json.field("wifi_signal_strength", wifiSignal);
+        json.field("wifi_signal_quality", snapshot.wifiSignalQuality);
+    }
+    if (full || snapshot.bluetoothConnected != bluetoothConnected || snapshot.bluetoothSignal != bluetoothSignal) {
+        bluetoothConnected = snapshot.bluetoothConnected;
+        bluetoothSignal = snapshot.bluetoothSignal;
+        json.field("bluetooth_connected", bluetoothConnected);
+        json.field("bluetooth_signal_strength", bluetoothSignal);
+    }
+
+    bool heartbeat = json.getLength() == 1;
+    if (heartbeat && now - lastFrameMs < HEARTBEAT_MS) {
+        return; // Nothing changed
+    }
+    json.endObject();
+    if (frameOut.overflowed()) {
+        framesSkipped++; // Never happens with the current field set - resend everything next time
+        fullPending = true;
+        return;
+    }
+
+    events.send(frame, "t", 0);
+    lastFrameMs = now;
+    framesSent++;
+    fullFrames += full ? 1 : 0;
+    heartbeats += heartbeat ? 1 : 0;
+    bytesSent += frameOut.length();
+}
+
+void TelemetryStream::writeStatsJson(JsonWriter& json) const {
+    json.beginObject();
+    json.field("clients", (unsigned long)events.count());
+    json.field("frames", framesSent);
+    json.field("full_frames", fullFrames);
+    json.field("heartbeats", heartbeats);
+    json.field("skipped", framesSkipped);
+    json.field("bytes_encoded", bytesSent);
+    json.field("avg_frame_bytes", framesSent > 0 ? bytesSent / framesSent : 0);
+    json.key("wake");
+    waker.writeStatsJson(json);
+    json.endObject();
+}
@@ -111,8 +111,8 @@ void TouchSensor::handleTouch() {
             displayPtr->showTaringMessage();
         }
         
-        scalePtr->tare();
-        Serial.println("Scale tared successfully");
+        // Tare completes in the background - onTareComplete shows the result
+        scalePtr->requestTare(20, onTareComplete, this);
         
         // Reset timer when manual tare is pressed
         if (displayPtr != nullptr) {
@@ -125,16 +125,25 @@ void TouchSensor::handleTouch() {
             flowRatePtr->resetTimerAveraging();
             Serial.println("Flow rate averaging reset for fresh brew");
         }
-        
-        // Show completion message on display if available
-        if (displayPtr != nullptr) {
-            displayPtr->showTaredMessage();
-        }
     } else {
         Serial.println("Error: Scale pointer is null");
     }
 }
 
+void TouchSensor::onTareComplete(bool success, void* context) {
+    TouchSensor* self = static_cast<TouchSensor*>(context);
+    if (!success) {
+        Serial.println("Touch tare failed");
+        return;
+    }
+    Serial.println("Scale tared successfully");
+    
+    // Show completion message on display if available
+    if (self->displayPtr != nullptr) {
+        self->displayPtr->showTaredMessage();
+    }
+}
+
 void TouchSensor::scheduleDelayedTare() {
     Serial.println("Touch detected - showing taring message immediately");
     
@@ -156,8 +165,8 @@ void TouchSensor::checkDelayedTare() {
         
         // Perform the actual tare operation without showing message again
         if (scalePtr != nullptr) {
-            scalePtr->tare();
-            Serial.println("Scale tared successfully");
+            // Tare completes in the background - onTareComplete shows the result
+            scalePtr->requestTare(20, onTareComplete, this);
             
             // Reset timer when manual tare is pressed
             if (displayPtr != nullptr) {
@@ -170,11 +179,6 @@ void TouchSensor::checkDelayedTare() {
                 flowRatePtr->resetTimerAveraging();
                 Serial.println("Flow rate averaging reset for fresh brew");
             }
-            
-            // Show completion message on display if available
-            if (displayPtr != nullptr) {
-                displayPtr->showTaredMessage();
-            }
         } else {
             Serial.println("Error: Scale pointer is null");
         }
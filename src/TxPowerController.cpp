@@ -0,0 +1,130 @@
+#include "TxPowerController.h"
+#include "JsonWriter.h"
+
+// Capped at +6 dBm - full power on the battery rail is what the boot-time 0 dBm setting avoids
+static const esp_power_level_t POWER_LEVELS[] = {
+    ESP_PWR_LVL_N12, ESP_PWR_LVL_N9, ESP_PWR_LVL_N6, ESP_PWR_LVL_N3, ESP_PWR_LVL_N0, ESP_PWR_LVL_P3, ESP_PWR_LVL_P6
+};
+static const int8_t POWER_DBM[] = { -12, -9, -6, -3, 0, 3, 6 };
+static const uint8_t LEVEL_COUNT = sizeof(POWER_DBM);
+static const uint8_t START_LEVEL = 4; // 0 dBm, what NimBLEDevice::setPower() gave every link before
+
+TxPowerController::TxPowerController()
+    : connHandle(0), connected(false), pendingStart(false), powerControl(false), rssiQ4(0), historyHead(0),
+      historyCount(0), level(START_LEVEL), lastSampleMs(0), lastStepMs(0), samples(0), sampleFailures(0),
+      raises(0), lowers(0), lastDecision("start") {
+}
+
+void TxPowerController::onConnect(uint16_t handle) {
+    connHandle = handle;
+    connected = true;
+    pendingStart = true;
+}
+
+void TxPowerController::onDisconnect() {
+    connected = false;
+    pendingStart = false;
+}
+
+void TxPowerController::update(uint32_t now) {
+    if (!connected) {
+        return;
+    }
+
+    if (pendingStart) {
+        pendingStart = false;
+        // The controller keeps one power setting per connection handle slot
+        powerControl = connHandle <= ESP_BLE_PWR_TYPE_CONN_HDL8 - ESP_BLE_PWR_TYPE_CONN_HDL0;
+        samples = 0;
+        sampleFailures = 0;
+        historyCount = 0;
+        raises = 0;
+        lowers = 0;
+        lastSampleMs = now;
+        setLevel(START_LEVEL, "start", now); // A reused handle may still hold the previous link's level
+        return;
+    }
+
+    if (now - lastSampleMs < SAMPLE_INTERVAL_MS) {
+        return;
+    }
+    lastSampleMs = now;
+
+    int8_t rssi = 0;
+    if (ble_gap_conn_rssi(connHandle, &rssi) != 0 || rssi == 127) { // 127 = not available
+        sampleFailures++;
+        return;
+    }
+    rssiQ4 = samples == 0 ? rssi * 16 : rssiQ4 + (rssi * 16 - rssiQ4) / 4;
+    samples++;
+    history[historyHead] = rssi;
+    historyHead = (historyHead + 1) % HISTORY_SIZE;
+    if (historyCount < HISTORY_SIZE) {
+        historyCount++;
+    }
+
+    int16_t smoothed = getRssi();
+    if (smoothed < RSSI_CRITICAL_DBM) {
+        if (level < LEVEL_COUNT - 1) {
+            setLevel(LEVEL_COUNT - 1, "critical", now);
+        }
+    } else if (now - lastStepMs < STEP_HOLD_MS) {
+        return;
+    } else if (smoothed < RSSI_WEAK_DBM && level < LEVEL_COUNT - 1) {
+        setLevel(level + 1, "weak", now);
+    } else if (smoothed > RSSI_STRONG_DBM && level > 0) {
+        setLevel(level - 1, "strong", now);
+    }
+}
+
+void TxPowerController::setLevel(uint8_t newLevel, const char* reason, uint32_t now) {
+    lastStepMs = now;
+    if (!powerControl) {
+        lastDecision = "unsupported";
+        return;
+    }
+    esp_ble_power_type_t type = (esp_ble_power_type_t)(ESP_BLE_PWR_TYPE_CONN_HDL0 + connHandle);
+    esp_err_t err = esp_ble_tx_power_set(type, POWER_LEVELS[newLevel]);
+    if (err != ESP_OK) {
+        Serial.printf("TxPowerController: Setting %d dBm failed: %s\n", POWER_DBM[newLevel], esp_err_to_name(err));
+        lastDecision = "failed";
+        return;
+    }
+    if (newLevel > level) {
+        raises++;
+    } else if (newLevel < level) {
+        lowers++;
+    }
+    if (newLevel != level) {
+        Serial.printf("TxPowerController: Connection %u %d -> %d dBm (%s, RSSI %d dBm)\n", connHandle,
+                      POWER_DBM[level], POWER_DBM[newLevel], reason, getRssi());
+    }
+    level = newLevel;
+    lastDecision = reason;
+}
+
+int8_t TxPowerController::getTxPowerDbm() const {
+    return POWER_DBM[level];
+}
+
+void TxPowerController::writeJson(JsonWriter& json) const {
+    json.beginObject();
+    if (hasRssi()) {
+        json.field("rssi", getRssi());
+    } else {
+        json.fieldNull("rssi");
+    }
+    json.field("tx_power_dbm", getTxPowerDbm());
+    json.field("power_control", powerControl);
+    json.field("last_decision", lastDecision);
+    json.field("raises", raises);
+    json.field("lowers", lowers);
+    json.field("rssi_failures", sampleFailures);
+    json.beginArray("rssi_history");
+    for (uint8_t i = 0; i < historyCount; i++) {
+        uint8_t index = (historyHead + HISTORY_SIZE - historyCount + i) % HISTORY_SIZE;
+        json.value(history[index]);
+    }
+    json.endArray();
+    json.endObject();
+}
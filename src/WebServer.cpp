@@ -7,6 +7,10 @@
 #include "FlowRate.h"
 #include "Calibration.h"
 #include "BluetoothScale.h"
+#include "CommandQueue.h"
+#include "JsonWriter.h"
+#include "StaticAssets.h"
+#include <memory>
 
 Preferences preferences;
 
@@ -52,6 +56,115 @@ void setCachedDecimals(int decimals) {
     }
 }
 
+// Renders a JSON response straight into the response buffer - no String is built
+template <typename Fill>
+static void sendJson(AsyncWebServerRequest *request, int code, Fill fill) {
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    response->setCode(code);
+    JsonWriter json(*response);
+    fill(json);
+    request->send(response);
+}
+
+// Plain-text counterpart of sendJson - values are printed into the response buffer
+template <typename Fill>
+static void sendText(AsyncWebServerRequest *request, int code, Fill fill) {
+    AsyncResponseStream *response = request->beginResponseStream("text/plain");
+    response->setCode(code);
+    fill(*response);
+    request->send(response);
+}
+
+// Weight in grams as text, from the same formatter as the JSON fields
+static void sendCentigrams(AsyncWebServerRequest *request, int32_t cg, uint8_t decimals) {
+    char text[16];
+    size_t length = JsonWriter::formatCentigrams(text, sizeof(text), cg, decimals);
+    sendText(request, 200, [&](Print& out) { out.write((const uint8_t*)text, length); });
+}
+
+// Shot summary fields, written into an object the caller has opened
+static void writeShotInfoFields(JsonWriter& json, const ShotInfo& info) {
+    json.field("id", info.id);
+    json.field("start_ms", info.startMs);
+    json.field("duration_ms", info.durationMs);
+    json.field("samples", info.samples);
+    json.fieldCentigrams("start_weight", info.startWeightCg, 2);
+    json.fieldCentigrams("final_weight", info.finalWeightCg, 2);
+    json.field("complete", info.complete);
+    json.field("truncated", info.truncated);
+}
+
+// Streams one shot as chunked JSON, decoding the delta records a batch at a
+// time into a fixed buffer so a full 80 SPS shot is never rendered whole
+struct ShotStream {
+    static const size_t BATCH = 16;
+    static const size_t PENDING_SIZE = BATCH * 36 + 1; // "[t,weight,flow]," at full int32 width
+
+    ShotRecorder* recorder;
+    ShotInfo info;
+    uint32_t next;       // Next record to decode
+    uint32_t timeMs;     // Decoded state of the previous record
+    int32_t weightCg;
+    uint8_t stage;       // 0 = header, 1 = samples, 2 = footer, 3 = done
+    char pending[PENDING_SIZE];
+    size_t pendingLength;
+    size_t pendingPos;
+};
+
+static size_t fillShotStream(ShotStream& stream, uint8_t* buffer, size_t maxLen) {
+    size_t written = 0;
+    while (written < maxLen) {
+        if (stream.pendingPos >= stream.pendingLength) {
+            FixedBufferPrint out(stream.pending, sizeof(stream.pending));
+            stream.pendingPos = 0;
+            if (stream.stage == 0) {
+                // Header only - the samples array is left open and closed by the footer
+                JsonWriter json(out);
+                json.beginObject();
+                writeShotInfoFields(json, stream.info);
+                json.beginArray("fields").value("t_ms").value("weight_cg").value("flow_cgps").endArray();
+                json.beginArray("samples");
+                stream.stage = 1;
+            } else if (stream.stage == 1) {
+                ShotRecord batch[ShotStream::BATCH];
+                size_t count = min((uint32_t)ShotStream::BATCH, stream.info.samples - stream.next);
+                if (count == 0) {
+                    stream.stage = 2;
+                    stream.pendingLength = 0;
+                    continue;
+                }
+                if (!stream.recorder->readRecords(stream.info.id, stream.next, batch, count)) {
+                    // Overwritten by a newer shot mid-stream - close the document cleanly
+                    out.print("],\"aborted\":true}");
+                    stream.stage = 3;
+                    stream.pendingLength = out.length();
+                    continue;
+                }
+                for (size_t i = 0; i < count; i++) {
+                    char sample[40];
+                    stream.timeMs += batch[i].dtMs;
+                    stream.weightCg += batch[i].dWeightCg;
+                    snprintf(sample, sizeof(sample), "%s[%lu,%ld,%d]", stream.next + i > 0 ? "," : "",
+                             (unsigned long)stream.timeMs, (long)stream.weightCg, (int)batch[i].flowCgps);
+                    out.print(sample);
+                }
+                stream.next += count;
+            } else if (stream.stage == 2) {
+                out.print("]}");
+                stream.stage = 3;
+            } else {
+                break;
+            }
+            stream.pendingLength = out.length();
+        }
+        size_t n = min(maxLen - written, stream.pendingLength - stream.pendingPos);
+        memcpy(buffer + written, stream.pending + stream.pendingPos, n);
+        stream.pendingPos += n;
+        written += n;
+    }
+    return written;
+}
+
 void diagnoseEEPROMPerformance() {
     Serial.println("=== EEPROM Performance Diagnostics ===");
     
@@ -90,6 +203,7 @@ void diagnoseEEPROMPerformance() {
 }
 
 AsyncWebServer server(80);
+StaticAssets staticAssets(LittleFS);
 
 /*
  * API Endpoints for External Brewing Systems (e.g., GaggiMate):
@@ -105,9 +219,13 @@ AsyncWebServer server(80);
  * Standard dashboard:
  * GET /api/dashboard
  * Response: {"weight":45.23,"flowrate":2.15}
+ * 
+ * Live dashboard stream (Server-Sent Events, "t" events with changed fields only):
+ * GET /api/events
+ * Event data: {"weight":45.27,"timer_elapsed":23140}
  */
 
-void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothScale, Display &display, BatteryMonitor &battery) {
+void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothScale, Display &display, BatteryMonitor &battery, Scheduler &scheduler, BootSequence &bootSequence, ShotRecorder &shotRecorder, StopTrigger &stopTrigger, ShotDetector &shotDetector, CommandQueue &commandQueue, TelemetryPublisher &telemetry, TelemetryStream &telemetryStream, BrewPoll &brewPoll) {
   if (!LittleFS.begin()) {
     Serial.println();
     Serial.println("=====================================");
@@ -136,99 +254,138 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
   getCachedDecimals();        // This will cache the decimal setting
   getStoredSSID();            // This will cache WiFi credentials
 
+  // Live dashboard stream - the page falls back to polling /api/dashboard without it
+  telemetryStream.attach(server);
+  server.on("/api/telemetry", HTTP_GET, [&telemetryStream](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [&telemetryStream](JsonWriter& json) { telemetryStream.writeStatsJson(json); });
+  });
+
   // Register API route first
-  server.on("/api/dashboard", HTTP_GET, [&scale, &flowRate, &display, &battery, &bluetoothScale](AsyncWebServerRequest *request) {
-    String json = "{";
-    json += "\"weight\":" + String(scale.getCurrentWeight(), 2) + ",";
-    json += "\"flowrate\":" + String(flowRate.getFlowRate(), 1) + ",";
-    json += "\"scale_connected\":" + String(scale.isHX711Connected() ? "true" : "false") + ",";
-    json += "\"filter_state\":\"" + scale.getFilterState() + "\",";
-    
-    // Always show unified mode
-    json += "\"mode\":\"UNIFIED\",";
-    
-    // Add timer information
-    unsigned long elapsedTime = display.getElapsedTime();
-    if (elapsedTime > 0 || display.isTimerRunning()) {
-      unsigned long minutes = elapsedTime / 60000;
-      unsigned long seconds = (elapsedTime % 60000) / 1000;
-      unsigned long milliseconds = elapsedTime % 1000;
-      json += "\"timer_running\":" + String(display.isTimerRunning() ? "true" : "false") + ",";
-      json += "\"timer_elapsed\":" + String(elapsedTime) + ",";
-      json += "\"timer_display\":\"" + String(minutes) + ":" + 
-              (seconds < 10 ? "0" : "") + String(seconds) + "." + 
-              (milliseconds < 100 ? (milliseconds < 10 ? "00" : "0") : "") + String(milliseconds) + "\",";
+  server.on("/api/dashboard", HTTP_GET, [&telemetry](AsyncWebServerRequest *request) {
+    // One snapshot, so weight, flow, timer and status all come from the same weight task cycle
+    TelemetrySnapshot snapshot;
+    telemetry.read(snapshot);
+    sendJson(request, 200, [&](JsonWriter& json) {
+      json.beginObject();
+      json.field("seq", snapshot.sequence);
+      json.field("sample_ms", snapshot.sampleMs);
+      json.fieldCentigrams("weight", snapshot.weightCg, 2);
+      json.field("flowrate", snapshot.flowRate, 1);
+      json.field("scale_connected", snapshot.scaleConnected);
+      json.field("filter_state", snapshot.filterState);
+      
+      // Always show unified mode
+      json.field("mode", "UNIFIED");
+      
+      // Auto timer - shot_event_seq changes on every auto start/stop
+      json.field("timer_auto", snapshot.timerAuto);
+      json.field("shot_event_seq", snapshot.shotEventSeq);
       
-      // Add timer average flow rate
-      if (flowRate.hasTimerAverage()) {
-        json += "\"timer_avg_flowrate\":" + String(flowRate.getTimerAverageFlowRate(), 2);
+      // Add timer information
+      uint32_t elapsedTime = snapshot.timerElapsedMs;
+      if (elapsedTime > 0 || snapshot.timerRunning) {
+        char timerDisplay[24];
+        snprintf(timerDisplay, sizeof(timerDisplay), "%lu:%02lu.%03lu", (unsigned long)(elapsedTime / 60000),
+                 (unsigned long)((elapsedTime % 60000) / 1000), (unsigned long)(elapsedTime % 1000));
+        json.field("timer_running", snapshot.timerRunning);
+        json.field("timer_elapsed", elapsedTime);
+        json.field("timer_display", timerDisplay);
+        
+        // Add timer average flow rate
+        if (snapshot.hasTimerAverage) {
+          json.field("timer_avg_flowrate", snapshot.timerAverageFlowRate, 2);
+        } else {
+          json.fieldNull("timer_avg_flowrate");
+        }
       } else {
-        json += "\"timer_avg_flowrate\":null";
+        json.field("timer_running", false);
+        json.field("timer_elapsed", 0);
+        json.field("timer_display", "0:00.000");
+        json.fieldNull("timer_avg_flowrate");
       }
-    } else {
-      json += "\"timer_running\":false,";
-      json += "\"timer_elapsed\":0,";
-      json += "\"timer_display\":\"0:00.000\",";
-      json += "\"timer_avg_flowrate\":null";
-    }
-    
-    // Add battery information
-    json += ",\"battery_voltage\":" + String(battery.getBatteryVoltage(), 2);
-    json += ",\"battery_percentage\":" + String(battery.getBatteryPercentage());
-    json += ",\"battery_status\":\"" + battery.getBatteryStatus() + "\"";
-    json += ",\"battery_segments\":" + String(battery.getBatterySegments());
-    json += ",\"battery_low\":" + String(battery.isLowBattery() ? "true" : "false");
-    json += ",\"battery_critical\":" + String(battery.isCriticalBattery() ? "true" : "false");
-    
-    // Add signal strength information
-    json += ",\"wifi_signal_strength\":" + String(getWiFiSignalStrength());
-    json += ",\"wifi_signal_quality\":\"" + getWiFiSignalQuality() + "\"";
-    json += ",\"bluetooth_connected\":" + String(bluetoothScale.isConnected() ? "true" : "false");
-    json += ",\"bluetooth_signal_strength\":" + String(bluetoothScale.getBluetoothSignalStrength());
-    
-    json += "}";
-    request->send(200, "application/json", json);
+      
+      // Add battery information
+      json.field("battery_voltage", snapshot.batteryVoltage, 2);
+      json.field("battery_percentage", snapshot.batteryPercentage);
+      json.field("battery_status", snapshot.batteryStatus);
+      json.field("battery_segments", snapshot.batterySegments);
+      json.field("battery_low", snapshot.batteryLow);
+      json.field("battery_critical", snapshot.batteryCritical);
+      
+      // Add signal strength information
+      json.field("wifi_signal_strength", snapshot.wifiSignal);
+      json.field("wifi_signal_quality", snapshot.wifiSignalQuality);
+      json.field("bluetooth_connected", snapshot.bluetoothConnected);
+      json.field("bluetooth_signal_strength", snapshot.bluetoothSignal);
+      json.endObject();
+    });
   });
 
-  // Timer control endpoints
-  server.on("/api/timer/start", HTTP_POST, [&display](AsyncWebServerRequest *request) {
-    display.startTimer();
+  // Timer control endpoints - executed by the weight task within one cycle
+  server.on("/api/timer/start", HTTP_POST, [&commandQueue](AsyncWebServerRequest *request) {
+    if (!commandQueue.push(CMD_TIMER_START, CMD_SOURCE_HTTP)) {
+      request->send(503, "text/plain", "Command queue full");
+      return;
+    }
     request->send(200, "text/plain", "Timer started");
   });
 
-  server.on("/api/timer/stop", HTTP_POST, [&display](AsyncWebServerRequest *request) {
-    display.stopTimer();
+  server.on("/api/timer/stop", HTTP_POST, [&commandQueue](AsyncWebServerRequest *request) {
+    if (!commandQueue.push(CMD_TIMER_STOP, CMD_SOURCE_HTTP)) {
+      request->send(503, "text/plain", "Command queue full");
+      return;
+    }
     request->send(200, "text/plain", "Timer stopped");
   });
 
-  server.on("/api/timer/reset", HTTP_POST, [&display](AsyncWebServerRequest *request) {
-    display.resetTimer();
+  server.on("/api/timer/reset", HTTP_POST, [&commandQueue](AsyncWebServerRequest *request) {
+    if (!commandQueue.push(CMD_TIMER_RESET, CMD_SOURCE_HTTP)) {
+      request->send(503, "text/plain", "Command queue full");
+      return;
+    }
     request->send(200, "text/plain", "Timer reset");
   });
 
-  server.on("/api/weight", HTTP_GET, [&scale](AsyncWebServerRequest *request) {
-    request->send(200, "text/plain", String(scale.getCurrentWeight()));
+  server.on("/api/weight", HTTP_GET, [&telemetry](AsyncWebServerRequest *request) {
+    TelemetrySnapshot snapshot;
+    telemetry.read(snapshot);
+    sendCentigrams(request, snapshot.weightCg, 2);
   });
 
   // Lightweight weight-only endpoint for brewing applications
-  server.on("/api/weight-fast", HTTP_GET, [&scale](AsyncWebServerRequest *request) {
+  server.on("/api/weight-fast", HTTP_GET, [&telemetry](AsyncWebServerRequest *request) {
     // Minimal processing for fastest response
-    request->send(200, "text/plain", String(scale.getCurrentWeight(), 2));
+    TelemetrySnapshot snapshot;
+    telemetry.read(snapshot);
+    sendCentigrams(request, snapshot.weightCg, 2);
   });
 
   // Brewing mode endpoints for external devices like GaggiMate
-  server.on("/api/brew/weight", HTTP_GET, [&scale](AsyncWebServerRequest *request) {
+  server.on("/api/brew/weight", HTTP_GET, [&telemetry](AsyncWebServerRequest *request) {
     // Ultra-fast response for brewing systems
-    float weight = scale.getCurrentWeight();
-    request->send(200, "text/plain", String(weight, 1)); // 1 decimal for speed
+    TelemetrySnapshot snapshot;
+    telemetry.read(snapshot);
+    sendCentigrams(request, snapshot.weightCg, 1); // 1 decimal for speed
   });
   
-  server.on("/api/brew/status", HTTP_GET, [&scale, &flowRate](AsyncWebServerRequest *request) {
-    // Minimal JSON for brewing systems
-    String json = "{\"w\":" + String(scale.getCurrentWeight(), 1) + 
-                  ",\"f\":" + String(flowRate.getFlowRate(), 1) + "}";
-    request->send(200, "application/json", json);
+  server.on("/api/brew/status", HTTP_GET, [&telemetry](AsyncWebServerRequest *request) {
+    // Minimal JSON for brewing systems - weight and flow from the same sample
+    TelemetrySnapshot snapshot;
+    telemetry.read(snapshot);
+    sendJson(request, 200, [&](JsonWriter& json) {
+      json.beginObject();
+      json.fieldCentigrams("w", snapshot.weightCg, 1);
+      json.field("f", snapshot.flowRate, 1);
+      json.field("seq", snapshot.sequence);
+      json.endObject();
+    });
+  });
+
+  // Binary frame for machine controllers - ?since=<sequence> holds the request until a newer sample
+  server.on("/api/brew/bin/stats", HTTP_GET, [&brewPoll](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [&brewPoll](JsonWriter& json) { brewPoll.writeStatsJson(json); });
   });
+  brewPoll.attach(server);
 
   // Battery calibration endpoints (must be before general /api/battery route)
   server.on("/api/battery/calibrate", HTTP_POST, [&battery](AsyncWebServerRequest *request) {
@@ -237,14 +394,17 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
       float actualVoltage = value.toFloat();
       if (actualVoltage > 0.0f && actualVoltage <= 5.0f) {
         battery.calibrateVoltage(actualVoltage);
-        String json = "{";
-        json += "\"status\":\"success\",";
-        json += "\"message\":\"Battery calibrated to " + String(actualVoltage, 3) + "V\",";
-        json += "\"new_voltage\":" + String(battery.getBatteryVoltage(), 3) + ",";
-        json += "\"new_percentage\":" + String(battery.getBatteryPercentage()) + ",";
-        json += "\"calibration_offset\":" + String(battery.getCalibrationOffset(), 3);
-        json += "}";
-        request->send(200, "application/json", json);
+        sendJson(request, 200, [&](JsonWriter& json) {
+          char message[48];
+          snprintf(message, sizeof(message), "Battery calibrated to %.3fV", actualVoltage);
+          json.beginObject();
+          json.field("status", "success");
+          json.field("message", message);
+          json.field("new_voltage", battery.getBatteryVoltage(), 3);
+          json.field("new_percentage", battery.getBatteryPercentage());
+          json.field("calibration_offset", battery.getCalibrationOffset(), 3);
+          json.endObject();
+        });
       } else {
         request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"Invalid voltage. Must be between 0.1V and 5.0V\"}");
       }
@@ -267,17 +427,18 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
         float afterVoltage = battery.getBatteryVoltage();
         int afterPercentage = battery.getBatteryPercentage();
         
-        String json = "{";
-        json += "\"status\":\"success\",";
-        json += "\"message\":\"Battery calibrated successfully\",";
-        json += "\"before_voltage\":" + String(beforeVoltage, 3) + ",";
-        json += "\"before_percentage\":" + String(beforePercentage) + ",";
-        json += "\"after_voltage\":" + String(afterVoltage, 3) + ",";
-        json += "\"after_percentage\":" + String(afterPercentage) + ",";
-        json += "\"target_voltage\":" + String(actualVoltage, 3) + ",";
-        json += "\"calibration_offset\":" + String(battery.getCalibrationOffset(), 3);
-        json += "}";
-        request->send(200, "application/json", json);
+        sendJson(request, 200, [&](JsonWriter& json) {
+          json.beginObject();
+          json.field("status", "success");
+          json.field("message", "Battery calibrated successfully");
+          json.field("before_voltage", beforeVoltage, 3);
+          json.field("before_percentage", beforePercentage);
+          json.field("after_voltage", afterVoltage, 3);
+          json.field("after_percentage", afterPercentage);
+          json.field("target_voltage", actualVoltage, 3);
+          json.field("calibration_offset", battery.getCalibrationOffset(), 3);
+          json.endObject();
+        });
         Serial.printf("Battery calibrated via GET: %.3fV (was %.3fV, now %.3fV)\n", actualVoltage, beforeVoltage, afterVoltage);
       } else {
         request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"Invalid voltage. Must be between 0.1V and 5.0V\"}");
@@ -289,17 +450,18 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
 
   // Battery monitoring endpoint (general status)
   server.on("/api/battery", HTTP_GET, [&battery](AsyncWebServerRequest *request) {
-    String json = "{";
-    json += "\"voltage\":" + String(battery.getBatteryVoltage(), 3);
-    json += ",\"percentage\":" + String(battery.getBatteryPercentage());
-    json += ",\"status\":\"" + battery.getBatteryStatus() + "\"";
-    json += ",\"segments\":" + String(battery.getBatterySegments());
-    json += ",\"low_battery\":" + String(battery.isLowBattery() ? "true" : "false");
-    json += ",\"critical_battery\":" + String(battery.isCriticalBattery() ? "true" : "false");
-    json += ",\"charging\":" + String(battery.isCharging() ? "true" : "false");
-    json += ",\"calibration_offset\":" + String(battery.getCalibrationOffset(), 3);
-    json += "}";
-    request->send(200, "application/json", json);
+    sendJson(request, 200, [&battery](JsonWriter& json) {
+      json.beginObject();
+      json.field("voltage", battery.getBatteryVoltage(), 3);
+      json.field("percentage", battery.getBatteryPercentage());
+      json.field("status", battery.getBatteryStatus());
+      json.field("segments", battery.getBatterySegments());
+      json.field("low_battery", battery.isLowBattery());
+      json.field("critical_battery", battery.isCriticalBattery());
+      json.field("charging", battery.isCharging());
+      json.field("calibration_offset", battery.getCalibrationOffset(), 3);
+      json.endObject();
+    });
   });
 
   // Battery debug endpoint for troubleshooting
@@ -310,42 +472,62 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
     float rawVoltage = ((float)rawADC / 4095.0f) * 3.3f;
     float dividedVoltage = rawVoltage * 2.0f; // Apply voltage divider ratio
     
-    String json = "{";
-    json += "\"raw_adc\":" + String(rawADC) + ",";
-    json += "\"raw_voltage\":" + String(rawVoltage, 3) + ",";
-    json += "\"divided_voltage\":" + String(dividedVoltage, 3) + ",";
-    json += "\"calibrated_voltage\":" + String(battery.getBatteryVoltage(), 3) + ",";
-    json += "\"calibration_offset\":" + String(battery.getCalibrationOffset(), 3) + ",";
-    json += "\"percentage\":" + String(battery.getBatteryPercentage());
-    json += "}";
-    request->send(200, "application/json", json);
-  });
-
-  server.on("/api/tare", HTTP_POST, [&scale, &display, &flowRate](AsyncWebServerRequest *request){
-    scale.tare(20);
-    
-    // Reset timer when taring (prepare for fresh brew)
-    display.resetTimer();
+    sendJson(request, 200, [&](JsonWriter& json) {
+      json.beginObject();
+      json.field("raw_adc", rawADC);
+      json.field("raw_voltage", rawVoltage, 3);
+      json.field("divided_voltage", dividedVoltage, 3);
+      json.field("calibrated_voltage", battery.getBatteryVoltage(), 3);
+      json.field("calibration_offset", battery.getCalibrationOffset(), 3);
+      json.field("percentage", battery.getBatteryPercentage());
+      json.endObject();
+    });
+  });
+
+  server.on("/api/tare", HTTP_POST, [&scale, &commandQueue](AsyncWebServerRequest *request){
+    // Tare runs in the background on the sample stream - poll /api/tare/status for completion
+    if (!scale.isHX711Connected()) {
+      request->send(503, "text/plain", "Tare unavailable - HX711 not connected");
+      return;
+    }
     
-    // Reset flow rate averaging for fresh brew measurement
-    flowRate.resetTimerAveraging();
+    // Reset timer when taring (prepare for fresh brew) - the reset also clears flow rate averaging
+    if (!commandQueue.push(CMD_TARE, CMD_SOURCE_HTTP, 20) || !commandQueue.push(CMD_TIMER_RESET, CMD_SOURCE_HTTP)) {
+      request->send(503, "text/plain", "Command queue full");
+      return;
+    }
     
-    request->send(200, "text/plain", "Scale tared! Timer and flow rate reset for fresh brew.");
+    request->send(202, "text/plain", "Taring scale... Timer and flow rate reset for fresh brew.");
+  });
+
+  server.on("/api/tare/status", HTTP_GET, [&scale](AsyncWebServerRequest *request){
+    sendJson(request, 200, [&scale](JsonWriter& json) {
+      json.beginObject();
+      json.field("state", scale.getTareStateName());
+      json.field("count", scale.getTareCount());
+      json.endObject();
+    });
   });
 
-  server.on("/api/set-calibrationfactor", HTTP_POST, [&scale](AsyncWebServerRequest *request){
+  server.on("/api/set-calibrationfactor", HTTP_POST, [&commandQueue](AsyncWebServerRequest *request){
   if (request->hasParam("calibrationfactor", true)) {
     String value = request->getParam("calibrationfactor", true)->value();
     float calibrationFactor = value.toFloat();
+    if (!commandQueue.push(CMD_SET_CALIBRATION, CMD_SOURCE_HTTP, 0, calibrationFactor)) {
+      request->send(503, "text/plain", "Command queue full");
+      return;
+    }
     Serial.printf("Updated calibration factor weight: %.2f\n", calibrationFactor);
-    request->send(200, "text/plain", "Calibration factor updated to " + value);
-    scale.set_scale(calibrationFactor); // Assuming you have a method to set the calibration factor in Scale class
+    sendText(request, 200, [&value](Print& out) {
+      out.print("Calibration factor updated to ");
+      out.print(value.c_str());
+    });
   } else {
     request->send(400, "text/plain", "Missing 'calibrationfactor' parameter");
   }
 });
 
-  server.on("/api/calibrate", HTTP_POST, [&scale](AsyncWebServerRequest *request){
+  server.on("/api/calibrate", HTTP_POST, [&scale, &commandQueue](AsyncWebServerRequest *request){
     if (request->hasParam("knownWeight", true)) {
       String value = request->getParam("knownWeight", true)->value();
       float knownWeight = value.toFloat();
@@ -353,9 +535,15 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
       long raw = scale.getRawValue();
       if (knownWeight > 0 && raw != 0) {
         float newCalibrationFactor = (float)raw / knownWeight;
-        scale.set_scale(newCalibrationFactor);
+        if (!commandQueue.push(CMD_SET_CALIBRATION, CMD_SOURCE_HTTP, 0, newCalibrationFactor)) {
+          request->send(503, "text/plain", "Command queue full");
+          return;
+        }
         Serial.printf("Calibration complete. New factor: %.6f\n", newCalibrationFactor);
-        request->send(200, "text/plain", "Scale calibrated! New factor: " + String(newCalibrationFactor, 6));
+        sendText(request, 200, [newCalibrationFactor](Print& out) {
+          out.print("Scale calibrated! New factor: ");
+          out.print(newCalibrationFactor, 6);
+        });
       } else {
         request->send(400, "text/plain", "Invalid known weight or scale reading");
       }
@@ -365,25 +553,28 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
   });
 
   server.on("/api/calibrationfactor", HTTP_GET, [&scale](AsyncWebServerRequest *request) {
-    request->send(200, "text/plain", String(scale.getCalibrationFactor(), 6));
+    sendText(request, 200, [&scale](Print& out) { out.print(scale.getCalibrationFactor(), 6); });
   });
 
   // Scale connection status endpoint
   server.on("/api/scale/status", HTTP_GET, [&scale](AsyncWebServerRequest *request) {
-    String json = "{";
-    json += "\"connected\":" + String(scale.isHX711Connected() ? "true" : "false") + ",";
-    json += "\"weight\":" + String(scale.getCurrentWeight(), 2) + ",";
-    json += "\"raw_value\":" + String(scale.getRawValue()) + ",";
-    json += "\"calibration_factor\":" + String(scale.getCalibrationFactor(), 6);
-    json += "}";
-    request->send(200, "application/json", json);
+    sendJson(request, 200, [&scale](JsonWriter& json) {
+      json.beginObject();
+      json.field("connected", scale.isHX711Connected());
+      json.field("weight", scale.getCurrentWeight(), 2);
+      json.field("raw_value", scale.getRawValue());
+      json.field("calibration_factor", scale.getCalibrationFactor(), 6);
+      json.endObject();
+    });
   });
 
   server.on("/api/wifi-creds", HTTP_GET, [](AsyncWebServerRequest *request) {
-    String ssid = getStoredSSID();
-    String password = getStoredPassword();
-    String json = "{\"ssid\":\"" + ssid + "\",\"password\":\"" + password + "\"}";
-    request->send(200, "application/json", json);
+    sendJson(request, 200, [](JsonWriter& json) {
+      json.beginObject();
+      json.field("ssid", getStoredSSID());
+      json.field("password", getStoredPassword());
+      json.endObject();
+    });
   });
 
   server.on("/api/wifi-creds", HTTP_POST, [](AsyncWebServerRequest *request) {
@@ -400,8 +591,13 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
       bool connected = attemptSTAConnection(ssid.c_str(), password.c_str());
       
       if (connected) {
-        request->send(200, "application/json", 
-          "{\"status\":\"success\",\"message\":\"Connected successfully! AP mode disabled for power savings.\",\"ip\":\"" + WiFi.localIP().toString() + "\"}");
+        sendJson(request, 200, [](JsonWriter& json) {
+          json.beginObject();
+          json.field("status", "success");
+          json.field("message", "Connected successfully! AP mode disabled for power savings.");
+          json.fieldIp("ip", WiFi.localIP());
+          json.endObject();
+        });
       } else {
         // Connection failed - switch back to AP mode
         switchToAPMode();
@@ -420,14 +616,15 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
 
   // WiFi Power Management endpoints
   server.on("/api/wifi-status", HTTP_GET, [](AsyncWebServerRequest *request) {
-    String json = "{";
-    json += "\"enabled\":" + String(isWiFiEnabled() ? "true" : "false") + ",";
-    json += "\"connected\":" + String((WiFi.status() == WL_CONNECTED) ? "true" : "false");
-    if (WiFi.status() == WL_CONNECTED) {
-      json += ",\"ssid\":\"" + WiFi.SSID() + "\"";
-    }
-    json += "}";
-    request->send(200, "application/json", json);
+    sendJson(request, 200, [](JsonWriter& json) {
+      json.beginObject();
+      json.field("enabled", isWiFiEnabled());
+      json.field("connected", WiFi.status() == WL_CONNECTED);
+      if (WiFi.status() == WL_CONNECTED) {
+        json.field("ssid", WiFi.SSID());
+      }
+      json.endObject();
+    });
   });
 
   server.on("/api/wifi-toggle", HTTP_POST, [](AsyncWebServerRequest *request) {
@@ -465,22 +662,26 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
 
   // Signal strength endpoint for WiFi and Bluetooth monitoring
   server.on("/api/signal-strength", HTTP_GET, [&bluetoothScale](AsyncWebServerRequest *request) {
-    String json = "{";
-    
-    // WiFi signal strength
-    json += "\"wifi\":" + getWiFiConnectionInfo() + ",";
-    
-    // Bluetooth signal strength
-    json += "\"bluetooth\":" + bluetoothScale.getBluetoothConnectionInfo();
-    
-    json += "}";
-    request->send(200, "application/json", json);
+    sendJson(request, 200, [&bluetoothScale](JsonWriter& json) {
+      json.beginObject();
+      
+      // WiFi signal strength
+      json.key("wifi");
+      writeWiFiConnectionInfo(json);
+      
+      // Bluetooth signal strength
+      json.key("bluetooth");
+      bluetoothScale.writeBluetoothConnectionInfo(json);
+      
+      json.endObject();
+    });
   });
 
   server.on("/api/decimal-setting", HTTP_GET, [](AsyncWebServerRequest *request) {
     int decimals = getCachedDecimals();
-    String json = "{\"decimals\":" + String(decimals) + "}";
-    request->send(200, "application/json", json);
+    sendJson(request, 200, [decimals](JsonWriter& json) {
+      json.beginObject().field("decimals", decimals).endObject();
+    });
   });
 
   server.on("/api/decimal-setting", HTTP_POST, [](AsyncWebServerRequest *request) {
@@ -495,77 +696,302 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
     }
   });
 
-  server.on("/api/flowrate", HTTP_GET, [&flowRate](AsyncWebServerRequest *request) {
-    request->send(200, "text/plain", String(flowRate.getFlowRate(), 1));
+  server.on("/api/flowrate", HTTP_GET, [&telemetry](AsyncWebServerRequest *request) {
+    TelemetrySnapshot snapshot;
+    telemetry.read(snapshot);
+    sendText(request, 200, [&snapshot](Print& out) { out.print(snapshot.flowRate, 1); });
   });
 
   // Bluetooth status API
   server.on("/api/bluetooth/status", HTTP_GET, [&bluetoothScale](AsyncWebServerRequest *request) {
-    String json = "{";
-    json += "\"connected\":" + String(bluetoothScale.isConnected() ? "true" : "false");
-    json += "}";
-    request->send(200, "application/json", json);
+    sendJson(request, 200, [&bluetoothScale](JsonWriter& json) {
+      json.beginObject();
+      json.field("connected", bluetoothScale.isConnected());
+      json.field("connection_count", bluetoothScale.getConnectionCount());
+      json.key("connections");
+      bluetoothScale.writeConnectionsJson(json);
+      json.key("lifecycle");
+      bluetoothScale.writeLifecycleJson(json);
+      json.key("advertising_policy");
+      bluetoothScale.writeAdvertisingJson(json);
+      json.key("notifications");
+      bluetoothScale.writeNotificationStatsJson(json);
+      json.endObject();
+    });
+  });
+
+  // Connectionless advertising broadcast
+  server.on("/api/bluetooth/broadcast", HTTP_GET, [&bluetoothScale](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [&bluetoothScale](JsonWriter& json) { bluetoothScale.writeBroadcastJson(json); });
+  });
+
+  server.on("/api/bluetooth/broadcast", HTTP_POST, [&bluetoothScale](AsyncWebServerRequest *request) {
+    bool enabled = bluetoothScale.isBroadcastEnabled();
+    uint16_t intervalMs = bluetoothScale.getBroadcastIntervalMs();
+    if (request->hasParam("enabled", true)) {
+      enabled = request->getParam("enabled", true)->value() == "true";
+    }
+    if (request->hasParam("intervalMs", true)) {
+      int value = request->getParam("intervalMs", true)->value().toInt();
+      if (value < 50 || value > 1000) {
+        request->send(400, "application/json", "{\"error\":\"intervalMs must be 50-1000\"}");
+        return;
+      }
+      intervalMs = value;
+    }
+    bluetoothScale.setBroadcast(enabled, intervalMs);
+    sendJson(request, 200, [&bluetoothScale](JsonWriter& json) { bluetoothScale.writeBroadcastJson(json); });
+  });
+
+  // Scheduler statistics - per-task overruns and jitter histograms
+  server.on("/api/scheduler", HTTP_GET, [&scheduler](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [&scheduler](JsonWriter& json) { scheduler.writeStatsJson(json); });
+  });
+
+  // Heap headroom - min_free is the low-water mark since boot, max_alloc the largest free block
+  server.on("/api/heap", HTTP_GET, [](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [](JsonWriter& json) {
+      json.beginObject();
+      json.field("free", ESP.getFreeHeap());
+      json.field("min_free", ESP.getMinFreeHeap());
+      json.field("max_alloc", ESP.getMaxAllocHeap());
+      json.field("uptime_ms", millis());
+      json.endObject();
+    });
+  });
+
+  // Static file cache hits - not_modified counts 304 revalidations
+  server.on("/api/assets", HTTP_GET, [](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [](JsonWriter& json) { staticAssets.writeStatsJson(json); });
+  });
+
+  // Command queue - per command type wait and execution latency
+  server.on("/api/commands", HTTP_GET, [&commandQueue](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [&commandQueue](JsonWriter& json) { commandQueue.writeStatsJson(json); });
+  });
+
+  // Auto timer state and the last detected event
+  server.on("/api/shot-detector", HTTP_GET, [&shotDetector](AsyncWebServerRequest *request) {
+    ShotEvent event = shotDetector.getLastEvent();
+    sendJson(request, 200, [&shotDetector, event](JsonWriter& json) {
+      json.beginObject();
+      json.field("enabled", shotDetector.isEnabled());
+      json.field("auto_running", shotDetector.isAutoRunning());
+      json.field("event_seq", shotDetector.getEventCount());
+      json.field("last_event", event == SHOT_EVENT_START ? "start" : event == SHOT_EVENT_STOP ? "stop" : "none");
+      json.field("last_event_ms", shotDetector.getLastEventMs());
+      json.field("last_backdate_ms", shotDetector.getLastBackdateMs());
+      json.endObject();
+    });
+  });
+
+  // Target-weight stop trigger
+  server.on("/api/target", HTTP_GET, [&stopTrigger](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [&stopTrigger](JsonWriter& json) {
+      json.beginObject();
+      json.field("state", stopTrigger.getStateName());
+      json.fieldCentigrams("target", stopTrigger.getTargetCg(), 2);
+      json.field("drip_s", stopTrigger.getDripSeconds(), 2);
+      json.field("fired", stopTrigger.getFireCount());
+      json.fieldCentigrams("last_stop_weight", stopTrigger.getLastFireWeightCg(), 2);
+      json.fieldCentigrams("last_final_weight", stopTrigger.getLastFinalWeightCg(), 2);
+      json.fieldCentigrams("last_overshoot", stopTrigger.getLastOvershootCg(), 2);
+      json.endObject();
+    });
+  });
+
+  server.on("/api/target", HTTP_POST, [&stopTrigger, &commandQueue](AsyncWebServerRequest *request) {
+    if (request->hasParam("resetLearning", true) && !commandQueue.push(CMD_RESET_DRIP_LEARNING, CMD_SOURCE_HTTP)) {
+      request->send(503, "application/json", "{\"error\":\"Command queue full\"}");
+      return;
+    }
+    if (request->hasParam("weight", true)) {
+      float grams = request->getParam("weight", true)->value().toFloat();
+      if (grams < 0 || grams > 2000) {
+        request->send(400, "application/json", "{\"error\":\"Target must be 0-2000 g\"}");
+        return;
+      }
+      stopTrigger.setTarget((int32_t)lroundf(grams * 100.0f)); // 0 clears
+    }
+    request->send(200, "application/json", "{\"status\":\"success\"}");
+  });
+
+  // Latest complete shot, streamed - registered before /api/shots, which would otherwise match it as a prefix
+  server.on("/api/shots/latest", HTTP_GET, [&shotRecorder](AsyncWebServerRequest *request) {
+    auto stream = std::make_shared<ShotStream>();
+    if (!shotRecorder.getLatestShot(stream->info)) {
+      request->send(404, "application/json", "{\"error\":\"No recorded shot\"}");
+      return;
+    }
+    stream->recorder = &shotRecorder;
+    stream->next = 0;
+    stream->timeMs = 0;
+    stream->weightCg = stream->info.startWeightCg;
+    stream->stage = 0;
+    stream->pendingLength = 0;
+    stream->pendingPos = 0;
+    request->send(request->beginChunkedResponse("application/json",
+      [stream](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+        return fillShotStream(*stream, buffer, maxLen);
+      }));
+  });
+
+  // Shot history summary - one entry per occupied slot
+  server.on("/api/shots", HTTP_GET, [&shotRecorder](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [&shotRecorder](JsonWriter& json) {
+      json.beginObject();
+      json.field("recording", shotRecorder.isRecording());
+      json.field("slots", shotRecorder.getSlotCount());
+      json.field("slot_capacity", shotRecorder.getSlotCapacity());
+      json.field("psram", shotRecorder.isInPsram());
+      json.beginArray("shots");
+      ShotInfo info;
+      for (size_t i = 0; i < shotRecorder.getSlotCount(); i++) {
+        if (shotRecorder.getShotBySlot(i, info)) {
+          json.beginObject();
+          writeShotInfoFields(json, info);
+          json.endObject();
+        }
+      }
+      json.endArray();
+      json.endObject();
+    });
+  });
+
+  // Boot stage timestamps (ms since reset) and when each subsystem became ready
+  server.on("/api/boot-profile", HTTP_GET, [&bootSequence](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [&bootSequence](JsonWriter& json) { bootSequence.writeProfileJson(json); });
   });
 
   // Filter settings API endpoints
-  server.on("/api/filter-settings", HTTP_GET, [&scale](AsyncWebServerRequest *request) {
-    String json = "{";
-    json += "\"brewingThreshold\":" + String(scale.getBrewingThreshold(), 2) + ",";
-    json += "\"stabilityTimeout\":" + String(scale.getStabilityTimeout()) + ",";
-    json += "\"medianSamples\":" + String(scale.getMedianSamples()) + ",";
-    json += "\"averageSamples\":" + String(scale.getAverageSamples());
-    json += "}";
-    request->send(200, "application/json", json);
-  });
-
-  server.on("/api/filter-settings", HTTP_POST, [&scale](AsyncWebServerRequest *request) {
-    String response = "{\"status\":\"success\",\"message\":\"";
+  server.on("/api/filter-settings", HTTP_GET, [&scale, &flowRate, &shotDetector](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [&](JsonWriter& json) {
+      json.beginObject();
+      json.field("brewingThreshold", scale.getBrewingThreshold(), 2);
+      json.field("stabilityTimeout", scale.getStabilityTimeout());
+      json.field("medianSamples", scale.getMedianSamples());
+      json.field("averageSamples", scale.getAverageSamples());
+      json.field("filterMode", scale.getFilterModeName());
+      json.field("kalmanProcessNoise", scale.getKalmanProcessNoise(), 4);
+      json.field("kalmanMeasurementNoise", scale.getKalmanMeasurementNoise(), 4);
+      json.field("flowMode", flowRate.getModeName());
+      json.field("flowWindowMs", flowRate.getRegressionWindow());
+      json.field("autoTimer", shotDetector.isEnabled());
+      json.field("autoStartFlow", shotDetector.getStartFlow(), 2);
+      json.field("autoStartMs", shotDetector.getStartHoldMs());
+      json.field("autoStopFlow", shotDetector.getStopFlow(), 2);
+      json.field("autoStopMs", shotDetector.getStopHoldMs());
+      json.endObject();
+    });
+  });
+
+  server.on("/api/filter-settings", HTTP_POST, [&commandQueue](AsyncWebServerRequest *request) {
+    char message[256] = "";   // Sum of the notes below - fits every one at once
+    FixedBufferPrint notes(message, sizeof(message));
     bool updated = false;
+    bool queued = true; // Settings are applied by the weight task
     
     if (request->hasParam("brewingThreshold", true)) {
       float threshold = request->getParam("brewingThreshold", true)->value().toFloat();
-      scale.setBrewingThreshold(threshold);
-      response += "Brewing threshold updated. ";
+      queued &= commandQueue.push(CMD_SET_BREWING_THRESHOLD, CMD_SOURCE_HTTP, 0, threshold);
+      notes.print("Brewing threshold updated. ");
       updated = true;
     }
     if (request->hasParam("stabilityTimeout", true)) {
       unsigned long timeout = request->getParam("stabilityTimeout", true)->value().toInt();
-      scale.setStabilityTimeout(timeout);
-      response += "Stability timeout updated. ";
+      queued &= commandQueue.push(CMD_SET_STABILITY_TIMEOUT, CMD_SOURCE_HTTP, timeout);
+      notes.print("Stability timeout updated. ");
       updated = true;
     }
     if (request->hasParam("medianSamples", true)) {
       int samples = request->getParam("medianSamples", true)->value().toInt();
-      scale.setMedianSamples(samples);
-      response += "Median samples updated. ";
+      queued &= commandQueue.push(CMD_SET_MEDIAN_SAMPLES, CMD_SOURCE_HTTP, samples);
+      notes.print("Median samples updated. ");
       updated = true;
     }
     if (request->hasParam("averageSamples", true)) {
       int samples = request->getParam("averageSamples", true)->value().toInt();
-      scale.setAverageSamples(samples);
-      response += "Average samples updated. ";
+      queued &= commandQueue.push(CMD_SET_AVERAGE_SAMPLES, CMD_SOURCE_HTTP, samples);
+      notes.print("Average samples updated. ");
+      updated = true;
+    }
+    if (request->hasParam("filterMode", true)) {
+      String mode = request->getParam("filterMode", true)->value();
+      queued &= commandQueue.push(CMD_SET_FILTER_MODE, CMD_SOURCE_HTTP, mode == "kalman" ? Scale::FILTER_KALMAN : Scale::FILTER_SMART);
+      notes.print("Filter mode updated. ");
+      updated = true;
+    }
+    if (request->hasParam("kalmanProcessNoise", true) && request->hasParam("kalmanMeasurementNoise", true)) {
+      float processNoise = request->getParam("kalmanProcessNoise", true)->value().toFloat();
+      float measurementNoise = request->getParam("kalmanMeasurementNoise", true)->value().toFloat();
+      queued &= commandQueue.push(CMD_SET_KALMAN_NOISE, CMD_SOURCE_HTTP, 0, processNoise, measurementNoise);
+      notes.print("Kalman noise updated. ");
+      updated = true;
+    }
+    if (request->hasParam("flowMode", true)) {
+      String mode = request->getParam("flowMode", true)->value();
+      queued &= commandQueue.push(CMD_SET_FLOW_MODE, CMD_SOURCE_HTTP, mode == "difference" ? FlowRate::MODE_DIFFERENCE : FlowRate::MODE_REGRESSION);
+      notes.print("Flow rate mode updated. ");
+      updated = true;
+    }
+    if (request->hasParam("flowWindowMs", true)) {
+      uint32_t windowMs = request->getParam("flowWindowMs", true)->value().toInt();
+      queued &= commandQueue.push(CMD_SET_FLOW_WINDOW, CMD_SOURCE_HTTP, windowMs);
+      notes.print("Flow regression window updated. ");
+      updated = true;
+    }
+    if (request->hasParam("autoTimer", true)) {
+      queued &= commandQueue.push(CMD_SET_AUTO_TIMER, CMD_SOURCE_HTTP, request->getParam("autoTimer", true)->value() == "true");
+      notes.print("Auto timer updated. ");
+      updated = true;
+    }
+    if (request->hasParam("autoStartFlow", true)) {
+      queued &= commandQueue.push(CMD_SET_AUTO_START_FLOW, CMD_SOURCE_HTTP, 0, request->getParam("autoStartFlow", true)->value().toFloat());
+      updated = true;
+    }
+    if (request->hasParam("autoStartMs", true)) {
+      queued &= commandQueue.push(CMD_SET_AUTO_START_MS, CMD_SOURCE_HTTP, request->getParam("autoStartMs", true)->value().toInt());
+      updated = true;
+    }
+    if (request->hasParam("autoStopFlow", true)) {
+      queued &= commandQueue.push(CMD_SET_AUTO_STOP_FLOW, CMD_SOURCE_HTTP, 0, request->getParam("autoStopFlow", true)->value().toFloat());
+      updated = true;
+    }
+    if (request->hasParam("autoStopMs", true)) {
+      queued &= commandQueue.push(CMD_SET_AUTO_STOP_MS, CMD_SOURCE_HTTP, request->getParam("autoStopMs", true)->value().toInt());
       updated = true;
     }
     
-    if (updated) {
-      response += "\"}";
-      request->send(200, "application/json", response);
+    if (!queued) {
+      request->send(503, "application/json", "{\"status\":\"error\",\"message\":\"Command queue full - some settings were not applied\"}");
+    } else if (updated) {
+      sendJson(request, 200, [&message](JsonWriter& json) {
+        json.beginObject().field("status", "success").field("message", message).endObject();
+      });
     } else {
       request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"No valid parameters provided\"}");
     }
   });
 
   // Filter debug endpoint - shows current filter state
-  server.on("/api/filter-debug", HTTP_GET, [&scale](AsyncWebServerRequest *request) {
-    String json = "{";
-    json += "\"filterState\":\"" + scale.getFilterState() + "\",";
-    json += "\"brewingThreshold\":" + String(scale.getBrewingThreshold(), 2) + ",";
-    json += "\"stabilityTimeout\":" + String(scale.getStabilityTimeout()) + ",";
-    json += "\"medianSamples\":" + String(scale.getMedianSamples()) + ",";
-    json += "\"averageSamples\":" + String(scale.getAverageSamples()) + ",";
-    json += "\"currentWeight\":" + String(scale.getCurrentWeight(), 1);
-    json += "}";
-    request->send(200, "application/json", json);
+  server.on("/api/filter-debug", HTTP_GET, [&scale, &flowRate](AsyncWebServerRequest *request) {
+    sendJson(request, 200, [&](JsonWriter& json) {
+      json.beginObject();
+      json.field("filterState", scale.getFilterState());
+      json.field("brewingThreshold", scale.getBrewingThreshold(), 2);
+      json.field("stabilityTimeout", scale.getStabilityTimeout());
+      json.field("medianSamples", scale.getMedianSamples());
+      json.field("averageSamples", scale.getAverageSamples());
+      json.field("maxSamples", Scale::getMaxSamples());
+      json.field("filterCycles", scale.getFilterCycles());
+      json.field("flowMode", flowRate.getModeName());
+      json.field("flowRate", flowRate.getFlowRate(), 2);
+      json.field("flowStdError", flowRate.getFlowRateStdError(), 3);
+      json.field("flowFitResidual", flowRate.getFitResidual(), 3);
+      json.field("flowRegressionSamples", flowRate.getRegressionSamples());
+      json.field("currentWeight", scale.getCurrentWeight(), 1);
+      json.endObject();
+    });
   });
 
   // Combined settings endpoint for faster loading
@@ -578,13 +1004,13 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
     int decimals = getCachedDecimals();
     
     // Combine into single JSON response
-    String json = "{";
-    json += "\"ssid\":\"" + ssid + "\",";
-    json += "\"password\":\"" + password + "\",";
-    json += "\"decimals\":" + String(decimals);
-    json += "}";
-    
-    request->send(200, "application/json", json);
+    sendJson(request, 200, [&](JsonWriter& json) {
+      json.beginObject();
+      json.field("ssid", ssid);
+      json.field("password", password);
+      json.field("decimals", decimals);
+      json.endObject();
+    });
   });
 
   // Emergency NVS reset endpoint (use with caution)
@@ -616,11 +1042,16 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
     }
   });
 
-  // Serve static files for non-API paths
-  server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
+  // Serve static files for non-API paths - gzipped with ETags when the image was staged by tools/compress_assets.py
+  bool stagedAssets = staticAssets.begin();
+  if (stagedAssets) {
+    server.addHandler(&staticAssets);
+  } else {
+    server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
+  }
 
   // 404 Not Found handler for unmatched routes
-  server.onNotFound([](AsyncWebServerRequest *request) {
+  server.onNotFound([stagedAssets](AsyncWebServerRequest *request) {
     String path = request->url();
     // If the request is for an API endpoint that doesn't exist, return 404
     if (path.startsWith("/api/")) {
@@ -628,24 +1059,9 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
       return;
     }
     // For all other unmatched paths, serve index.html (SPA fallback)
-    request->send(LittleFS, "/index.html", "text/html");
-  });
-
-  // Add explicit MIME type handlers for font files
-  server.on("/css/all.min.css", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(LittleFS, "/css/all.min.css", "text/css");
-  });
-  
-  server.on("/js/alpine.min.js", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(LittleFS, "/js/alpine.min.js", "application/javascript");
-  });
-  
-  server.on("/webfonts/fa-solid-900.woff2", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(LittleFS, "/webfonts/fa-solid-900.woff2", "font/woff2");
-  });
-  
-  server.on("/webfonts/fa-regular-400.woff2", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(LittleFS, "/webfonts/fa-regular-400.woff2", "font/woff2");
+    if (!stagedAssets || !staticAssets.send(request, "/index.html")) {
+      request->send(LittleFS, "/index.html", "text/html");
+    }
   });
 
   // Only start the web server if WiFi is enabled
@@ -3,6 +3,7 @@
 #include <Preferences.h>
 #include <ESPmDNS.h>
 #include "WebServer.h"  // For web server control
+#include "JsonWriter.h"
 
 // ESP-IDF includes for advanced WiFi power management (SuperMini antenna fix)
 #ifdef ESP_IDF_VERSION_MAJOR
@@ -608,7 +609,7 @@ int getWiFiSignalStrength() {
 }
 
 // Get WiFi signal quality description
-String getWiFiSignalQuality() {
+const char* getWiFiSignalQuality() {
     if (WiFi.status() != WL_CONNECTED) {
         return "Disconnected";
     }
@@ -630,39 +631,42 @@ String getWiFiSignalQuality() {
     }
 }
 
+
 // Get detailed WiFi connection information
-String getWiFiConnectionInfo() {
-    String info = "{";
-    
+void writeWiFiConnectionInfo(JsonWriter& json) {
+    uint8_t mac[6];
+    char macText[18];
+    WiFi.macAddress(mac);
+    snprintf(macText, sizeof(macText), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+
+    json.beginObject();
     if (WiFi.status() == WL_CONNECTED) {
-        info += "\"connected\":true,";
-        info += "\"mode\":\"STA\",";
-        info += "\"ssid\":\"" + WiFi.SSID() + "\",";
-        info += "\"signal_strength\":" + String(WiFi.RSSI()) + ",";
-        info += "\"signal_quality\":\"" + getWiFiSignalQuality() + "\",";
-        info += "\"channel\":" + String(WiFi.channel()) + ",";
-        info += "\"tx_power\":" + String(WiFi.getTxPower()) + ",";
-        info += "\"ip\":\"" + WiFi.localIP().toString() + "\",";
-        info += "\"gateway\":\"" + WiFi.gatewayIP().toString() + "\",";
-        info += "\"dns\":\"" + WiFi.dnsIP().toString() + "\",";
-        info += "\"mac\":\"" + WiFi.macAddress() + "\"";
+        json.field("connected", true);
+        json.field("mode", "STA");
+        json.field("ssid", WiFi.SSID());
+        json.field("signal_strength", WiFi.RSSI());
+        json.field("signal_quality", getWiFiSignalQuality());
+        json.field("channel", WiFi.channel());
+        json.field("tx_power", (int)WiFi.getTxPower());
+        json.fieldIp("ip", WiFi.localIP());
+        json.fieldIp("gateway", WiFi.gatewayIP());
+        json.fieldIp("dns", WiFi.dnsIP());
+        json.field("mac", macText);
     } else {
-        info += "\"connected\":false,";
-        info += "\"mode\":\"AP\",";
-        info += "\"ssid\":\"" + String(ap_ssid) + "\",";
-        info += "\"signal_strength\":null,";
-        info += "\"signal_quality\":\"N/A - AP Mode\",";
-        info += "\"channel\":" + String(WiFi.channel()) + ",";
-        info += "\"tx_power\":" + String(WiFi.getTxPower()) + ",";
-        info += "\"ip\":\"" + WiFi.softAPIP().toString() + "\",";
-        info += "\"gateway\":\"N/A\",";
-        info += "\"dns\":\"N/A\",";
-        info += "\"mac\":\"" + WiFi.macAddress() + "\",";
-        info += "\"connected_clients\":" + String(WiFi.softAPgetStationNum());
-    }
-    
-    info += "}";
-    return info;
+        json.field("connected", false);
+        json.field("mode", "AP");
+        json.field("ssid", ap_ssid);
+        json.fieldNull("signal_strength");
+        json.field("signal_quality", "N/A - AP Mode");
+        json.field("channel", WiFi.channel());
+        json.field("tx_power", (int)WiFi.getTxPower());
+        json.fieldIp("ip", WiFi.softAPIP());
+        json.field("gateway", "N/A");
+        json.field("dns", "N/A");
+        json.field("mac", macText);
+        json.field("connected_clients", WiFi.softAPgetStationNum());
+    }
+    json.endObject();
 }
 
 // WiFi Power Management Functions
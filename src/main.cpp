@@ -14,6 +14,15 @@
 #include "PowerManager.h"
 #include "BatteryMonitor.h"
 #include "BoardConfig.h"
+#include "Scheduler.h"
+#include "BootSequence.h"
+#include "ShotRecorder.h"
+#include "StopTrigger.h"
+#include "ShotDetector.h"
+#include "CommandQueue.h"
+#include "TelemetryPublisher.h"
+#include "TelemetryStream.h"
+#include "BrewPoll.h"
 
 // Board-specific pin configuration
 uint8_t dataPin = HX711_DATA_PIN;     // HX711 Data pin
@@ -31,9 +40,235 @@ TouchSensor touchSensor(touchPin, &scale);
 Display oledDisplay(sdaPin, sclPin, &scale, &flowRate);
 PowerManager powerManager(sleepTouchPin, &oledDisplay);
 BatteryMonitor batteryMonitor(batteryPin);
+Scheduler scheduler;
+BootSequence bootSequence;
+ShotRecorder shotRecorder;
+StopTrigger stopTrigger;
+ShotDetector shotDetector;
+CommandQueue commandQueue;
+TelemetryPublisher telemetry(&scale, &flowRate, &oledDisplay, &batteryMonitor, &shotDetector, &bluetoothScale);
+TelemetryStream telemetryStream(telemetry);
+BrewPoll brewPoll(telemetry);
+int weightTaskId = -1;
+int firstTareStage = -1;
+int firstTareAttempts = 0;
+const int FIRST_TARE_ATTEMPTS = 3;
+
+// Runs a BLE/HTTP control command on the weight task - the only task that touches these objects
+bool executeCommand(const Command& command, void* context) {
+  switch (command.type) {
+    case CMD_TARE:
+      // Callback fires when the tare completes - or now, when it could not be queued
+      if (!scale.requestTare(command.intValue, command.callback, command.context)) {
+        if (command.callback != nullptr) {
+          command.callback(false, command.context);
+        }
+        return false;
+      }
+      return true;
+    case CMD_TIMER_START:         oledDisplay.startTimer(); break;
+    case CMD_TIMER_STOP:          oledDisplay.stopTimer(); break;
+    case CMD_TIMER_RESET:         oledDisplay.resetTimer(); break;
+    case CMD_SET_CALIBRATION:     scale.set_scale(command.floatValue[0]); break;
+    case CMD_SET_BREWING_THRESHOLD: scale.setBrewingThreshold(command.floatValue[0]); break;
+    case CMD_SET_STABILITY_TIMEOUT: scale.setStabilityTimeout(command.intValue); break;
+    case CMD_SET_MEDIAN_SAMPLES:  scale.setMedianSamples(command.intValue); break;
+    case CMD_SET_AVERAGE_SAMPLES: scale.setAverageSamples(command.intValue); break;
+    case CMD_SET_FILTER_MODE:     scale.setFilterMode((Scale::FilterMode)command.intValue); break;
+    case CMD_SET_KALMAN_NOISE:    scale.setKalmanNoise(command.floatValue[0], command.floatValue[1]); break;
+    case CMD_SET_FLOW_MODE:       flowRate.setMode((FlowRate::Mode)command.intValue); break;
+    case CMD_SET_FLOW_WINDOW:     flowRate.setRegressionWindow(command.intValue); break;
+    case CMD_SET_AUTO_TIMER:      shotDetector.setEnabled(command.intValue != 0); break;
+    case CMD_SET_AUTO_START_FLOW: shotDetector.setStartFlow(command.floatValue[0]); break;
+    case CMD_SET_AUTO_START_MS:   shotDetector.setStartHoldMs(command.intValue); break;
+    case CMD_SET_AUTO_STOP_FLOW:  shotDetector.setStopFlow(command.floatValue[0]); break;
+    case CMD_SET_AUTO_STOP_MS:    shotDetector.setStopHoldMs(command.intValue); break;
+    case CMD_RESET_DRIP_LEARNING: stopTrigger.resetLearning(); break;
+    default:
+      return false;
+  }
+  if (command.callback != nullptr) {
+    command.callback(true, command.context);
+  }
+  return true;
+}
+
+// Scheduled task bodies - each subsystem keeps its own cadence
+void weightTask() {
+  static uint32_t flowRateCursor = 0;
+  
+  // Control commands first, so this cycle already runs with the new settings
+  commandQueue.process(executeCommand, nullptr);
+  
+  // Filter every conversion captured by the acquisition task since the last run
+  scale.getWeight();
+  
+  // Apply timer start/stop before recording this batch
+  shotRecorder.update();
+  
+  // Feed flow rate every filtered sample with its own timestamp - none are skipped
+  WeightSample sample;
+  bool newSample = false;
+  bool bleReady = bootSequence.isReady(BOOT_READY_BLE);
+  while (scale.getWeightRing().pop(flowRateCursor, sample)) {
+    newSample = true;
+    flowRate.update(sample);
+    stopTrigger.update(sample, flowRate.getFlowRate(), oledDisplay.isTimerRunning()); // Target check at the full sample rate
+    shotDetector.update(sample, flowRate.getFlowRate()); // Auto timer - may start a backdated shot
+    shotRecorder.addSample(sample.timestampMs, sample.weightCg, flowRate.getFlowRate());
+    if (bleReady) {
+      bluetoothScale.queueBatchSample(sample); // Batched characteristic carries every sample
+    }
+  }
+  
+  // One snapshot per cycle - the OLED, BLE, web API and SSE all show these values
+  const TelemetrySnapshot& snapshot = telemetry.publish();
+  
+  // BLE weight notifications follow the samples; the policy decides what is worth sending
+  if (newSample && bleReady) {
+    bluetoothScale.publishWeight(snapshot);
+  }
+  
+  // Held /api/brew/bin requests answer with the new sample
+  if (newSample) {
+    brewPoll.wake();
+  }
+  
+  // Dashboard tabs get the same values pushed over /api/events
+  telemetryStream.wake(snapshot);
+}
+
+// Subsystems still coming up on a boot task are skipped until their readiness event
+void bluetoothTask() {
+  if (bootSequence.isReady(BOOT_READY_BLE)) {
+    bluetoothScale.update();
+  }
+}
+void touchTask() { touchSensor.update(); }
+void powerTask() { powerManager.update(); }
+void displayTask() {
+  // Keep the "Starting" screen until the first weight is live (or there is no HX711 to wait for)
+  if (bootSequence.isReady(BOOT_READY_WEIGHT) ||
+      (bootSequence.isReady(BOOT_READY_SCALE_PROBED) && !scale.isHX711Connected())) {
+    oledDisplay.update();
+  }
+}
+void batteryTask() { batteryMonitor.update(); }
+void wifiTask() {
+  if (bootSequence.isReady(BOOT_READY_WIFI)) {
+    maintainWiFi();
+  }
+}
+void wifiStatusTask() { // WiFi status for debugging
+  if (bootSequence.isReady(BOOT_READY_WIFI)) {
+    printWiFiStatus();
+  }
+}
+
+// Called from the HX711 acquisition task for every new conversion
+void onScaleSample() {
+  scheduler.notify(weightTaskId);
+}
+
+// Called from whichever task queued a command - run it without waiting for the next period
+void onCommandQueued(void* context) {
+  if (weightTaskId >= 0) {
+    scheduler.notify(weightTaskId);
+  }
+}
+
+// Boot tasks - each brings one subsystem up in parallel with the others, then exits
+
+// Called on the weight task once the first tare has established the zero
+void onFirstTare(bool success, void* context) {
+  // Nothing is published before the first tare, so retry a failed one before declaring weight ready
+  if (!success && ++firstTareAttempts < FIRST_TARE_ATTEMPTS) {
+    Serial.printf("First tare failed, retrying (%d/%d)\n", firstTareAttempts + 1, FIRST_TARE_ATTEMPTS);
+    if (scale.requestTare(10, onFirstTare, nullptr)) {
+      return;
+    }
+  }
+  if (!success) {
+    Serial.println("WARNING: First tare failed - weight reads 0 until the scale is tared");
+  }
+  bootSequence.endStage(firstTareStage, success);
+  bootSequence.setReady(BOOT_READY_WEIGHT);
+}
+
+void scaleInitTask(void* arg) {
+  // Initialize scale with error handling - don't block web server if HX711 fails
+  int stage = bootSequence.beginStage("scale-probe");
+  Serial.println("Initializing scale...");
+  bool scaleOk = scale.begin();
+  bootSequence.endStage(stage, scaleOk);
+  
+  if (!scaleOk) {
+    Serial.println("WARNING: Scale (HX711) initialization failed!");
+    Serial.println("Web server will continue to run, but scale readings will not be available.");
+    Serial.println("Check HX711 wiring and connections.");
+  } else {
+    Serial.println("Scale initialized successfully");
+    // First tare averages the live sample stream; weight is published once it completes
+    firstTareStage = bootSequence.beginStage("first-tare");
+    scale.requestTare(10, onFirstTare, nullptr);
+  }
+  bootSequence.setReady(BOOT_READY_SCALE_PROBED);
+  vTaskDelete(nullptr);
+}
+
+void bleInitTask(void* arg) {
+  // BLE comes up before WiFi to prevent radio conflicts - wifiInitTask waits for it
+  int stage = bootSequence.beginStage("ble");
+  Serial.println("Initializing BLE FIRST for GaggiMate compatibility...");
+  Serial.printf("Free heap before BLE init: %u bytes\n", ESP.getFreeHeap());
+  Serial.printf("Free PSRAM before BLE init: %u bytes\n", ESP.getFreePsram());
+  
+  try {
+    bluetoothScale.begin();  // Initialize BLE without scale reference
+    Serial.println("BLE initialized successfully - GaggiMate should be able to connect");
+    Serial.printf("Free heap after BLE init: %u bytes\n", ESP.getFreeHeap());
+    Serial.printf("Free PSRAM after BLE init: %u bytes\n", ESP.getFreePsram());
+  } catch (...) {
+    Serial.println("BLE initialization failed - continuing without Bluetooth");
+    Serial.printf("Free heap after BLE fail: %u bytes\n", ESP.getFreeHeap());
+  }
+  bootSequence.endStage(stage);
+  
+  // The scale reference is set before BOOT_READY_BLE lets bluetoothTask run, so it
+  // never changes under it. The probe is bounded (3s), inside wifiInitTask's wait.
+  bootSequence.waitReady(BOOT_READY_SCALE_PROBED, portMAX_DELAY);
+  if (scale.isHX711Connected()) {
+    bluetoothScale.setScale(&scale);
+  }
+  bootSequence.setReady(BOOT_READY_BLE);
+  vTaskDelete(nullptr);
+}
+
+void wifiInitTask(void* arg) {
+  // Wait for BLE to finish initializing before starting WiFi (bounded, in case BLE init hangs)
+  if (!bootSequence.waitReady(BOOT_READY_BLE, 5000)) {
+    Serial.println("Boot: BLE not ready after 5s - starting WiFi anyway");
+  }
+  
+  int stage = bootSequence.beginStage("wifi");
+  // ALWAYS enable WiFi power management for optimal battery life
+  // This works regardless of WiFi mode (STA/AP/OFF) and should be set early
+  WiFi.setSleep(true);
+  Serial.println("WiFi power management enabled for battery optimization");
+  setupWiFi();
+  bootSequence.endStage(stage);
+  
+  stage = bootSequence.beginStage("webserver");
+  setupWebServer(scale, flowRate, bluetoothScale, oledDisplay, batteryMonitor, scheduler, bootSequence, shotRecorder, stopTrigger, shotDetector, commandQueue, telemetry, telemetryStream, brewPoll);
+  bootSequence.endStage(stage);
+  bootSequence.setReady(BOOT_READY_WIFI);
+  vTaskDelete(nullptr);
+}
 
 void setup() {
   Serial.begin(115200);
+  bootSequence.begin();
+  int setupStage = bootSequence.beginStage("setup");
   
   // Board identification 
   Serial.println("=================================");
@@ -44,6 +279,12 @@ void setup() {
   
   // Link scale and flow rate for tare operation coordination
   scale.setFlowRatePtr(&flowRate);
+  flowRate.begin();
+  
+  // Shot history buffer is allocated once, before any task can start a timer
+  shotRecorder.begin();
+  stopTrigger.begin();
+  shotDetector.begin();
   
   // Check for factory reset request (hold touch pin during boot)
   pinMode(touchPin, INPUT_PULLDOWN);
@@ -53,24 +294,21 @@ void setup() {
     delay(1000);
   }
   
-  // CRITICAL: Initialize BLE FIRST before WiFi to prevent radio conflicts
-  Serial.println("Initializing BLE FIRST for GaggiMate compatibility...");
-  Serial.printf("Free heap before BLE init: %u bytes\n", ESP.getFreeHeap());
-  Serial.printf("Free PSRAM before BLE init: %u bytes\n", ESP.getFreePsram());
-  
-  try {
-    bluetoothScale.begin();  // Initialize BLE without scale reference
-    Serial.println("BLE initialized successfully - GaggiMate should be able to connect");
-    Serial.printf("Free heap after BLE init: %u bytes\n", ESP.getFreeHeap());
-    Serial.printf("Free PSRAM after BLE init: %u bytes\n", ESP.getFreePsram());
-  } catch (...) {
-    Serial.println("BLE initialization failed - continuing without Bluetooth");
-    Serial.printf("Free heap after BLE fail: %u bytes\n", ESP.getFreeHeap());
-  }
+  // Staged parallel boot: the HX711 probe, BLE and WiFi each come up on their own
+  // task and signal readiness through bootSequence instead of fixed delays.
+  // The scheduler starts as soon as setup() returns and gates each subsystem on its event.
+  scale.setSampleCallback(onScaleSample);
+  // scale.begin() attaches the HX711 data-ready interrupt, which is serviced on the
+  // core that attaches it - pinned next to the acquisition task, away from the radios
+  xTaskCreatePinnedToCore(scaleInitTask, "boot-scale", 4096, nullptr, 2, nullptr, ARDUINO_RUNNING_CORE);
+  xTaskCreate(bleInitTask, "boot-ble", 6144, nullptr, 1, nullptr);
+  xTaskCreate(wifiInitTask, "boot-wifi", 8192, nullptr, 1, nullptr);
   
   // Initialize display with error handling - don't block if display fails
+  int displayStage = bootSequence.beginStage("display");
   Serial.println("Initializing display...");
   bool displayAvailable = oledDisplay.begin();
+  bootSequence.endStage(displayStage, displayAvailable);
   
   if (!displayAvailable) {
     Serial.println("WARNING: Display initialization failed!");
@@ -80,13 +318,11 @@ void setup() {
     Serial.println("Display initialized - ready for visual feedback");
   }
   
-  // Check wake-up reason and show appropriate message
+  // Check wake-up reason - the "Starting" screen stays up until the first weight, no extra delay
   esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
   switch(wakeup_reason) {
     case ESP_SLEEP_WAKEUP_EXT0:
       Serial.println("Wakeup caused by external signal (touch sensor)");
-      // Show the same starting message as normal boot for consistency
-      delay(1500);
       break;
     case ESP_SLEEP_WAKEUP_EXT1:
       Serial.println("Wakeup caused by external signal using RTC_CNTL");
@@ -99,37 +335,9 @@ void setup() {
       break;
     default:
       Serial.println("Wakeup was not caused by deep sleep: " + String(wakeup_reason));
-      // For normal startup, the begin() method already shows a startup message
-      delay(1000);
       break;
   }
-  //Wait for BLE to finish intitalizing before starting WiFi
-  delay(1500); 
-  
-  // ALWAYS enable WiFi power management for optimal battery life
-  // This works regardless of WiFi mode (STA/AP/OFF) and should be set early
-  WiFi.setSleep(true);
-  Serial.println("WiFi power management enabled for battery optimization");
-  
-  setupWiFi();
-
-  // Wait for WiFi to fully stabilize after BLE is already running
-  delay(1500);
   Serial.printf("Version: %s\n", ESP.getSdkVersion());
-  // Initialize scale with error handling - don't block web server if HX711 fails
-  Serial.println("Initializing scale...");
-  if (!scale.begin()) {
-    Serial.println("WARNING: Scale (HX711) initialization failed!");
-    Serial.println("Web server will continue to run, but scale readings will not be available.");
-    Serial.println("Check HX711 wiring and connections.");
-  } else {
-    Serial.println("Scale initialized successfully");
-    // Now that scale is ready, set the reference in BluetoothScale
-    bluetoothScale.setScale(&scale);
-  }
-  
-  // BLE was initialized earlier - no need to initialize again
-  // bluetoothScale.begin(&scale);
   
   // Set bluetooth reference in display for status indicator (if display available)
   if (oledDisplay.isConnected()) {
@@ -139,6 +347,16 @@ void setup() {
   // Set display reference in bluetooth for timer control
   bluetoothScale.setDisplay(&oledDisplay);
   
+  // Timer start/stop records shots whether or not the OLED is fitted
+  oledDisplay.setShotRecorder(&shotRecorder);
+  bluetoothScale.setShotRecorder(&shotRecorder);
+  bluetoothScale.setStopTrigger(&stopTrigger);
+  shotDetector.setDisplay(&oledDisplay);
+  bluetoothScale.setShotDetector(&shotDetector);
+  bluetoothScale.setCommandQueue(&commandQueue);
+  bluetoothScale.setTelemetry(&telemetry);
+  oledDisplay.setTelemetry(&telemetry);
+  
   // Set power manager reference in display for timer state synchronization (if display available)
   if (oledDisplay.isConnected()) {
     oledDisplay.setPowerManager(&powerManager);
@@ -148,6 +366,7 @@ void setup() {
   if (oledDisplay.isConnected()) {
     oledDisplay.setBatteryMonitor(&batteryMonitor);
   }
+  bootSequence.setReady(BOOT_READY_DISPLAY);
 
   // Initialize touch sensor
   touchSensor.begin();
@@ -158,12 +377,6 @@ void setup() {
   // Initialize battery monitor
   batteryMonitor.begin();
 
-  // Show IP addresses and welcome message if display is available
-  delay(100); // Small delay to ensure WiFi is fully initialized
-  if (oledDisplay.isConnected()) {
-    oledDisplay.showIPAddresses();
-  }
-
   // Link display to touch sensor for tare feedback (if display available)
   if (oledDisplay.isConnected()) {
     touchSensor.setDisplay(&oledDisplay);
@@ -172,49 +385,21 @@ void setup() {
   // Link flow rate to touch sensor for averaging reset on tare
   touchSensor.setFlowRate(&flowRate);
 
-  setupWebServer(scale, flowRate, bluetoothScale, oledDisplay, batteryMonitor);
+  // Register subsystems: name, callback, period (ms), priority, deadline (ms)
+  weightTaskId = scheduler.addTask("weight", weightTask, 20, 10, 10);       // Also woken per HX711 conversion and command
+  commandQueue.setWakeCallback(onCommandQueued, nullptr);
+  scheduler.addTask("bluetooth", bluetoothTask, 50, 8, 20);                 // 20Hz - sufficient for app responsiveness
+  scheduler.addTask("touch", touchTask, 20, 7, 20);
+  scheduler.addTask("power", powerTask, 20, 6, 20);
+  scheduler.addTask("display", displayTask, 50, 4, 50);
+  scheduler.addTask("battery", batteryTask, 1000, 2, 100);
+  scheduler.addTask("wifi", wifiTask, 1000, 1, 1000);                       // maintainWiFi() has its own 15s gate
+  scheduler.addTask("wifi-status", wifiStatusTask, 30000, 0, 1000);
+  scheduler.begin();
+  bootSequence.endStage(setupStage);
 }
 
 void loop() {
-  static unsigned long lastWeightUpdate = 0;
-  static unsigned long lastWiFiCheck = 0;
-  
-  // Update weight at optimal frequency for brewing accuracy
-  if (millis() - lastWeightUpdate >= 20) { // Update every 20ms (50Hz) - still very responsive
-    float weight = scale.getWeight();
-    flowRate.update(weight);
-    lastWeightUpdate = millis();
-  }
-  
-  static unsigned long lastBLEUpdate = 0;
-  
-  // Check WiFi status every 30 seconds for debugging
-  if (millis() - lastWiFiCheck >= 30000) {
-    printWiFiStatus();
-    lastWiFiCheck = millis();
-  }
-  
-  // Maintain WiFi AP stability
-  maintainWiFi();
-  
-  // Update Bluetooth less frequently to reduce BLE interference
-  if (millis() - lastBLEUpdate >= 50) { // Update every 50ms (20Hz) - sufficient for app responsiveness
-    bluetoothScale.update();
-    lastBLEUpdate = millis();
-  }
-  
-  // Update touch sensor
-  touchSensor.update();
-  
-  // Update power manager
-  powerManager.update();
-  
-  // Update battery monitor
-  batteryMonitor.update();
-  
-  // Update display
-  oledDisplay.update();
-  
-  // Balanced delay for responsive readings without system overload
-  delay(25); // Increased from 5ms to 25ms to reduce BLE interference and system load
+  // Runs due tasks, then sleeps until the next deadline or a new HX711 sample
+  scheduler.runOnce();
 }
@@ -0,0 +1,109 @@
+#include <unity.h>
+#include "BrewFrame.h"
+#include "GaggiMateFrame.h"
+
+void setUp() {}
+void tearDown() {}
+
+static BrewWeight sample() {
+    BrewWeight frame;
+    frame.flags = BREW_FLAG_TIMER_RUNNING | BREW_FLAG_SCALE_CONNECTED;
+    frame.filterState = GAGGIMATE_FILTER_BREWING;
+    frame.weightCg = 3612;
+    frame.timerMs = 27480;
+    frame.sequence = 0x12345678;
+    frame.flowCgps = -215;
+    frame.sampleAgeMs = 37;
+    return frame;
+}
+
+static BrewWeight roundTrip(const BrewWeight& frame) {
+    uint8_t data[BREW_FRAME_LENGTH];
+    BrewFrame::encode(frame, data);
+    BrewWeight decoded;
+    TEST_ASSERT_TRUE(BrewFrame::decode(data, sizeof(data), decoded));
+    return decoded;
+}
+
+void test_layout_matches_python_struct() {
+    // struct.unpack("<BBBxiIIhH", body) in tools/brew_bin_follow.py
+    uint8_t data[BREW_FRAME_LENGTH];
+    BrewFrame::encode(sample(), data);
+    const uint8_t expected[BREW_FRAME_LENGTH] = {
+        BREW_FRAME_VERSION,
+        BREW_FLAG_TIMER_RUNNING | BREW_FLAG_SCALE_CONNECTED,
+        GAGGIMATE_FILTER_BREWING,
+        0x00,                   // Reserved
+        0x1C, 0x0E, 0x00, 0x00, // 3612 cg
+        0x58, 0x6B, 0x00, 0x00, // 27480 ms
+        0x78, 0x56, 0x34, 0x12, // Sequence
+        0x29, 0xFF,             // -215 cg/s
+        0x25, 0x00,             // 37 ms old
+    };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, data, BREW_FRAME_LENGTH);
+}
+
+void test_round_trip() {
+    BrewWeight decoded = roundTrip(sample());
+    TEST_ASSERT_EQUAL_UINT8(BREW_FLAG_TIMER_RUNNING | BREW_FLAG_SCALE_CONNECTED, decoded.flags);
+    TEST_ASSERT_EQUAL_UINT8(GAGGIMATE_FILTER_BREWING, decoded.filterState);
+    TEST_ASSERT_EQUAL_INT32(3612, decoded.weightCg);
+    TEST_ASSERT_EQUAL_UINT32(27480, decoded.timerMs);
+    TEST_ASSERT_EQUAL_UINT32(0x12345678, decoded.sequence);
+    TEST_ASSERT_EQUAL_INT16(-215, decoded.flowCgps);
+    TEST_ASSERT_EQUAL_UINT16(37, decoded.sampleAgeMs);
+
+    BrewWeight extremes = sample();
+    extremes.timerMs = 0xFFFFFFFF;
+    extremes.sequence = 0xFFFFFFFF;
+    extremes.sampleAgeMs = 0xFFFF;
+    decoded = roundTrip(extremes);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, decoded.timerMs);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, decoded.sequence);
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, decoded.sampleAgeMs);
+}
+
+void test_negative_weight_and_flow() {
+    BrewWeight frame = sample();
+    const int32_t weights[] = { -1, -3612, -250000, -2147483647 - 1, 2147483647 };
+    for (int32_t weight : weights) {
+        frame.weightCg = weight;
+        TEST_ASSERT_EQUAL_INT32(weight, roundTrip(frame).weightCg);
+    }
+    const int16_t flows[] = { -1, -215, -32768, 32767 };
+    for (int16_t flow : flows) {
+        frame.flowCgps = flow;
+        TEST_ASSERT_EQUAL_INT16(flow, roundTrip(frame).flowCgps);
+    }
+
+    uint8_t data[BREW_FRAME_LENGTH];
+    frame.weightCg = -2;
+    frame.flowCgps = -2;
+    BrewFrame::encode(frame, data);
+    const uint8_t weightBytes[] = { 0xFE, 0xFF, 0xFF, 0xFF };
+    const uint8_t flowBytes[] = { 0xFE, 0xFF };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(weightBytes, data + 4, 4);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(flowBytes, data + 16, 2);
+}
+
+void test_short_or_unknown_frame_is_rejected() {
+    uint8_t data[BREW_FRAME_LENGTH];
+    BrewWeight decoded;
+    BrewFrame::encode(sample(), data);
+    TEST_ASSERT_FALSE(BrewFrame::decode(data, BREW_FRAME_LENGTH - 1, decoded));
+    TEST_ASSERT_TRUE(BrewFrame::decode(data, BREW_FRAME_LENGTH, decoded));
+
+    data[0] = BREW_FRAME_VERSION + 1;
+    TEST_ASSERT_FALSE(BrewFrame::decode(data, sizeof(data), decoded));
+    data[0] = 0;
+    TEST_ASSERT_FALSE(BrewFrame::decode(data, sizeof(data), decoded));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_layout_matches_python_struct);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_negative_weight_and_flow);
+    RUN_TEST(test_short_or_unknown_frame_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,108 @@
+#include <unity.h>
+#include "BroadcastCodec.h"
+
+void setUp() {}
+void tearDown() {}
+
+static BroadcastFrame sample() {
+    BroadcastFrame frame;
+    frame.sequence = 0xA7;
+    frame.weightCg = 3612;
+    frame.flowCgps = -215;
+    frame.timerMs = 27400;
+    frame.flags = BROADCAST_FLAG_TIMER_RUNNING | BROADCAST_FLAG_CONNECTED;
+    return frame;
+}
+
+static BroadcastFrame roundTrip(const BroadcastFrame& frame) {
+    uint8_t data[BROADCAST_MFR_DATA_SIZE];
+    Broadcast::encode(frame, data);
+    BroadcastFrame decoded;
+    TEST_ASSERT_TRUE(Broadcast::decode(data, sizeof(data), decoded));
+    return decoded;
+}
+
+void test_layout_is_little_endian() {
+    uint8_t data[BROADCAST_MFR_DATA_SIZE];
+    Broadcast::encode(sample(), data);
+    const uint8_t expected[BROADCAST_MFR_DATA_SIZE] = {
+        0xFF, 0xFF,       // Company id
+        BROADCAST_VERSION,
+        0xA7,             // Sequence
+        0x1C, 0x0E, 0x00, // 3612 cg
+        0x29, 0xFF,       // -215 cg/s
+        0x12, 0x01,       // 274 tenths of a second
+        BROADCAST_FLAG_TIMER_RUNNING | BROADCAST_FLAG_CONNECTED,
+    };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, data, BROADCAST_MFR_DATA_SIZE);
+
+    BroadcastFrame decoded = roundTrip(sample());
+    TEST_ASSERT_EQUAL_UINT8(0xA7, decoded.sequence);
+    TEST_ASSERT_EQUAL_INT32(3612, decoded.weightCg);
+    TEST_ASSERT_EQUAL_INT16(-215, decoded.flowCgps);
+    TEST_ASSERT_EQUAL_UINT32(27400, decoded.timerMs);
+    TEST_ASSERT_EQUAL_UINT8(BROADCAST_FLAG_TIMER_RUNNING | BROADCAST_FLAG_CONNECTED, decoded.flags);
+}
+
+void test_weight_sign_extends_from_24_bits() {
+    BroadcastFrame frame = sample();
+    const int32_t weights[] = { 0, 1, -1, -3612, 0x7FFFFF, -0x800000, -0x7FFFFF };
+    for (int32_t weight : weights) {
+        frame.weightCg = weight;
+        TEST_ASSERT_EQUAL_INT32(weight, roundTrip(frame).weightCg);
+    }
+}
+
+void test_weight_clamps_to_24_bits() {
+    BroadcastFrame frame = sample();
+    frame.weightCg = 0x800000;
+    TEST_ASSERT_EQUAL_INT32(0x7FFFFF, roundTrip(frame).weightCg);
+    frame.weightCg = 0x7FFFFFFF;
+    TEST_ASSERT_EQUAL_INT32(0x7FFFFF, roundTrip(frame).weightCg);
+    frame.weightCg = -0x800001;
+    TEST_ASSERT_EQUAL_INT32(-0x800000, roundTrip(frame).weightCg);
+    frame.weightCg = -2147483647 - 1;
+    TEST_ASSERT_EQUAL_INT32(-0x800000, roundTrip(frame).weightCg);
+}
+
+void test_timer_truncates_to_tenths_and_saturates() {
+    BroadcastFrame frame = sample();
+    frame.timerMs = 99;
+    TEST_ASSERT_EQUAL_UINT32(0, roundTrip(frame).timerMs);
+    frame.timerMs = 6553599;
+    TEST_ASSERT_EQUAL_UINT32(6553500, roundTrip(frame).timerMs);
+    frame.timerMs = 6553600;
+    TEST_ASSERT_EQUAL_UINT32(6553500, roundTrip(frame).timerMs);
+    frame.timerMs = 0xFFFFFFFF;
+    TEST_ASSERT_EQUAL_UINT32(6553500, roundTrip(frame).timerMs);
+}
+
+void test_foreign_data_is_rejected() {
+    uint8_t data[BROADCAST_MFR_DATA_SIZE];
+    BroadcastFrame decoded;
+    Broadcast::encode(sample(), data);
+
+    data[0] = 0x4C; // Another company's manufacturer data
+    data[1] = 0x00;
+    TEST_ASSERT_FALSE(Broadcast::decode(data, sizeof(data), decoded));
+
+    Broadcast::encode(sample(), data);
+    data[2] = BROADCAST_VERSION + 1;
+    TEST_ASSERT_FALSE(Broadcast::decode(data, sizeof(data), decoded));
+    data[2] = 0;
+    TEST_ASSERT_FALSE(Broadcast::decode(data, sizeof(data), decoded));
+
+    Broadcast::encode(sample(), data);
+    TEST_ASSERT_FALSE(Broadcast::decode(data, BROADCAST_MFR_DATA_SIZE - 1, decoded));
+    TEST_ASSERT_TRUE(Broadcast::decode(data, BROADCAST_MFR_DATA_SIZE, decoded));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_layout_is_little_endian);
+    RUN_TEST(test_weight_sign_extends_from_24_bits);
+    RUN_TEST(test_weight_clamps_to_24_bits);
+    RUN_TEST(test_timer_truncates_to_tenths_and_saturates);
+    RUN_TEST(test_foreign_data_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,164 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "FixedPoint.h"
+#include "WindowFilter.h"
+
+// countsToCentigrams() against the double-precision reference over every
+// 24-bit count, and the per-sample cost of the integer pipeline against the
+// float one it replaced.
+
+// Typical load cells, a negative (reversed) cell, and the representable extremes
+static const float CALIBRATION_FACTORS[] = { 1.0f, 3.7f, 420.5f, 1234.567f, -2280.0f, 7050.25f, 65000.0f, 16777215.0f };
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static uint64_t ticks() { return __rdtsc(); }
+static const char* TICK_UNIT = "TSC cycles";
+#else
+static uint64_t ticks() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static const char* TICK_UNIT = "ns";
+#endif
+
+void setUp() {}
+void tearDown() {}
+
+static int32_t reference(int32_t counts, float calibrationFactor) {
+    return (int32_t)lround((double)counts * 100.0 / (double)calibrationFactor);
+}
+
+void test_full_24_bit_range_is_bit_exact() {
+    for (float factor : CALIBRATION_FACTORS) {
+        CentigramScale scale = centigramScale(factor);
+        TEST_ASSERT_TRUE(scale.perCountQ24 != 0);
+        uint32_t mismatches = 0;
+        for (int32_t counts = -(1 << 23); counts < (1 << 23); counts++) {
+            if (countsToCentigrams(counts, scale) != reference(counts, factor)) {
+                mismatches++;
+            }
+        }
+        TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+    }
+}
+
+void test_offset_subtracted_extremes_are_bit_exact() {
+    // Raw reading and offset at opposite ends of the 24-bit range
+    const int32_t counts[] = { (1 << 24) - 1, -(1 << 24) + 1, 1 << 24, -(1 << 24) };
+    for (float factor : CALIBRATION_FACTORS) {
+        CentigramScale scale = centigramScale(factor);
+        for (int32_t value : counts) {
+            TEST_ASSERT_EQUAL_INT32(reference(value, factor), countsToCentigrams(value, scale));
+        }
+    }
+}
+
+void test_halves_round_away_from_zero() {
+    CentigramScale scale = centigramScale(200.0f); // 0.5 cg per count
+    TEST_ASSERT_EQUAL_INT32(1, countsToCentigrams(1, scale));
+    TEST_ASSERT_EQUAL_INT32(-1, countsToCentigrams(-1, scale));
+    TEST_ASSERT_EQUAL_INT32(2, countsToCentigrams(3, scale));
+    TEST_ASSERT_EQUAL_INT32(-2, countsToCentigrams(-3, scale));
+    scale = centigramScale(-200.0f);
+    TEST_ASSERT_EQUAL_INT32(-1, countsToCentigrams(1, scale));
+    TEST_ASSERT_EQUAL_INT32(2, countsToCentigrams(-3, scale));
+}
+
+void test_unrepresentable_factor_is_uncalibrated() {
+    const float factors[] = { 0.0f, 0.999f, -0.5f, 16777216.0f, INFINITY, NAN };
+    for (float factor : factors) {
+        TEST_ASSERT_EQUAL_INT32(0, centigramScale(factor).perCountQ24);
+    }
+}
+
+// Before: counts converted to float grams per sample, float windows, float
+// thresholds, and float * 100 truncated for BLE. After: counts through the
+// same windows as int32, thresholds in counts, one conversion at the output.
+struct FloatPipeline {
+    SlidingMean<float, float, 64> mean;
+    SlidingMedian<float, 64> median;
+    float calibrationFactor;
+    float current;
+
+    int32_t process(int32_t counts) {
+        float raw = (float)counts / calibrationFactor;
+        float average = mean.push(raw);
+        float middle = median.push(raw);
+        float change = fabsf(raw - current);
+        current = change > 5.0f ? raw : (change > 0.1f ? middle : average);
+        return (int32_t)(current * 100);
+    }
+};
+
+struct CountPipeline {
+    SlidingMean<int32_t, int64_t, 64> mean;
+    SlidingMedian<int32_t, 64> median;
+    CentigramScale scale;
+    int32_t brewingThresholdCounts;
+    int32_t jumpThresholdCounts;
+    int32_t current;
+
+    int32_t process(int32_t counts) {
+        int32_t average = mean.push(counts);
+        int32_t middle = median.push(counts);
+        int32_t change = abs(counts - current);
+        current = change > jumpThresholdCounts ? counts : (change > brewingThresholdCounts ? middle : average);
+        return countsToCentigrams(current, scale);
+    }
+};
+
+static volatile int32_t sink;
+static const size_t BENCH_SAMPLES = 1 << 20;
+
+template <typename Pipeline>
+static double ticksPerSample(Pipeline& pipeline, const int32_t* samples) {
+    uint64_t start = ticks();
+    for (size_t i = 0; i < BENCH_SAMPLES; i++) {
+        sink = pipeline.process(samples[i & 1023]);
+    }
+    return (double)(ticks() - start) / BENCH_SAMPLES;
+}
+
+void test_benchmark_float_and_count_pipelines() {
+    const float factor = 1234.567f;
+    int32_t samples[1024];
+    uint32_t state = 7;
+    for (size_t i = 0; i < 1024; i++) {
+        state = state * 1664525u + 1013904223u;
+        samples[i] = 45000 + (int32_t)(i * 11) + (int32_t)(state >> 25) - 64; // 36 g pour with noise
+    }
+
+    FloatPipeline before;
+    before.mean.reset(2, 0.0f);
+    before.median.reset(3, 0.0f);
+    before.calibrationFactor = factor;
+    before.current = 0.0f;
+
+    CountPipeline after;
+    after.mean.reset(2, 0);
+    after.median.reset(3, 0);
+    after.scale = centigramScale(factor);
+    after.brewingThresholdCounts = gramsToCounts(0.1f, factor);
+    after.jumpThresholdCounts = gramsToCounts(5.0f, factor);
+    after.current = 0;
+
+    double floatTicks = ticksPerSample(before, samples);
+    double countTicks = ticksPerSample(after, samples);
+
+    char line[96];
+    snprintf(line, sizeof(line), "%s per sample: float pipeline %.1f, count pipeline %.1f",
+             TICK_UNIT, floatTicks, countTicks);
+    TEST_MESSAGE(line);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_24_bit_range_is_bit_exact);
+    RUN_TEST(test_offset_subtracted_extremes_are_bit_exact);
+    RUN_TEST(test_halves_round_away_from_zero);
+    RUN_TEST(test_unrepresentable_factor_is_uncalibrated);
+    RUN_TEST(test_benchmark_float_and_count_pipelines);
+    return UNITY_END();
+}
@@ -0,0 +1,134 @@
+#include <unity.h>
+#include <stdlib.h>
+#include "GaggiMateFrame.h"
+
+void setUp() {}
+void tearDown() {}
+
+// The frame BluetoothScale::sendGaggiMateWeight() built before the
+// extension, kept verbatim as the reference old clients were written against
+static void legacyFrame(int32_t weightInt, uint8_t payload[GAGGIMATE_FRAME_LENGTH]) {
+    for (int i = 0; i < GAGGIMATE_FRAME_LENGTH; i++) {
+        payload[i] = 0x00;
+    }
+    payload[0] = WEIGHMYBRU_PRODUCT_NUMBER;
+    payload[1] = WEIGHMYBRU_MSG_WEIGHT;
+    payload[6] = (weightInt >= 0) ? 43 : 45;
+    uint32_t absWeight = abs(weightInt);
+    payload[7] = (absWeight >> 16) & 0xFF;
+    payload[8] = (absWeight >> 8) & 0xFF;
+    payload[9] = absWeight & 0xFF;
+    uint8_t checksum = payload[0];
+    for (int i = 1; i < GAGGIMATE_FRAME_LENGTH - 1; i++) {
+        checksum ^= payload[i];
+    }
+    payload[GAGGIMATE_FRAME_LENGTH - 1] = checksum;
+}
+
+static GaggiMateWeight extended() {
+    GaggiMateWeight frame;
+    frame.weightCg = 3612;
+    frame.extension = GAGGIMATE_EXTENSION_VERSION;
+    frame.flowCgps = -215;
+    frame.timerMs = 27480;
+    frame.state = GAGGIMATE_FILTER_BREWING | GAGGIMATE_STATE_TIMER_RUNNING | GAGGIMATE_STATE_FLOWING;
+    frame.sequence = 0xBEEF;
+    return frame;
+}
+
+void test_no_extension_is_byte_equal_to_legacy() {
+    // Extension fields set but not negotiated - they must not leak into the frame
+    GaggiMateWeight frame = extended();
+    frame.extension = 0;
+    const int32_t weights[] = { 0, 1, -1, 3612, -3612, 99999, -250000, 0xFFFFFF, -0xFFFFFF };
+    for (int32_t weight : weights) {
+        frame.weightCg = weight;
+        uint8_t expected[GAGGIMATE_FRAME_LENGTH];
+        uint8_t actual[GAGGIMATE_FRAME_LENGTH];
+        legacyFrame(weight, expected);
+        GaggiMateFrame::encode(frame, actual);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, GAGGIMATE_FRAME_LENGTH);
+    }
+}
+
+void test_extension_round_trip() {
+    GaggiMateWeight frame = extended();
+    uint8_t bytes[GAGGIMATE_FRAME_LENGTH];
+    GaggiMateFrame::encode(frame, bytes);
+
+    // Old clients only read bytes 0-9 and the checksum
+    uint8_t legacy[GAGGIMATE_FRAME_LENGTH];
+    legacyFrame(frame.weightCg, legacy);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(legacy, bytes, 10);
+    TEST_ASSERT_EQUAL_HEX8(GaggiMateFrame::checksum(bytes, GAGGIMATE_FRAME_LENGTH - 1), bytes[19]);
+
+    GaggiMateWeight decoded;
+    TEST_ASSERT_TRUE(GaggiMateFrame::decode(bytes, sizeof(bytes), decoded));
+    TEST_ASSERT_EQUAL_INT32(3612, decoded.weightCg);
+    TEST_ASSERT_EQUAL_UINT8(GAGGIMATE_EXTENSION_VERSION, decoded.extension);
+    TEST_ASSERT_EQUAL_INT16(-215, decoded.flowCgps);
+    TEST_ASSERT_EQUAL_UINT32(27480, decoded.timerMs);
+    TEST_ASSERT_EQUAL_UINT8(frame.state, decoded.state);
+    TEST_ASSERT_EQUAL_UINT16(0xBEEF, decoded.sequence);
+}
+
+void test_checksum_mismatch_is_rejected() {
+    uint8_t bytes[GAGGIMATE_FRAME_LENGTH];
+    GaggiMateFrame::encode(extended(), bytes);
+    GaggiMateWeight decoded;
+    for (int i = 0; i < GAGGIMATE_FRAME_LENGTH; i++) {
+        bytes[i] ^= 0x10;
+        TEST_ASSERT_FALSE(GaggiMateFrame::decode(bytes, sizeof(bytes), decoded));
+        bytes[i] ^= 0x10;
+    }
+    TEST_ASSERT_TRUE(GaggiMateFrame::decode(bytes, sizeof(bytes), decoded));
+    TEST_ASSERT_FALSE(GaggiMateFrame::decode(bytes, GAGGIMATE_FRAME_LENGTH - 1, decoded));
+}
+
+void test_unknown_extension_version_decodes_as_none() {
+    GaggiMateWeight frame = extended();
+    frame.extension = GAGGIMATE_EXTENSION_VERSION + 1;
+    uint8_t bytes[GAGGIMATE_FRAME_LENGTH];
+    GaggiMateFrame::encode(frame, bytes);
+
+    GaggiMateWeight decoded = extended();
+    TEST_ASSERT_TRUE(GaggiMateFrame::decode(bytes, sizeof(bytes), decoded));
+    TEST_ASSERT_EQUAL_INT32(3612, decoded.weightCg);
+    TEST_ASSERT_EQUAL_UINT8(0, decoded.extension);
+    TEST_ASSERT_EQUAL_INT16(0, decoded.flowCgps);
+    TEST_ASSERT_EQUAL_UINT32(0, decoded.timerMs);
+    TEST_ASSERT_EQUAL_UINT8(0, decoded.state);
+    TEST_ASSERT_EQUAL_UINT16(0, decoded.sequence);
+}
+
+void test_weight_and_timer_saturate_at_24_bits() {
+    GaggiMateWeight frame = extended();
+    GaggiMateWeight decoded;
+    uint8_t bytes[GAGGIMATE_FRAME_LENGTH];
+
+    const int32_t weights[] = { 0x1000000, 0x7FFFFFFF, -0x1000000, -2147483647 - 1 };
+    for (int32_t weight : weights) {
+        frame.weightCg = weight;
+        GaggiMateFrame::encode(frame, bytes);
+        TEST_ASSERT_TRUE(GaggiMateFrame::decode(bytes, sizeof(bytes), decoded));
+        TEST_ASSERT_EQUAL_INT32(weight > 0 ? 0xFFFFFF : -0xFFFFFF, decoded.weightCg);
+    }
+
+    const uint32_t timers[] = { 0xFFFFFF, 0x1000000, 0xFFFFFFFF };
+    for (uint32_t timer : timers) {
+        frame.timerMs = timer;
+        GaggiMateFrame::encode(frame, bytes);
+        TEST_ASSERT_TRUE(GaggiMateFrame::decode(bytes, sizeof(bytes), decoded));
+        TEST_ASSERT_EQUAL_UINT32(0xFFFFFF, decoded.timerMs);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_extension_is_byte_equal_to_legacy);
+    RUN_TEST(test_extension_round_trip);
+    RUN_TEST(test_checksum_mismatch_is_rejected);
+    RUN_TEST(test_unknown_extension_version_decodes_as_none);
+    RUN_TEST(test_weight_and_timer_saturate_at_24_bits);
+    return UNITY_END();
+}
@@ -0,0 +1,175 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <new>
+#include <chrono>
+#include "JsonWriter.h"
+
+// Number formatting edges, escaping and the centigram formatter, plus the
+// time and heap cost of serialising a /api/dashboard-sized response.
+
+void setUp() {}
+void tearDown() {}
+
+// Heap allocations while counting is on - JsonWriter must make none
+static bool countAllocations = false;
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    if (countAllocations) {
+        allocations++;
+    }
+    void* p = malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+static char buffer[512];
+
+static const char* number(double value, uint8_t decimals) {
+    FixedBufferPrint out(buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.value(value, decimals);
+    return out.c_str();
+}
+
+void test_rounding_edges() {
+    // Rounded once from the double's actual value, as printf does: 0.005 is
+    // stored just above the half, 9.995 just below it
+    TEST_ASSERT_EQUAL_STRING("0.01", number(0.005, 2));
+    TEST_ASSERT_EQUAL_STRING("-0.01", number(-0.005, 2));
+    TEST_ASSERT_EQUAL_STRING("9.99", number(9.995, 2));
+    TEST_ASSERT_EQUAL_STRING("-9.99", number(-9.995, 2));
+    // Exact halves go away from zero, where printf would round to even
+    TEST_ASSERT_EQUAL_STRING("0.13", number(0.125, 2));
+    TEST_ASSERT_EQUAL_STRING("-2.3", number(-2.25, 1));
+    TEST_ASSERT_EQUAL_STRING("0.00", number(-0.004, 2)); // No negative zero
+    TEST_ASSERT_EQUAL_STRING("0", number(-0.4, 0));
+    TEST_ASSERT_EQUAL_STRING("1.0", number(0.95, 1));
+    TEST_ASSERT_EQUAL_STRING("18.25", number(18.25f, 2));
+    TEST_ASSERT_EQUAL_STRING("3.141593", number(M_PI, 9)); // At most 6 decimals
+}
+
+void test_non_finite_is_null() {
+    TEST_ASSERT_EQUAL_STRING("null", number(NAN, 2));
+    TEST_ASSERT_EQUAL_STRING("null", number(INFINITY, 2));
+    TEST_ASSERT_EQUAL_STRING("null", number(-INFINITY, 0));
+    TEST_ASSERT_EQUAL_STRING("null", number(1.0e13, 1)); // Beyond the integer formatter
+
+    FixedBufferPrint out(buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject().field("flow", (double)NAN, 2).field("weight", 1.5, 1).endObject();
+    TEST_ASSERT_EQUAL_STRING("{\"flow\":null,\"weight\":1.5}", out.c_str());
+}
+
+void test_strings_are_escaped() {
+    FixedBufferPrint out(buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginArray().value("a\"b\\c").value("line\nbreak\ttab\x01\x1f").value("caf\xc3\xa9").value((const char*)nullptr).endArray();
+    TEST_ASSERT_EQUAL_STRING("[\"a\\\"b\\\\c\",\"line\\u000abreak\\u0009tab\\u0001\\u001f\",\"caf\xc3\xa9\",null]", out.c_str());
+
+    out.clear();
+    JsonWriter keys(out);
+    keys.beginObject().field("ke\"y", true).endObject();
+    TEST_ASSERT_EQUAL_STRING("{\"ke\\\"y\":true}", out.c_str());
+}
+
+void test_centigrams_cover_int32() {
+    char text[16];
+    JsonWriter::formatCentigrams(text, sizeof(text), 3612, 2);
+    TEST_ASSERT_EQUAL_STRING("36.12", text);
+    JsonWriter::formatCentigrams(text, sizeof(text), -5, 2);
+    TEST_ASSERT_EQUAL_STRING("-0.05", text);
+    JsonWriter::formatCentigrams(text, sizeof(text), -4, 1);
+    TEST_ASSERT_EQUAL_STRING("0.0", text);
+    JsonWriter::formatCentigrams(text, sizeof(text), -5, 1);
+    TEST_ASSERT_EQUAL_STRING("-0.1", text);
+    JsonWriter::formatCentigrams(text, sizeof(text), INT32_MAX, 2);
+    TEST_ASSERT_EQUAL_STRING("21474836.47", text);
+    JsonWriter::formatCentigrams(text, sizeof(text), INT32_MIN, 2);
+    TEST_ASSERT_EQUAL_STRING("-21474836.48", text);
+    JsonWriter::formatCentigrams(text, sizeof(text), INT32_MIN, 1);
+    TEST_ASSERT_EQUAL_STRING("-21474836.5", text);
+
+    // Truncated to the buffer, length says what was kept
+    TEST_ASSERT_EQUAL_UINT32(4, JsonWriter::formatCentigrams(text, 5, -3612, 2));
+    TEST_ASSERT_EQUAL_STRING("-36.", text);
+}
+
+void test_overflow_is_flagged() {
+    char small[8];
+    FixedBufferPrint out(small, sizeof(small));
+    JsonWriter json(out);
+    json.beginObject().field("weight", 18.25, 2).endObject();
+    TEST_ASSERT_TRUE(out.overflowed());
+    TEST_ASSERT_TRUE(out.length() < sizeof(small));
+    TEST_ASSERT_EQUAL_CHAR('\0', small[out.length()]);
+}
+
+// The /api/dashboard fields, as WebServer.cpp writes them
+static size_t dashboard(FixedBufferPrint& out, int i) {
+    out.clear();
+    JsonWriter json(out);
+    json.beginObject();
+    json.fieldCentigrams("weight", 3612 + i % 100, 2);
+    json.field("flowrate", 1.8 + (i % 7) * 0.1, 1);
+    json.field("scale_connected", true);
+    json.field("timer_running", (i & 1) != 0);
+    json.field("timer_auto", false);
+    json.field("timer_elapsed", (unsigned long)(27480 + i));
+    json.field("timer_avg_flowrate", 1.72, 2);
+    json.field("shot_event_seq", (unsigned long)i);
+    json.field("battery_percentage", 87);
+    json.field("battery_low", false);
+    json.field("battery_critical", false);
+    json.field("wifi_signal_strength", -61);
+    json.field("wifi_signal_quality", "good");
+    json.field("bluetooth_connected", true);
+    json.field("bluetooth_signal_strength", -70);
+    json.endObject();
+    return out.length();
+}
+
+void test_dashboard_serialises_without_heap() {
+    FixedBufferPrint out(buffer, sizeof(buffer));
+    const int RESPONSES = 200000;
+    size_t bytes = 0;
+
+    allocations = 0;
+    countAllocations = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < RESPONSES; i++) {
+        bytes += dashboard(out, i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    countAllocations = false;
+
+    TEST_ASSERT_EQUAL_UINT32(0, allocations);
+    TEST_ASSERT_FALSE(out.overflowed());
+
+    char line[128];
+    snprintf(line, sizeof(line), "dashboard response: %zu bytes, %.0f ns to serialise on the host, 0 heap allocations",
+             bytes / RESPONSES, std::chrono::duration<double, std::nano>(elapsed).count() / RESPONSES);
+    TEST_MESSAGE(line);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_rounding_edges);
+    RUN_TEST(test_non_finite_is_null);
+    RUN_TEST(test_strings_are_escaped);
+    RUN_TEST(test_centigrams_cover_int32);
+    RUN_TEST(test_overflow_is_flagged);
+    RUN_TEST(test_dashboard_serialises_without_heap);
+    return UNITY_END();
+}
@@ -0,0 +1,230 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <random>
+#include "KalmanFilter.h"
+#include "WindowFilter.h"
+
+// Step and ramp simulation behind the Kalman defaults (q = 0.0013, r = 0.0025
+// for a 0.05 g load cell): the smart filter's 3-sample median feeding
+// FlowRate's finite difference, against WeightFlowKalman's joint estimate.
+// q is the largest that keeps flow noise at the smart chain's; the step
+// confirmation is what lets the weight keep up with the median.
+//
+//   ramp: 0 g for 2 s, then 2 g/s. Flow t90 is the time after the ramp
+//         starts until the reported flow reaches 1.8 g/s; flow noise is its
+//         standard deviation once settled (t > 8 s).
+//   step: 0 g for 2 s, then 3 g (below the 5 g reset, above the 2 g step
+//         threshold). Weight t90 is the time until the reported weight
+//         reaches 2.7 g.
+//
+// The noise comes from std::normal_distribution, whose draws differ between
+// standard libraries; the table in the Kalman commit is this run with
+// libstdc++. Noise is held to the smart chain's within 10% and flow t90 to
+// half of it - at 10 SPS that is 1.8 s against 1.85 s, so a smaller q fails.
+
+static const double SIGMA = 0.05;
+static const double RAMP_GPS = 2.0;
+static const double STEP_G = 3.0;
+
+void setUp() {}
+void tearDown() {}
+
+// FlowRate::update(weight, timestamp) as it differentiates filtered weight -
+// the timer averaging and pause handling it also does don't affect the flow
+class LegacyFlowRate {
+public:
+    LegacyFlowRate() : lastWeight(0), lastTime(0), flowRate(0), bufferIndex(0), bufferCount(0) {}
+
+    void update(float currentWeight, unsigned long now) {
+        if (lastTime == 0) {
+            lastWeight = currentWeight;
+            lastTime = now;
+            return;
+        }
+        float deltaWeight = currentWeight - lastWeight;
+        float deltaTime = (now - lastTime) / 1000.0f;
+        if (deltaTime < MIN_DELTA_TIME) {
+            return;
+        }
+        bool tareTransition = (lastWeight < -5.0f && fabsf(currentWeight) < 2.0f) || fabsf(deltaWeight) > 50.0f;
+        if (!tareTransition) {
+            bool weightRemoval = deltaWeight < -NEGATIVE_CHANGE_THRESHOLD;
+            if (fabsf(deltaWeight) < WEIGHT_DEADBAND) {
+                deltaWeight = 0.0f;
+            }
+            float instantRate = deltaWeight / deltaTime;
+            if (weightRemoval && fabsf(deltaWeight) > 1.0f) {
+                for (int i = 0; i < WINDOW; i++) {
+                    buffer[i] = 0.0f;
+                }
+                bufferCount = 1;
+                bufferIndex = 0;
+                buffer[0] = instantRate;
+            } else {
+                buffer[bufferIndex] = instantRate;
+                bufferIndex = (bufferIndex + 1) % WINDOW;
+                if (bufferCount < WINDOW) bufferCount++;
+            }
+            flowRate = stableAverage(weightRemoval);
+            if (fabsf(flowRate) < ZERO_THRESHOLD) {
+                flowRate = 0.0f;
+            }
+        } else {
+            flowRate = 0.0f;
+        }
+        lastWeight = currentWeight;
+        lastTime = now;
+    }
+
+    float getFlowRate() const { return flowRate; }
+
+private:
+    static const int WINDOW = 20;
+    static constexpr float WEIGHT_DEADBAND = 0.08f;
+    static constexpr float MIN_DELTA_TIME = 0.15f;
+    static constexpr float ZERO_THRESHOLD = 0.08f;
+    static constexpr float NEGATIVE_CHANGE_THRESHOLD = 0.5f;
+
+    float buffer[WINDOW] = {};
+    float lastWeight;
+    unsigned long lastTime;
+    float flowRate;
+    int bufferIndex;
+    int bufferCount;
+
+    float stableAverage(bool isWeightRemoval) const {
+        if (isWeightRemoval) {
+            int samplesToUse = bufferCount < 5 ? bufferCount : 5;
+            float sum = 0.0f;
+            for (int i = 0; i < samplesToUse; i++) {
+                sum += buffer[(bufferIndex - 1 - i + WINDOW) % WINDOW];
+            }
+            return sum / samplesToUse;
+        }
+        float weightedSum = 0.0f;
+        float totalWeight = 0.0f;
+        for (int i = 0; i < bufferCount; i++) {
+            float weight = 1.0f + (0.05f * (bufferCount - i));
+            weightedSum += buffer[(bufferIndex - 1 - i + WINDOW) % WINDOW] * weight;
+            totalWeight += weight;
+        }
+        return weightedSum / totalWeight;
+    }
+};
+
+struct Response {
+    double flowT90;
+    double flowNoise;
+    double weightT90;
+};
+
+// Reported weight and flow for one sample, as Scale and FlowRate publish them
+struct SmartChain {
+    SlidingMedian<float, 64> median;
+    LegacyFlowRate flowRate;
+    SmartChain() { median.reset(3, 0.0f); }
+    void update(float measurement, uint32_t ms, float& weight, float& flow) {
+        weight = median.push(measurement);
+        flowRate.update(weight, ms);
+        flow = flowRate.getFlowRate();
+    }
+};
+
+struct KalmanChain {
+    WeightFlowKalman kalman;
+    void update(float measurement, uint32_t ms, float& weight, float& flow) {
+        kalman.update(measurement, ms);
+        weight = kalman.weight();
+        flow = kalman.flow();
+        if (fabsf(flow) < 0.08f) flow = 0.0f; // FlowRate's zero threshold
+    }
+};
+
+template <typename Chain>
+static Response simulate(double sps) {
+    Response response = { -1, 0, -1 };
+    for (int ramp = 0; ramp < 2; ramp++) {
+        Chain chain;
+        std::mt19937 rng(42);
+        std::normal_distribution<double> noise(0.0, SIGMA);
+        double sum = 0, sumSquares = 0;
+        int settled = 0;
+        for (int i = 1; i < sps * 14; i++) {
+            double t = i / sps;
+            double truth = t < 2 ? 0 : (ramp ? RAMP_GPS * (t - 2) : STEP_G);
+            float weight, flow;
+            chain.update((float)(truth + noise(rng)), (uint32_t)(t * 1000), weight, flow);
+            if (ramp && t > 2 && response.flowT90 < 0 && flow >= 0.9 * RAMP_GPS) response.flowT90 = t - 2;
+            if (!ramp && t > 2 && response.weightT90 < 0 && weight >= 0.9 * STEP_G) response.weightT90 = t - 2;
+            if (ramp && t > 8) {
+                sum += flow;
+                sumSquares += flow * flow;
+                settled++;
+            }
+        }
+        if (ramp) {
+            response.flowNoise = sqrt(sumSquares / settled - (sum / settled) * (sum / settled));
+        }
+    }
+    return response;
+}
+
+void test_kalman_flow_leads_the_finite_difference() {
+    TEST_MESSAGE("           SPS  flow t90  flow noise  weight t90");
+    const double rates[] = { 10.0, 80.0 };
+    for (double sps : rates) {
+        Response smart = simulate<SmartChain>(sps);
+        Response kalman = simulate<KalmanChain>(sps);
+        char line[96];
+        snprintf(line, sizeof(line), "smart   %6.0f  %7.2fs  %7.4f g/s  %9.2fs", sps, smart.flowT90, smart.flowNoise, smart.weightT90);
+        TEST_MESSAGE(line);
+        snprintf(line, sizeof(line), "kalman  %6.0f  %7.2fs  %7.4f g/s  %9.2fs", sps, kalman.flowT90, kalman.flowNoise, kalman.weightT90);
+        TEST_MESSAGE(line);
+
+        TEST_ASSERT_TRUE(smart.flowT90 > 0 && kalman.flowT90 > 0);
+        TEST_ASSERT_TRUE(kalman.flowT90 < smart.flowT90 / 2);
+        TEST_ASSERT_TRUE(kalman.flowNoise <= smart.flowNoise * 1.1); // Speed not bought with noise
+        TEST_ASSERT_TRUE(kalman.weightT90 > 0 && kalman.weightT90 <= smart.weightT90);
+    }
+}
+
+void test_large_step_resets_instead_of_ramping() {
+    // A cup placed on the scale is beyond the reset threshold - the estimate
+    // jumps to it and does not report the step as flow
+    WeightFlowKalman kalman;
+    for (uint32_t ms = 0; ms <= 2000; ms += 100) {
+        kalman.update(0.0f, ms);
+    }
+    kalman.update(250.0f, 2100);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 250.0f, kalman.weight());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, kalman.flow());
+}
+
+void test_single_outlier_is_skipped() {
+    // One spike beyond the step threshold is not a step - the estimate
+    // ignores it instead of restarting there
+    WeightFlowKalman kalman;
+    for (uint32_t ms = 0; ms <= 2000; ms += 100) {
+        kalman.update(10.0f, ms);
+    }
+    kalman.update(13.0f, 2100);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 10.0f, kalman.weight());
+    kalman.update(10.0f, 2200);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 10.0f, kalman.weight());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, kalman.flow());
+
+    // Two in a row on the same side are
+    kalman.update(13.0f, 2300);
+    kalman.update(13.0f, 2400);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 13.0f, kalman.weight());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, kalman.flow());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_kalman_flow_leads_the_finite_difference);
+    RUN_TEST(test_large_step_resets_instead_of_ramping);
+    RUN_TEST(test_single_outlier_is_skipped);
+    return UNITY_END();
+}
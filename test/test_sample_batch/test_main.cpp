@@ -0,0 +1,228 @@
+#include <unity.h>
+#include "SampleBatchCodec.h"
+
+// Payload sizes of the notifications the device sends: default ATT MTU,
+// a typical phone MTU and the largest NimBLE negotiates
+static const size_t PAYLOAD_SIZES[] = { 20, 182, 244 };
+
+void setUp() {}
+void tearDown() {}
+
+// Sends what the encoder holds and starts the next frame, like
+// BluetoothScale::flushBatch()
+struct Link {
+    uint8_t frame[244];
+    SampleBatchEncoder encoder;
+    BatchSample decoded[255];
+    size_t frames;
+    size_t bytes;
+    size_t received;
+    size_t mismatches;
+    const BatchSample* expected;
+
+    void begin(size_t payload, const BatchSample* stream) {
+        encoder.begin(frame, payload);
+        frames = bytes = received = mismatches = 0;
+        expected = stream;
+    }
+
+    void flush() {
+        if (encoder.empty()) {
+            return;
+        }
+        size_t count = SampleBatch::decode(encoder.data(), encoder.size(), decoded, 255);
+        TEST_ASSERT_EQUAL(encoder.samples(), count);
+        for (size_t i = 0; i < count; i++) {
+            const BatchSample& want = expected[received + i];
+            if (decoded[i].sequence != want.sequence || decoded[i].timestampMs != want.timestampMs ||
+                decoded[i].weightCg != want.weightCg) {
+                mismatches++;
+            }
+        }
+        received += count;
+        frames++;
+        bytes += encoder.size();
+        encoder.reset();
+    }
+
+    void send(const BatchSample& sample) {
+        if (!encoder.add(sample)) {
+            flush();
+            TEST_ASSERT_TRUE(encoder.add(sample));
+        }
+    }
+};
+
+static uint32_t lcg(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// 80 SPS pour with jitter, noise and the awkward cases mixed in: sequence
+// gaps (dropped samples), 70 s timestamp jumps (idle), sequence and millis()
+// wrap, and full-scale weight steps
+static void makeStream(BatchSample* out, size_t count) {
+    uint32_t state = 12345;
+    uint32_t sequence = 0xFFFFF000u;
+    uint32_t timeMs = 0xFFFF0000u;
+    int32_t weightCg = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t r = lcg(state);
+        if (r % 997 == 0) {
+            sequence += 1 + r % 5;
+        }
+        if (r % 1999 == 0) {
+            timeMs += 70000;
+        }
+        if (r % 1499 == 0) {
+            weightCg = (r & 1) ? 500000 : -500000;
+        }
+        timeMs += 12 + r % 3;
+        weightCg += (int32_t)(r % 41) - 10;
+        out[i] = { sequence++, timeMs, weightCg };
+    }
+}
+
+static BatchSample stream[200000];
+
+void test_round_trip_at_every_payload_size() {
+    // Throughput floor per payload size: samples carried per notification
+    const size_t minSamplesPerFrame[] = { 3, 80, 108 };
+    const size_t count = sizeof(stream) / sizeof(stream[0]);
+    makeStream(stream, count);
+    for (size_t i = 0; i < 3; i++) {
+        static Link link;
+        link.begin(PAYLOAD_SIZES[i], stream);
+        for (size_t j = 0; j < count; j++) {
+            link.send(stream[j]);
+        }
+        link.flush();
+        TEST_ASSERT_EQUAL(count, link.received);
+        TEST_ASSERT_EQUAL(0, link.mismatches);
+        TEST_ASSERT_GREATER_OR_EQUAL(minSamplesPerFrame[i], count / link.frames);
+    }
+}
+
+void test_sequence_gap_starts_a_new_frame() {
+    uint8_t frame[64];
+    SampleBatchEncoder encoder;
+    encoder.begin(frame, sizeof(frame));
+    TEST_ASSERT_TRUE(encoder.add({ 10, 1000, 500 }));
+    TEST_ASSERT_TRUE(encoder.add({ 11, 1012, 505 }));
+    size_t size = encoder.size();
+
+    TEST_ASSERT_FALSE(encoder.add({ 13, 1037, 512 }));
+    TEST_ASSERT_EQUAL(2, encoder.samples());
+    TEST_ASSERT_EQUAL(size, encoder.size());
+
+    BatchSample decoded[4];
+    TEST_ASSERT_EQUAL(2, SampleBatch::decode(frame, encoder.size(), decoded, 4));
+    TEST_ASSERT_EQUAL_UINT32(11, decoded[1].sequence);
+    TEST_ASSERT_EQUAL_INT32(505, decoded[1].weightCg);
+
+    encoder.reset();
+    TEST_ASSERT_TRUE(encoder.add({ 13, 1037, 512 }));
+    TEST_ASSERT_EQUAL(1, SampleBatch::decode(frame, encoder.size(), decoded, 4));
+    TEST_ASSERT_EQUAL_UINT32(13, decoded[0].sequence);
+}
+
+void test_timestamp_jump_is_carried_exactly() {
+    uint8_t frame[64];
+    SampleBatchEncoder encoder;
+    encoder.begin(frame, sizeof(frame));
+    TEST_ASSERT_TRUE(encoder.add({ 1, 5000, 0 }));
+    TEST_ASSERT_TRUE(encoder.add({ 2, 75000, 0 }));          // Idle for 70 s
+    TEST_ASSERT_TRUE(encoder.add({ 3, 75000 + 0xFFFFFFF, 0 })); // Longest 4-byte varint
+
+    BatchSample decoded[4];
+    TEST_ASSERT_EQUAL(3, SampleBatch::decode(frame, encoder.size(), decoded, 4));
+    TEST_ASSERT_EQUAL_UINT32(75000, decoded[1].timestampMs);
+    TEST_ASSERT_EQUAL_UINT32(75000 + 0xFFFFFFF, decoded[2].timestampMs);
+}
+
+void test_sequence_and_millis_wrap() {
+    uint8_t frame[64];
+    SampleBatchEncoder encoder;
+    encoder.begin(frame, sizeof(frame));
+    TEST_ASSERT_TRUE(encoder.add({ 0xFFFFFFFE, 0xFFFFFFF0, -1000000 }));
+    TEST_ASSERT_TRUE(encoder.add({ 0xFFFFFFFF, 0xFFFFFFFC, 1000000 })); // 20 kg step
+    TEST_ASSERT_TRUE(encoder.add({ 0, 8, 0 }));
+
+    BatchSample decoded[4];
+    TEST_ASSERT_EQUAL(3, SampleBatch::decode(frame, encoder.size(), decoded, 4));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, decoded[1].sequence);
+    TEST_ASSERT_EQUAL_INT32(1000000, decoded[1].weightCg);
+    TEST_ASSERT_EQUAL_UINT32(0, decoded[2].sequence);
+    TEST_ASSERT_EQUAL_UINT32(8, decoded[2].timestampMs);
+    TEST_ASSERT_EQUAL_INT32(0, decoded[2].weightCg);
+}
+
+void test_frame_never_exceeds_the_payload() {
+    for (size_t payload : PAYLOAD_SIZES) {
+        uint8_t frame[244 + 1];
+        frame[payload] = 0xA5; // Guard byte
+        SampleBatchEncoder encoder;
+        encoder.begin(frame, payload);
+        uint32_t state = 99;
+        uint32_t sequence = 0;
+        while (encoder.add({ sequence, sequence * 12, (int32_t)lcg(state) })) {
+            sequence++;
+        }
+        TEST_ASSERT_LESS_OR_EQUAL(payload, encoder.size());
+        TEST_ASSERT_EQUAL_HEX8(0xA5, frame[payload]);
+        TEST_ASSERT_GREATER_OR_EQUAL(1, encoder.samples());
+    }
+
+    // Too small for a header and one worst-case weight
+    uint8_t tiny[SAMPLE_BATCH_HEADER_SIZE + 4];
+    SampleBatchEncoder encoder;
+    encoder.begin(tiny, sizeof(tiny));
+    TEST_ASSERT_FALSE(encoder.add({ 0, 0, 0 }));
+}
+
+void test_steady_pour_costs_two_bytes_per_sample() {
+    // 2 g/s at 80 SPS: 12-13 ms and a few centigrams between samples
+    const size_t expected[] = { 5, 86, 117 };
+    for (size_t i = 0; i < 3; i++) {
+        uint8_t frame[244];
+        SampleBatchEncoder encoder;
+        encoder.begin(frame, PAYLOAD_SIZES[i]);
+        uint32_t sequence = 0;
+        while (encoder.add({ sequence, sequence * 25 / 2, 1800 + (int32_t)sequence * 5 / 2 })) {
+            sequence++;
+        }
+        TEST_ASSERT_EQUAL(expected[i], encoder.samples());
+        TEST_ASSERT_LESS_OR_EQUAL(SAMPLE_BATCH_HEADER_SIZE + 2 * expected[i] + 1, encoder.size());
+    }
+}
+
+void test_decode_rejects_malformed_frames() {
+    uint8_t frame[64];
+    SampleBatchEncoder encoder;
+    encoder.begin(frame, sizeof(frame));
+    for (uint32_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(encoder.add({ i, i * 12, (int32_t)i * 300 }));
+    }
+    size_t size = encoder.size();
+    BatchSample decoded[8];
+    TEST_ASSERT_EQUAL(5, SampleBatch::decode(frame, size, decoded, 8));
+
+    TEST_ASSERT_EQUAL(0, SampleBatch::decode(frame, size - 1, decoded, 8)); // Truncated
+    TEST_ASSERT_EQUAL(0, SampleBatch::decode(frame, size, decoded, 4));     // More than the caller holds
+    frame[size] = 0;
+    TEST_ASSERT_EQUAL(0, SampleBatch::decode(frame, size + 1, decoded, 8)); // Trailing bytes
+    frame[0] = SAMPLE_BATCH_VERSION + 1;
+    TEST_ASSERT_EQUAL(0, SampleBatch::decode(frame, size, decoded, 8));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_at_every_payload_size);
+    RUN_TEST(test_sequence_gap_starts_a_new_frame);
+    RUN_TEST(test_timestamp_jump_is_carried_exactly);
+    RUN_TEST(test_sequence_and_millis_wrap);
+    RUN_TEST(test_frame_never_exceeds_the_payload);
+    RUN_TEST(test_steady_pour_costs_two_bytes_per_sample);
+    RUN_TEST(test_decode_rejects_malformed_frames);
+    return UNITY_END();
+}
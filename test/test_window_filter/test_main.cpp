@@ -0,0 +1,253 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <deque>
+#include "WindowFilter.h"
+
+// Compares SlidingMean/SlidingMedian against the per-sample re-sum and
+// bubble sort Scale used before them, for agreement and for time per sample,
+// and SlidingSlope's running sums against a direct least-squares fit.
+// The timings are host numbers - the ratio between old and new is what
+// carries over to the ESP32 (Scale reports device cycles as filterCycles).
+
+static const size_t MAX_WINDOW = 64;
+static const size_t WINDOW_SIZES[] = { 5, 10, 32, 64 };
+static const size_t BENCH_SAMPLES = 200000;
+
+void setUp() {}
+void tearDown() {}
+
+// Scale::medianFilter() and Scale::averageFilter() as they were, over a ring
+// of MAX_WINDOW readings instead of the old MAX_SAMPLES = 10
+struct OldFilters {
+    float readings[MAX_WINDOW];
+    int readingIndex;
+
+    void reset(float fill) {
+        for (size_t i = 0; i < MAX_WINDOW; i++) {
+            readings[i] = fill;
+        }
+        readingIndex = 0;
+    }
+
+    void add(float value) {
+        readings[readingIndex] = value;
+        readingIndex = (readingIndex + 1) % MAX_WINDOW;
+    }
+
+    float medianFilter(int samples) {
+        float temp[MAX_WINDOW];
+        for (int i = 0; i < samples; i++) {
+            int idx = (readingIndex - 1 - i + MAX_WINDOW) % MAX_WINDOW;
+            temp[i] = readings[idx];
+        }
+        for (int i = 0; i < samples - 1; i++) {
+            for (int j = 0; j < samples - i - 1; j++) {
+                if (temp[j] > temp[j + 1]) {
+                    float swap = temp[j];
+                    temp[j] = temp[j + 1];
+                    temp[j + 1] = swap;
+                }
+            }
+        }
+        return temp[samples / 2];
+    }
+
+    float averageFilter(int samples) {
+        float sum = 0;
+        int validSamples = 0;
+        for (int i = 0; i < samples; i++) {
+            int idx = (readingIndex - 1 - i + MAX_WINDOW) % MAX_WINDOW;
+            sum += readings[idx];
+            validSamples++;
+        }
+        return sum / validSamples;
+    }
+};
+
+// Load cell counts: a slow ramp with noise and the odd spike
+static int32_t makeSample(uint32_t& state, size_t i) {
+    state = state * 1664525u + 1013904223u;
+    int32_t noise = (int32_t)(state >> 24) - 128;
+    int32_t spike = (state & 0xFFF) == 0 ? 20000 : 0;
+    return 84000 + (int32_t)(i / 4) + noise + spike;
+}
+
+static volatile float floatSink;
+static volatile int32_t intSink;
+
+template <typename F>
+static double nsPerSample(F step) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < BENCH_SAMPLES; i++) {
+        step(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / BENCH_SAMPLES;
+}
+
+void test_median_matches_sort() {
+    for (size_t window : WINDOW_SIZES) {
+        OldFilters old;
+        SlidingMedian<float, MAX_WINDOW> median;
+        SlidingMedian<int32_t, MAX_WINDOW> medianCounts;
+        old.reset(0.0f);
+        median.reset(window, 0.0f);
+        medianCounts.reset(window, 0);
+        uint32_t state = 1;
+        for (size_t i = 0; i < 20000; i++) {
+            int32_t sample = makeSample(state, i);
+            old.add((float)sample);
+            float expected = old.medianFilter(window);
+            TEST_ASSERT_TRUE(expected == median.push((float)sample));
+            TEST_ASSERT_EQUAL_INT32((int32_t)expected, medianCounts.push(sample));
+        }
+    }
+}
+
+void test_mean_matches_resum() {
+    for (size_t window : WINDOW_SIZES) {
+        OldFilters old;
+        SlidingMean<float, float, MAX_WINDOW> mean;
+        SlidingMean<int32_t, int64_t, MAX_WINDOW> meanCounts;
+        old.reset(0.0f);
+        mean.reset(window, 0.0f);
+        meanCounts.reset(window, 0);
+        uint32_t state = 2;
+        int64_t window64[MAX_WINDOW] = {};
+        for (size_t i = 0; i < 20000; i++) {
+            int32_t sample = makeSample(state, i);
+            old.add((float)sample);
+            // Float sums differ only in rounding; counts are exact
+            TEST_ASSERT_FLOAT_WITHIN(0.05f, old.averageFilter(window), mean.push((float)sample));
+            window64[i % window] = sample;
+            int64_t sum = 0;
+            for (size_t j = 0; j < window; j++) {
+                sum += window64[j];
+            }
+            TEST_ASSERT_EQUAL_INT32((int32_t)(sum / (int64_t)window), meanCounts.push(sample));
+        }
+    }
+}
+
+// Least squares over the same window, refitted from scratch in double
+struct DirectFit {
+    double slope;
+    double residualRms;
+    double slopeStdError;
+};
+
+static DirectFit directFit(const std::deque<std::pair<uint32_t, int32_t>>& window) {
+    double n = (double)window.size();
+    uint32_t origin = window.front().first;
+    double meanT = 0, meanY = 0;
+    for (const auto& sample : window) {
+        meanT += (double)(uint32_t)(sample.first - origin); // Unwrapped across 2^32
+        meanY += sample.second;
+    }
+    meanT /= n;
+    meanY /= n;
+    double stt = 0, sty = 0;
+    for (const auto& sample : window) {
+        double t = (double)(uint32_t)(sample.first - origin) - meanT;
+        stt += t * t;
+        sty += t * (sample.second - meanY);
+    }
+    DirectFit fit;
+    fit.slope = sty / stt;
+    double sse = 0;
+    for (const auto& sample : window) {
+        double t = (double)(uint32_t)(sample.first - origin) - meanT;
+        double residual = sample.second - meanY - fit.slope * t;
+        sse += residual * residual;
+    }
+    fit.residualRms = sqrt(sse / (n - 2));
+    fit.slopeStdError = fit.residualRms / sqrt(stt);
+    return fit;
+}
+
+void test_slope_matches_direct_fit_across_wrap() {
+    const size_t N = 128;
+    const uint32_t WINDOW_MS = 1500;
+    SlidingSlope<N> slope;
+    slope.setWindowMs(WINDOW_MS);
+    std::deque<std::pair<uint32_t, int32_t>> window;
+
+    // Start 100 s before millis() wraps and run 200 s: several rebases on
+    // either side of the wrap, one of them across it
+    uint32_t now = 0xFFFFFFFFu - 100000;
+    uint32_t state = 4;
+    int checked = 0;
+    for (size_t i = 0; i < 16000; i++) {
+        state = state * 1664525u + 1013904223u;
+        now += 10 + (state >> 29);                         // 80-100 SPS with jitter
+        if (i == 8000) {
+            now += 5000;                                   // Gap longer than the window - starts over
+        }
+        int32_t value = 84000 + (int32_t)(i * 3) + (int32_t)((state >> 20) & 0xFF) - 128;
+
+        slope.push(now, value);
+        while (!window.empty() && (window.size() == N || now - window.front().first > WINDOW_MS)) {
+            window.pop_front();
+        }
+        window.push_back({ now, value });
+
+        TEST_ASSERT_EQUAL_UINT32(window.size(), slope.size());
+        TEST_ASSERT_EQUAL_UINT32(now - window.front().first, slope.spanMs());
+        if (window.size() < 3) {
+            TEST_ASSERT_FALSE(slope.valid());
+            continue;
+        }
+        TEST_ASSERT_TRUE(slope.valid());
+        DirectFit fit = directFit(window);
+        // The sums are exact; only the final float division rounds
+        TEST_ASSERT_TRUE(fabs(slope.slope() - fit.slope) <= 1e-5 * fabs(fit.slope) + 1e-6);
+        TEST_ASSERT_TRUE(fabs(slope.residualRms() - fit.residualRms) <= 1e-3 * fit.residualRms + 1e-3);
+        TEST_ASSERT_TRUE(fabs(slope.slopeStdError() - fit.slopeStdError) <= 1e-3 * fit.slopeStdError + 1e-7);
+        checked++;
+    }
+    TEST_ASSERT_TRUE(checked > 15000);
+}
+
+void test_benchmark_old_and_new() {
+    char line[128];
+    TEST_MESSAGE("ns/sample  window  old median  new median  old mean  new mean");
+    for (size_t window : WINDOW_SIZES) {
+        OldFilters old;
+        SlidingMedian<int32_t, MAX_WINDOW> median;
+        SlidingMean<int32_t, int64_t, MAX_WINDOW> mean;
+        int32_t samples[1024];
+        uint32_t state = 3;
+        for (size_t i = 0; i < 1024; i++) {
+            samples[i] = makeSample(state, i);
+        }
+        old.reset(0.0f);
+        median.reset(window, 0);
+        mean.reset(window, 0);
+
+        double oldMedian = nsPerSample([&](size_t i) {
+            old.add((float)samples[i & 1023]);
+            floatSink = old.medianFilter(window);
+        });
+        double newMedian = nsPerSample([&](size_t i) { intSink = median.push(samples[i & 1023]); });
+        double oldMean = nsPerSample([&](size_t i) {
+            old.add((float)samples[i & 1023]);
+            floatSink = old.averageFilter(window);
+        });
+        double newMean = nsPerSample([&](size_t i) { intSink = mean.push(samples[i & 1023]); });
+
+        snprintf(line, sizeof(line), "%17u  %10.1f  %10.1f  %8.1f  %8.1f",
+                 (unsigned)window, oldMedian, newMedian, oldMean, newMean);
+        TEST_MESSAGE(line);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_median_matches_sort);
+    RUN_TEST(test_mean_matches_resum);
+    RUN_TEST(test_slope_matches_direct_fit_across_wrap);
+    RUN_TEST(test_benchmark_old_and_new);
+    return UNITY_END();
+}
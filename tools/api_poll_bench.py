@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Poll the scale's JSON API from several clients at a fixed rate.
+
+Each client requests its endpoints round-robin at --rate Hz, the way open
+dashboard tabs and brewing controllers do. At the end the script prints
+achieved requests/s, latency percentiles and errors per endpoint, plus the
+device heap before and after: min_free is the heap low-water mark since boot
+and max_alloc the largest free block, which shrinks as the heap fragments.
+
+  python tools/api_poll_bench.py --host weighmybru.local --clients 4 --rate 20 --seconds 60
+
+Standard library only.
+"""
+
+import argparse
+import json
+import threading
+import time
+import urllib.request
+
+DEFAULT_ENDPOINTS = [
+    "/api/dashboard",
+    "/api/brew/status",
+    "/api/signal-strength",
+    "/api/bluetooth/status",
+    "/api/battery",
+]
+
+
+def fetch(base, path, timeout):
+    with urllib.request.urlopen(base + path, timeout=timeout) as response:
+        body = response.read()
+        if response.headers.get_content_type() == "application/json":
+            json.loads(body)  # A truncated or malformed document counts as an error
+        return len(body)
+
+
+def heap(base, timeout):
+    with urllib.request.urlopen(base + "/api/heap", timeout=timeout) as response:
+        return json.loads(response.read())
+
+
+def percentile(values, fraction):
+    if not values:
+        return float("nan")
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def client(base, endpoints, period, deadline, timeout, results, lock, offset):
+    index = offset
+    next_at = time.monotonic()
+    while next_at < deadline:
+        path = endpoints[index % len(endpoints)]
+        index += 1
+        started = time.monotonic()
+        try:
+            size = fetch(base, path, timeout)
+            error = None
+        except Exception as exc:  # Timeouts, resets, bad JSON
+            size = 0
+            error = type(exc).__name__
+        elapsed = time.monotonic() - started
+        with lock:
+            entry = results.setdefault(path, {"latency": [], "errors": {}, "bytes": 0})
+            if error is None:
+                entry["latency"].append(elapsed)
+                entry["bytes"] += size
+            else:
+                entry["errors"][error] = entry["errors"].get(error, 0) + 1
+        next_at += period
+        delay = next_at - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        else:
+            next_at = time.monotonic()  # Fell behind - do not burst to catch up
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="weighmybru.local")
+    parser.add_argument("--clients", type=int, default=4)
+    parser.add_argument("--rate", type=float, default=20.0, help="requests per second per client")
+    parser.add_argument("--seconds", type=float, default=60.0)
+    parser.add_argument("--timeout", type=float, default=2.0)
+    parser.add_argument("--endpoint", action="append", help="repeatable, defaults to the dashboard set")
+    args = parser.parse_args()
+
+    base = "http://" + args.host
+    endpoints = args.endpoint or DEFAULT_ENDPOINTS
+    before = heap(base, args.timeout)
+
+    results = {}
+    lock = threading.Lock()
+    started = time.monotonic()
+    deadline = started + args.seconds
+    threads = [
+        threading.Thread(target=client, daemon=True,
+                         args=(base, endpoints, 1.0 / args.rate, deadline, args.timeout, results, lock, i))
+        for i in range(args.clients)
+    ]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    duration = time.monotonic() - started
+    after = heap(base, args.timeout)
+
+    total = sum(len(entry["latency"]) for entry in results.values())
+    failed = sum(sum(entry["errors"].values()) for entry in results.values())
+    target = args.clients * args.rate
+    print(f"{args.clients} clients x {args.rate:g} Hz for {duration:.1f} s")
+    print(f"requests/s: {total / duration:.1f} ok (target {target:g}), {failed} errors")
+    print(f"{'endpoint':28} {'ok':>6} {'err':>5} {'p50 ms':>7} {'p99 ms':>7} {'bytes':>6}")
+    for path in endpoints:
+        entry = results.get(path, {"latency": [], "errors": {}, "bytes": 0})
+        ok = len(entry["latency"])
+        print(f"{path:28} {ok:6} {sum(entry['errors'].values()):5} "
+              f"{percentile(entry['latency'], 0.5) * 1000:7.1f} {percentile(entry['latency'], 0.99) * 1000:7.1f} "
+              f"{entry['bytes'] // ok if ok else 0:6}")
+        for error, count in entry["errors"].items():
+            print(f"  {error}: {count}")
+    print(f"heap free:      {before['free']:7} -> {after['free']:7}")
+    print(f"heap min_free:  {before['min_free']:7} -> {after['min_free']:7} (low-water mark)")
+    print(f"heap max_alloc: {before['max_alloc']:7} -> {after['max_alloc']:7} (largest block)")
+
+
+if __name__ == "__main__":
+    main()
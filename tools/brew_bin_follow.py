@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""Follow the scale's samples through the /api/brew/bin long-poll.
+
+Loops on GET /api/brew/bin?since=<last sequence> the way a machine
+controller would, and reports how many samples arrived, how many were
+skipped (sequence gaps - the weight task published more than one between
+two requests), timeouts, and the sample age the device stamped on each
+frame plus the request round trip.
+
+  python tools/brew_bin_follow.py --host weighmybru.local --seconds 30
+
+Standard library only.
+"""
+
+import argparse
+import statistics
+import struct
+import time
+import urllib.request
+
+FRAME = struct.Struct("<BBBxiIIhH")  # include/BrewFrame.h
+FLAG_STABLE = 0x01
+
+
+def fetch(base, since, wait, timeout):
+    url = base + "/api/brew/bin"
+    if since is not None:
+        url += "?since=%d&wait=%d" % (since, wait)
+    with urllib.request.urlopen(url, timeout=timeout) as response:
+        body = response.read()
+    version, flags, state, weight, timer, sequence, flow, age = FRAME.unpack(body[:FRAME.size])
+    if version != 1:
+        raise ValueError("unknown frame version %d" % version)
+    return {"flags": flags, "weight": weight / 100.0, "timer": timer, "sequence": sequence,
+            "flow": flow / 100.0, "age": age}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="weighmybru.local")
+    parser.add_argument("--seconds", type=float, default=30.0)
+    parser.add_argument("--wait", type=int, default=1000, help="long-poll hold in ms")
+    parser.add_argument("--verbose", action="store_true", help="print every frame")
+    args = parser.parse_args()
+
+    base = "http://" + args.host
+    frame = fetch(base, None, 0, 5.0)
+    since = frame["sequence"]
+    received = skipped = timeouts = 0
+    ages, trips = [], []
+    deadline = time.monotonic() + args.seconds
+    while time.monotonic() < deadline:
+        started = time.monotonic()
+        frame = fetch(base, since, args.wait, args.wait / 1000.0 + 5.0)
+        trips.append(time.monotonic() - started)
+        if frame["sequence"] == since:
+            timeouts += 1
+            continue
+        received += 1
+        skipped += max(0, (frame["sequence"] - since - 1) & 0xFFFFFFFF)
+        ages.append(frame["age"])
+        since = frame["sequence"]
+        if args.verbose:
+            print("%10d %8.2f g %6.2f g/s %7d ms %s" % (frame["sequence"], frame["weight"], frame["flow"],
+                  frame["timer"], "stable" if frame["flags"] & FLAG_STABLE else ""))
+
+    print("samples %d, skipped %d, timeouts %d" % (received, skipped, timeouts))
+    if ages:
+        print("sample age at response: median %d ms, max %d ms" % (statistics.median(ages), max(ages)))
+    if trips:
+        print("request round trip: median %.1f ms" % (statistics.median(trips) * 1000))
+
+
+if __name__ == "__main__":
+    main()
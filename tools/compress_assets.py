@@ -0,0 +1,136 @@
+"""Stage data/ for the LittleFS image: gzip, version and index the web assets.
+
+Runs as a PlatformIO pre script (extra_scripts in platformio.ini) before
+buildfs/uploadfs, and points the filesystem build at the staged copy in
+.pio/build/<env>/littlefs_data. data/ itself is never modified.
+
+For every file under data/:
+  - text assets (html, css, js, json, svg) are stored as <name>.gz only,
+    when compression makes them smaller
+  - everything else (woff2, png) is copied as is
+  - local references in html and css are rewritten to /path?v=<etag>, so the
+    server can mark them immutable and a new build changes the URL
+  - /assets.manifest lists "<path> <etag> <g|-> <stored bytes>" for
+    StaticAssets on the device
+
+The ETag is a short content hash taken after rewriting, so a page changes
+its ETag whenever an asset it references changes.
+
+Run standalone to stage into a directory and print the size table:
+
+  python tools/compress_assets.py data /tmp/littlefs_data
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import sys
+
+COMPRESSIBLE = (".html", ".css", ".js", ".json", ".svg")
+MANIFEST = "assets.manifest"
+
+# src="/x", href="/x" in html and url(../x) in css
+HTML_REF = re.compile(r'((?:src|href)=")(/[^"?#]+)(")')
+CSS_REF = re.compile(r'(url\()([^)"\'?#]+)(\))')
+
+
+def etag(content):
+    return hashlib.sha256(content).hexdigest()[:12]
+
+
+def collect(source):
+    files = []
+    for root, _, names in os.walk(source):
+        for name in sorted(names):
+            full = os.path.join(root, name)
+            files.append("/" + os.path.relpath(full, source).replace(os.sep, "/"))
+    # Leaf assets first, then css (references fonts), then html (references both)
+    order = {".css": 1, ".html": 2}
+    return sorted(files, key=lambda path: (order.get(os.path.splitext(path)[1], 0), path))
+
+
+def rewrite(path, content, tags):
+    extension = os.path.splitext(path)[1]
+    if extension not in (".html", ".css"):
+        return content
+    text = content.decode("utf-8")
+
+    def versioned(target):
+        return target + "?v=" + tags[target] if target in tags and not target.endswith(".html") else None
+
+    if extension == ".html":
+        def html(match):
+            url = versioned(match.group(2))
+            return match.group(1) + url + match.group(3) if url else match.group(0)
+        text = HTML_REF.sub(html, text)
+    else:
+        base = os.path.dirname(path)
+
+        def css(match):
+            target = os.path.normpath(os.path.join(base, match.group(2))).replace(os.sep, "/")
+            url = versioned(target)
+            return match.group(1) + match.group(2) + url[len(target):] + match.group(3) if url else match.group(0)
+        text = CSS_REF.sub(css, text)
+    return text.encode("utf-8")
+
+
+def stage(source, destination):
+    if os.path.isdir(destination):
+        shutil.rmtree(destination)
+    os.makedirs(destination)
+
+    tags = {}
+    rows = []
+    manifest = []
+    for path in collect(source):
+        with open(os.path.join(source, path[1:]), "rb") as handle:
+            original = handle.read()
+        content = rewrite(path, original, tags)
+        tag = etag(content)
+        tags[path] = tag
+
+        stored = content
+        compressed = False
+        if path.endswith(COMPRESSIBLE):
+            packed = gzip.compress(content, compresslevel=9, mtime=0)
+            if len(packed) < len(content):
+                stored = packed
+                compressed = True
+
+        target = os.path.join(destination, path[1:] + (".gz" if compressed else ""))
+        os.makedirs(os.path.dirname(target), exist_ok=True)
+        with open(target, "wb") as handle:
+            handle.write(stored)
+        manifest.append("%s %s %s %d" % (path, tag, "g" if compressed else "-", len(stored)))
+        rows.append((path, len(original), len(stored)))
+
+    with open(os.path.join(destination, MANIFEST), "w") as handle:
+        handle.write("\n".join(manifest) + "\n")
+    return rows
+
+
+def report(rows):
+    print("%-32s %9s %9s" % ("asset", "bytes", "stored"))
+    for path, before, after in rows:
+        print("%-32s %9d %9d" % (path, before, after))
+    before = sum(row[1] for row in rows)
+    after = sum(row[2] for row in rows)
+    print("%-32s %9d %9d (%.0f%%)" % ("total", before, after, 100.0 * after / before if before else 0))
+
+
+try:
+    Import("env")  # noqa: F821 - provided by SCons under PlatformIO
+except NameError:
+    env = None
+
+if env is not None:
+    if any(target in COMMAND_LINE_TARGETS for target in ("buildfs", "uploadfs", "uploadfsota")):  # noqa: F821
+        staged = os.path.join(env.subst("$BUILD_DIR"), "littlefs_data")
+        report(stage(env.subst("$PROJECT_DATA_DIR"), staged))
+        env.Replace(PROJECT_DATA_DIR=staged)
+elif __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit("usage: compress_assets.py <data dir> <staging dir>")
+    report(stage(sys.argv[1], sys.argv[2]))
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Measure what a page load of the web UI costs over WiFi.
+
+Loads a page the way a browser does: the HTML first, then every local
+stylesheet, script, icon and font it references (including url() inside the
+stylesheets) over up to six parallel connections. "ready" is the time until
+the last of those has arrived - the point where Alpine has run and the page
+is interactive. Bytes are counted as they cross the air, before gzip decoding.
+
+Each run is done cold (empty cache) and warm (a second visit): the warm load
+skips URLs served as immutable and revalidates the rest with If-None-Match,
+so against the staged image it should be a handful of 304s.
+
+  python tools/page_load_bench.py --host weighmybru.local --page / --runs 5
+
+Standard library only.
+"""
+
+import argparse
+import gzip
+import re
+import statistics
+import threading
+import time
+import urllib.error
+import urllib.parse
+import urllib.request
+
+HTML_REF = re.compile(r'<(?:link|script|img)[^>]+(?:href|src)="([^"#]+)"')
+CSS_REF = re.compile(r'url\(([^)"\']+)\)')
+PARALLEL = 6  # Browser connections per host
+
+
+def fetch(url, cache, timeout):
+    request = urllib.request.Request(url, headers={"Accept-Encoding": "gzip"})
+    cached = cache.get(url)
+    if cached and "immutable" in cached["cache_control"]:
+        return {"status": "cache", "bytes": 0, "body": cached["body"], "encoding": cached["encoding"]}
+    if cached and cached["etag"]:
+        request.add_header("If-None-Match", cached["etag"])
+    try:
+        with urllib.request.urlopen(request, timeout=timeout) as response:
+            raw = response.read()
+            entry = {
+                "etag": response.headers.get("ETag"),
+                "cache_control": response.headers.get("Cache-Control") or "",
+                "encoding": response.headers.get("Content-Encoding"),
+                "body": raw,
+            }
+            cache[url] = entry
+            return {"status": response.status, "bytes": len(raw), "body": raw, "encoding": entry["encoding"]}
+    except urllib.error.HTTPError as error:
+        if error.code != 304:
+            raise
+        return {"status": 304, "bytes": 0, "body": cached["body"], "encoding": cached["encoding"]}
+
+
+def text(result):
+    body = result["body"]
+    if result["encoding"] == "gzip":
+        body = gzip.decompress(body)
+    return body.decode("utf-8", "replace")
+
+
+def local(base, page_url, refs):
+    host = urllib.parse.urlsplit(base).netloc
+    urls = []
+    for ref in refs:
+        url = urllib.parse.urljoin(page_url, ref.strip())
+        if urllib.parse.urlsplit(url).netloc == host and url not in urls:
+            urls.append(url)
+    return urls
+
+
+def load(base, page, cache, timeout):
+    started = time.monotonic()
+    page_url = base + page
+    html = fetch(page_url, cache, timeout)
+    results = {page_url: html}
+    pending = local(base, page_url, HTML_REF.findall(text(html)))
+    lock = threading.Lock()
+
+    def worker():
+        while True:
+            with lock:
+                if not pending:
+                    return
+                url = pending.pop(0)
+            result = fetch(url, cache, timeout)
+            with lock:
+                results[url] = result
+                if url.split("?")[0].endswith(".css"):
+                    for font in local(base, url, CSS_REF.findall(text(result))):
+                        if font not in results and font not in pending:
+                            pending.append(font)
+
+    # Fonts are discovered while stylesheets arrive, so keep draining until idle
+    while True:
+        with lock:
+            if not pending:
+                break
+        threads = [threading.Thread(target=worker) for _ in range(PARALLEL)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+    elapsed = time.monotonic() - started
+    return elapsed, results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="weighmybru.local")
+    parser.add_argument("--page", default="/")
+    parser.add_argument("--runs", type=int, default=5)
+    parser.add_argument("--timeout", type=float, default=10.0)
+    args = parser.parse_args()
+
+    base = "http://" + args.host
+    timings = {"cold": [], "warm": []}
+    transferred = {"cold": [], "warm": []}
+    last = {}
+    for _ in range(args.runs):
+        cache = {}
+        for phase in ("cold", "warm"):
+            elapsed, results = load(base, args.page, cache, args.timeout)
+            timings[phase].append(elapsed)
+            transferred[phase].append(sum(result["bytes"] for result in results.values()))
+            last[phase] = results
+
+    for phase in ("cold", "warm"):
+        print(f"{phase}: ready {statistics.median(timings[phase]) * 1000:.0f} ms median, "
+              f"{statistics.median(transferred[phase])} bytes over {args.runs} runs")
+        for url, result in last[phase].items():
+            path = urllib.parse.urlsplit(url).path
+            print(f"  {str(result['status']):>5} {result['bytes']:8} {result['encoding'] or '':5} {path}")
+
+
+if __name__ == "__main__":
+    main()